@@ -0,0 +1,648 @@
+// File:  base64.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Base64 encoding and decoding (RFC 4648) with optional MIME line wrapping.
+//        Uses SSSE3 or AVX2 kernels when the CPU supports them.
+
+// Local headers
+#include "base64.h"
+
+// Standard C++ headers
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BASE64_X86
+#endif
+
+#ifdef BASE64_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <immintrin.h>
+#endif
+
+// GCC and clang require the instruction set to be enabled for each function
+// which uses it; this allows the kernels to be built without -mavx2, etc. and
+// selected at run time.  Helpers are force-inlined so that when called from
+// the AVX2 kernels they are VEX-encoded (mixing in legacy SSE code would incur
+// transition penalties).
+#if defined(__GNUC__) || defined(__clang__)
+#define BASE64_TARGET(x) __attribute__((target(x)))
+#define BASE64_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define BASE64_TARGET(x)
+#define BASE64_INLINE __forceinline
+#else
+#define BASE64_TARGET(x)
+#define BASE64_INLINE inline
+#endif
+
+namespace
+{
+	const char* const standardCharset = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	const char* const urlSafeCharset = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+	// Kernels process as much of the input as they can in whole SIMD blocks
+	// and return the number of input bytes consumed; the caller handles the
+	// remainder.  Decode kernels stop at the first block containing anything
+	// other than standard alphabet characters (whitespace, padding, errors).
+	typedef size_t (*EncodeKernel)(const unsigned char *in, const size_t &inputSize,
+		char *out, const Base64::Alphabet &alphabet);
+	typedef size_t (*DecodeKernel)(const char *in, const size_t &inputSize,
+		unsigned char *out, const size_t &outputCapacity);
+
+	struct Kernels
+	{
+		EncodeKernel encode;
+		DecodeKernel decode;
+		const char *name;
+	};
+
+	size_t EncodeScalar(const unsigned char*, const size_t&, char*, const Base64::Alphabet&) { return 0; }
+	size_t DecodeScalar(const char*, const size_t&, unsigned char*, const size_t&) { return 0; }
+
+#ifdef BASE64_X86
+	BASE64_TARGET("ssse3")
+	BASE64_INLINE __m128i EncodeReshuffle(__m128i in)
+	{
+		in = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+		const __m128i t0(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)));
+		const __m128i t1(_mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040)));
+		const __m128i t2(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)));
+		const __m128i t3(_mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010)));
+		return _mm_or_si128(t1, t3);
+	}
+
+	BASE64_TARGET("ssse3")
+	BASE64_INLINE __m128i EncodeTranslate(const __m128i &in, const __m128i &lut)
+	{
+		__m128i indices(_mm_subs_epu8(in, _mm_set1_epi8(51)));
+		indices = _mm_sub_epi8(indices, _mm_cmpgt_epi8(in, _mm_set1_epi8(25)));
+		return _mm_add_epi8(in, _mm_shuffle_epi8(lut, indices));
+	}
+
+	BASE64_TARGET("ssse3")
+	BASE64_INLINE __m128i EncodeLUT(const Base64::Alphabet &alphabet)
+	{
+		if (alphabet == Base64::Alphabet::URLSafe)
+			return _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -17, 32, 0, 0);
+		return _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+	}
+
+	BASE64_TARGET("ssse3")
+	BASE64_INLINE size_t EncodeBlocks128(const unsigned char *in, const size_t &inputSize, char *out, const Base64::Alphabet &alphabet)
+	{
+		const __m128i lut(EncodeLUT(alphabet));
+		size_t i(0);
+		for (; i + 16 <= inputSize; i += 12)
+		{
+			const __m128i block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), EncodeTranslate(EncodeReshuffle(block), lut));
+			out += 16;
+		}
+
+		return i;
+	}
+
+	BASE64_TARGET("ssse3")
+	size_t EncodeSSSE3(const unsigned char *in, const size_t &inputSize, char *out, const Base64::Alphabet &alphabet)
+	{
+		return EncodeBlocks128(in, inputSize, out, alphabet);
+	}
+
+	BASE64_TARGET("avx2")
+	size_t EncodeAVX2(const unsigned char *in, const size_t &inputSize, char *out, const Base64::Alphabet &alphabet)
+	{
+		const __m256i lut(_mm256_broadcastsi128_si256(EncodeLUT(alphabet)));
+		const __m256i shuffle(_mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+			1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+
+		size_t i(0);
+		for (; i + 28 <= inputSize; i += 24)
+		{
+			// Each 128-bit lane holds 12 input bytes (plus 4 ignored bytes)
+			__m256i block(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+			block = _mm256_inserti128_si256(block, _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12)), 1);
+
+			block = _mm256_shuffle_epi8(block, shuffle);
+			const __m256i t0(_mm256_and_si256(block, _mm256_set1_epi32(0x0fc0fc00)));
+			const __m256i t1(_mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040)));
+			const __m256i t2(_mm256_and_si256(block, _mm256_set1_epi32(0x003f03f0)));
+			const __m256i t3(_mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010)));
+			const __m256i indices(_mm256_or_si256(t1, t3));
+
+			__m256i offsets(_mm256_subs_epu8(indices, _mm256_set1_epi8(51)));
+			offsets = _mm256_sub_epi8(offsets, _mm256_cmpgt_epi8(indices, _mm256_set1_epi8(25)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+				_mm256_add_epi8(indices, _mm256_shuffle_epi8(lut, offsets)));
+			out += 32;
+		}
+
+		return i + EncodeBlocks128(in + i, inputSize - i, out, alphabet);
+	}
+
+	BASE64_TARGET("ssse3")
+	BASE64_INLINE size_t DecodeBlocks128(const char *in, const size_t &inputSize, unsigned char *out, const size_t &outputCapacity)
+	{
+		const __m128i lutLo(_mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+			0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A));
+		const __m128i lutHi(_mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+			0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10));
+		const __m128i lutRoll(_mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0));
+		const __m128i mask2F(_mm_set1_epi8(0x2f));
+
+		size_t i(0);
+		size_t o(0);
+		for (; i + 16 <= inputSize && o + 16 <= outputCapacity; i += 16, o += 12)
+		{
+			__m128i block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+
+			// Each valid character has no bits in common between its low and high nibble lookups
+			const __m128i hiNibbles(_mm_and_si128(_mm_srli_epi32(block, 4), mask2F));
+			const __m128i lo(_mm_shuffle_epi8(lutLo, _mm_and_si128(block, mask2F)));
+			const __m128i hi(_mm_shuffle_epi8(lutHi, hiNibbles));
+			if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0)
+				break;
+
+			const __m128i eq2F(_mm_cmpeq_epi8(block, mask2F));
+			block = _mm_add_epi8(block, _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles)));
+
+			const __m128i mergedPairs(_mm_maddubs_epi16(block, _mm_set1_epi32(0x01400140)));
+			__m128i packed(_mm_madd_epi16(mergedPairs, _mm_set1_epi32(0x00011000)));
+			packed = _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), packed);
+		}
+
+		return i;
+	}
+
+	BASE64_TARGET("ssse3")
+	size_t DecodeSSSE3(const char *in, const size_t &inputSize, unsigned char *out, const size_t &outputCapacity)
+	{
+		return DecodeBlocks128(in, inputSize, out, outputCapacity);
+	}
+
+	BASE64_TARGET("avx2")
+	size_t DecodeAVX2(const char *in, const size_t &inputSize, unsigned char *out, const size_t &outputCapacity)
+	{
+		const __m256i lutLo(_mm256_broadcastsi128_si256(_mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+			0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A)));
+		const __m256i lutHi(_mm256_broadcastsi128_si256(_mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+			0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10)));
+		const __m256i lutRoll(_mm256_broadcastsi128_si256(_mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+			0, 0, 0, 0, 0, 0, 0, 0)));
+		const __m256i mask2F(_mm256_set1_epi8(0x2f));
+		const __m256i laneShuffle(_mm256_broadcastsi128_si256(_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)));
+
+		size_t i(0);
+		size_t o(0);
+		for (; i + 32 <= inputSize && o + 32 <= outputCapacity; i += 32, o += 24)
+		{
+			__m256i block(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)));
+
+			const __m256i hiNibbles(_mm256_and_si256(_mm256_srli_epi32(block, 4), mask2F));
+			const __m256i lo(_mm256_shuffle_epi8(lutLo, _mm256_and_si256(block, mask2F)));
+			const __m256i hi(_mm256_shuffle_epi8(lutHi, hiNibbles));
+			if (!_mm256_testz_si256(lo, hi))
+				break;
+
+			const __m256i eq2F(_mm256_cmpeq_epi8(block, mask2F));
+			block = _mm256_add_epi8(block, _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles)));
+
+			const __m256i mergedPairs(_mm256_maddubs_epi16(block, _mm256_set1_epi32(0x01400140)));
+			__m256i packed(_mm256_madd_epi16(mergedPairs, _mm256_set1_epi32(0x00011000)));
+			packed = _mm256_shuffle_epi8(packed, laneShuffle);
+			packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), packed);
+		}
+
+		return i + DecodeBlocks128(in + i, inputSize - i, out + o, outputCapacity - o);
+	}
+
+	bool CPUSupportsSSSE3()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] & (1 << 9)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("ssse3") != 0;
+#endif
+	}
+
+	bool CPUSupportsAVX2()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 1);
+		const bool osUsesXSAVE((info[2] & (1 << 27)) != 0);
+		const bool cpuHasAVX((info[2] & (1 << 28)) != 0);
+		if (!osUsesXSAVE || !cpuHasAVX || (_xgetbv(0) & 0x6) != 0x6)
+			return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
+	}
+#endif// BASE64_X86
+
+	// Fastest first
+	std::vector<Kernels> FindSupportedKernels()
+	{
+		std::vector<Kernels> supported;
+#ifdef BASE64_X86
+		if (CPUSupportsAVX2())
+			supported.push_back(Kernels{ &EncodeAVX2, &DecodeAVX2, "avx2" });
+		if (CPUSupportsSSSE3())
+			supported.push_back(Kernels{ &EncodeSSSE3, &DecodeSSSE3, "ssse3" });
+#endif
+		supported.push_back(Kernels{ &EncodeScalar, &DecodeScalar, "scalar" });
+		return supported;
+	}
+
+	Kernels& GetKernels()
+	{
+		static Kernels kernels(FindSupportedKernels().front());
+		return kernels;
+	}
+
+	size_t EncodeUnwrapped(const unsigned char *in, const size_t &inputSize, char *output, const Base64::Alphabet &alphabet)
+	{
+		const char *charset(alphabet == Base64::Alphabet::URLSafe ? urlSafeCharset : standardCharset);
+		size_t i(GetKernels().encode(in, inputSize, output, alphabet));
+		char *out(output + i / 3 * 4);
+
+		for (; i + 3 <= inputSize; i += 3)
+		{
+			const uint32_t triple((in[i] << 16) | (in[i + 1] << 8) | in[i + 2]);
+			*out++ = charset[(triple >> 18) & 0x3f];
+			*out++ = charset[(triple >> 12) & 0x3f];
+			*out++ = charset[(triple >> 6) & 0x3f];
+			*out++ = charset[triple & 0x3f];
+		}
+
+		if (i < inputSize)
+		{
+			const uint32_t triple((in[i] << 16) | (i + 1 < inputSize ? in[i + 1] << 8 : 0));
+			*out++ = charset[(triple >> 18) & 0x3f];
+			*out++ = charset[(triple >> 12) & 0x3f];
+			*out++ = i + 1 < inputSize ? charset[(triple >> 6) & 0x3f] : '=';
+			*out++ = '=';
+		}
+
+		return out - output;
+	}
+
+	enum DecodeValue : signed char
+	{
+		Invalid = -1,
+		Whitespace = -2,
+		Padding = -3
+	};
+
+	struct DecodeTable
+	{
+		explicit DecodeTable(const char *charset)
+		{
+			for (auto& v : values)
+				v = Invalid;
+			for (signed char i = 0; i < 64; ++i)
+				values[static_cast<unsigned char>(charset[i])] = i;
+			values[static_cast<unsigned char>(' ')] = Whitespace;
+			values[static_cast<unsigned char>('\t')] = Whitespace;
+			values[static_cast<unsigned char>('\r')] = Whitespace;
+			values[static_cast<unsigned char>('\n')] = Whitespace;
+			values[static_cast<unsigned char>('=')] = Padding;
+		}
+
+		signed char values[256];
+	};
+}
+
+//==========================================================================
+// Class:			Base64
+// Function:		GetEncodedSize
+//
+// Description:		Returns the number of characters produced by encoding the
+//					specified number of bytes.
+//
+// Input Arguments:
+//		inputSize	= const size_t&
+//		wrapLines	= const bool&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		size_t
+//
+//==========================================================================
+size_t Base64::GetEncodedSize(const size_t &inputSize, const bool &wrapLines)
+{
+	const size_t encodedSize(4 * ((inputSize + 2) / 3));
+	if (!wrapLines)
+		return encodedSize;
+
+	return encodedSize + (encodedSize + CharsPerLine - 1) / CharsPerLine;
+}
+
+//==========================================================================
+// Class:			Base64
+// Function:		Encode
+//
+// Description:		Encodes the specified buffer.  The output buffer must have
+//					room for at least GetEncodedSize() characters.
+//
+// Input Arguments:
+//		input		= const void*
+//		inputSize	= const size_t&
+//		wrapLines	= const bool&
+//		alphabet	= const Alphabet&
+//
+// Output Arguments:
+//		output		= char*
+//
+// Return Value:
+//		size_t, number of characters written
+//
+//==========================================================================
+size_t Base64::Encode(const void *input, const size_t &inputSize, char *output, const bool &wrapLines,
+	const Alphabet &alphabet)
+{
+	const unsigned char *in(static_cast<const unsigned char*>(input));
+	if (!wrapLines)
+		return EncodeUnwrapped(in, inputSize, output, alphabet);
+
+	char *out(output);
+	size_t i(0);
+	for (; i + BytesPerLine <= inputSize; i += BytesPerLine)
+	{
+		out += EncodeUnwrapped(in + i, BytesPerLine, out, alphabet);
+		*out++ = '\n';
+	}
+
+	if (i < inputSize)
+	{
+		out += EncodeUnwrapped(in + i, inputSize - i, out, alphabet);
+		*out++ = '\n';
+	}
+
+	return out - output;
+}
+
+//==========================================================================
+// Class:			Base64
+// Function:		Encode
+//
+// Description:		Encodes the specified string.
+//
+// Input Arguments:
+//		s			= const std::string&
+//		wrapLines	= const bool&
+//		alphabet	= const Alphabet&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string
+//
+//==========================================================================
+std::string Base64::Encode(const std::string &s, const bool &wrapLines, const Alphabet &alphabet)
+{
+	std::string encoded(GetEncodedSize(s.size(), wrapLines), '\0');
+	encoded.resize(Encode(s.data(), s.size(), &encoded[0], wrapLines, alphabet));
+	return encoded;
+}
+
+//==========================================================================
+// Class:			Base64
+// Function:		GetMaxDecodedSize
+//
+// Description:		Returns the maximum number of bytes which could be produced
+//					by decoding the specified number of characters.
+//
+// Input Arguments:
+//		inputSize	= const size_t&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		size_t
+//
+//==========================================================================
+size_t Base64::GetMaxDecodedSize(const size_t &inputSize)
+{
+	return 3 * ((inputSize + 3) / 4);
+}
+
+//==========================================================================
+// Class:			Base64
+// Function:		Decode
+//
+// Description:		Decodes the specified buffer.  Whitespace is skipped and
+//					padding is optional.
+//
+// Input Arguments:
+//		input		= const char*
+//		inputSize	= const size_t&
+//		outputSize	= size_t&, capacity of the output buffer
+//		alphabet	= const Alphabet&
+//
+// Output Arguments:
+//		output		= void*
+//		outputSize	= size_t&, number of bytes written
+//
+// Return Value:
+//		bool, true for success, false if the input is not valid base64 or
+//		the output buffer is too small
+//
+//==========================================================================
+bool Base64::Decode(const char *input, const size_t &inputSize, void *output, size_t &outputSize,
+	const Alphabet &alphabet)
+{
+	static const DecodeTable standardTable(standardCharset);
+	static const DecodeTable urlSafeTable(urlSafeCharset);
+	const DecodeTable &table(alphabet == Alphabet::URLSafe ? urlSafeTable : standardTable);
+
+	// The SIMD kernels only understand the standard alphabet
+	const DecodeKernel kernel(alphabet == Alphabet::Standard ? GetKernels().decode : &DecodeScalar);
+
+	unsigned char *out(static_cast<unsigned char*>(output));
+	const size_t capacity(outputSize);
+	outputSize = 0;
+
+	uint32_t quad(0);
+	unsigned int count(0);
+	unsigned int padding(0);
+	size_t i(0), lineEnd(0);
+	while (i < inputSize)
+	{
+		if (kernel != &DecodeScalar && count == 0 && padding == 0)
+		{
+			// Limiting the kernel to the current line avoids wasted attempts on
+			// blocks which contain a line break.  The line break is only searched
+			// for again once it has been passed, so long lines aren't rescanned.
+			if (i >= lineEnd)
+			{
+				const char *lineBreak(static_cast<const char*>(memchr(input + i, '\n', inputSize - i)));
+				lineEnd = lineBreak ? lineBreak - input : inputSize;
+			}
+
+			const size_t consumed(kernel(input + i, lineEnd - i, out + outputSize, capacity - outputSize));
+			i += consumed;
+			outputSize += consumed / 4 * 3;
+			if (i == inputSize)
+				break;
+		}
+
+		const signed char value(table.values[static_cast<unsigned char>(input[i++])]);
+		if (value == Whitespace)
+			continue;
+		else if (value == Padding)
+		{
+			++padding;
+			continue;
+		}
+		else if (value == Invalid || padding > 0)
+			return false;
+
+		quad = (quad << 6) | value;
+		if (++count == 4)
+		{
+			if (outputSize + 3 > capacity)
+				return false;
+			out[outputSize++] = static_cast<unsigned char>(quad >> 16);
+			out[outputSize++] = static_cast<unsigned char>(quad >> 8);
+			out[outputSize++] = static_cast<unsigned char>(quad);
+			quad = 0;
+			count = 0;
+		}
+	}
+
+	if (count == 1 || (padding > 0 && count + padding != 4))
+		return false;
+	else if (outputSize + count - (count > 0 ? 1 : 0) > capacity)
+		return false;
+
+	if (count == 2)
+		out[outputSize++] = static_cast<unsigned char>(quad >> 4);
+	else if (count == 3)
+	{
+		out[outputSize++] = static_cast<unsigned char>(quad >> 10);
+		out[outputSize++] = static_cast<unsigned char>(quad >> 2);
+	}
+
+	return true;
+}
+
+//==========================================================================
+// Class:			Base64
+// Function:		Decode
+//
+// Description:		Decodes the specified string.
+//
+// Input Arguments:
+//		s			= const std::string&
+//		alphabet	= const Alphabet&
+//
+// Output Arguments:
+//		decoded		= std::string&
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool Base64::Decode(const std::string &s, std::string &decoded, const Alphabet &alphabet)
+{
+	decoded.resize(GetMaxDecodedSize(s.size()));
+	size_t size(decoded.size());
+	const bool result(Decode(s.data(), s.size(), &decoded[0], size, alphabet));
+	decoded.resize(size);
+	return result;
+}
+
+//==========================================================================
+// Class:			Base64
+// Function:		GetKernelName
+//
+// Description:		Returns the name of the kernel selected for this CPU.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		const char*
+//
+//==========================================================================
+const char* Base64::GetKernelName()
+{
+	return GetKernels().name;
+}
+
+//==========================================================================
+// Class:			Base64
+// Function:		GetSupportedKernels
+//
+// Description:		Returns the names of the kernels this CPU can run, fastest
+//					first.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::vector<std::string>
+//
+//==========================================================================
+std::vector<std::string> Base64::GetSupportedKernels()
+{
+	std::vector<std::string> names;
+	for (const auto& kernels : FindSupportedKernels())
+		names.push_back(kernels.name);
+	return names;
+}
+
+//==========================================================================
+// Class:			Base64
+// Function:		SelectKernel
+//
+// Description:		Replaces the automatically selected kernel.  Intended for
+//					testing and benchmarking; must not be called while other
+//					threads are encoding or decoding.
+//
+// Input Arguments:
+//		name	= const std::string&, as returned by GetSupportedKernels()
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, false if this CPU can't run the named kernel
+//
+//==========================================================================
+bool Base64::SelectKernel(const std::string &name)
+{
+	for (const auto& kernels : FindSupportedKernels())
+	{
+		if (name == kernels.name)
+		{
+			GetKernels() = kernels;
+			return true;
+		}
+	}
+
+	return false;
+}
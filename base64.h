@@ -0,0 +1,51 @@
+// File:  base64.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Base64 encoding and decoding (RFC 4648) with optional MIME line wrapping.
+//        Uses SSSE3 or AVX2 kernels when the CPU supports them.
+
+#ifndef BASE64_H_
+#define BASE64_H_
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace Base64
+{
+	enum class Alphabet
+	{
+		Standard,// '+' and '/'
+		URLSafe// '-' and '_' (i.e. Gmail's "raw" message field)
+	};
+
+	// When wrapping, a '\n' follows every 76 output characters and the final
+	// (partial) line.  Since 57 input bytes make exactly one line, input may
+	// be encoded in pieces whose sizes are multiples of BytesPerLine and the
+	// results concatenated.
+	const size_t CharsPerLine(76);
+	const size_t BytesPerLine(57);
+
+	size_t GetEncodedSize(const size_t &inputSize, const bool &wrapLines);
+	size_t Encode(const void *input, const size_t &inputSize, char *output, const bool &wrapLines,
+		const Alphabet &alphabet = Alphabet::Standard);
+	std::string Encode(const std::string &s, const bool &wrapLines = true,
+		const Alphabet &alphabet = Alphabet::Standard);
+
+	// Line breaks and other whitespace in the input are ignored
+	size_t GetMaxDecodedSize(const size_t &inputSize);
+	bool Decode(const char *input, const size_t &inputSize, void *output, size_t &outputSize,
+		const Alphabet &alphabet = Alphabet::Standard);
+	bool Decode(const std::string &s, std::string &decoded, const Alphabet &alphabet = Alphabet::Standard);
+
+	// Name of the kernel selected for this CPU ("avx2", "ssse3" or "scalar")
+	const char* GetKernelName();
+
+	// For tests and benchmarks:  the kernels this CPU can run, and a way to
+	// force one of them (not thread-safe)
+	std::vector<std::string> GetSupportedKernels();
+	bool SelectKernel(const std::string &name);
+}
+
+#endif// BASE64_H_
@@ -0,0 +1,202 @@
+// File:  dateHeader.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Cached formatting of the current time for Date: headers (RFC 5322).
+
+// Local headers
+#include "dateHeader.h"
+
+// Standard C++ headers
+#include <atomic>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+	// Names must be in English regardless of locale, so strftime() is not used
+	const char* const dayNames[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+	const char* const monthNames[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+		"Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+	// Days since 1970-01-01 in the proleptic Gregorian calendar
+	int64_t DaysFromCivil(int64_t year, const unsigned int &month, const unsigned int &day)
+	{
+		year -= month <= 2;
+		const int64_t era((year >= 0 ? year : year - 399) / 400);
+		const unsigned int yearOfEra(static_cast<unsigned int>(year - era * 400));
+		const unsigned int dayOfYear((153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1);
+		const unsigned int dayOfEra(yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear);
+		return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+	}
+
+	int64_t ToSeconds(const std::tm &t)
+	{
+		return DaysFromCivil(t.tm_year + 1900, t.tm_mon + 1, t.tm_mday) * 86400
+			+ t.tm_hour * 3600 + t.tm_min * 60 + t.tm_sec;
+	}
+
+	bool BreakDown(const time_t &t, const DateHeader::Zone &zone, std::tm &result)
+	{
+#ifdef _WIN32
+		if (zone == DateHeader::Zone::UTC)
+			return gmtime_s(&result, &t) == 0;
+		return localtime_s(&result, &t) == 0;
+#else
+		if (zone == DateHeader::Zone::UTC)
+			return gmtime_r(&t, &result) != nullptr;
+		return localtime_r(&t, &result) != nullptr;
+#endif
+	}
+
+	size_t FormatTime(const time_t &t, const DateHeader::Zone &zone, char *buffer)
+	{
+		std::tm fields;
+		if (!BreakDown(t, zone, fields))
+			return 0;
+
+		// Offset is the difference between the local and UTC fields (tm_gmtoff is not portable)
+		int offsetMinutes(0);
+		std::tm utc;
+		if (zone == DateHeader::Zone::Local && BreakDown(t, DateHeader::Zone::UTC, utc))
+			offsetMinutes = static_cast<int>((ToSeconds(fields) - ToSeconds(utc)) / 60);
+
+		const int absoluteOffset(std::abs(offsetMinutes));
+		const int length(snprintf(buffer, DateHeader::MaxLength, "%s, %02d %s %04d %02d:%02d:%02d %c%02d%02d",
+			dayNames[fields.tm_wday], fields.tm_mday, monthNames[fields.tm_mon], fields.tm_year + 1900,
+			fields.tm_hour, fields.tm_min, fields.tm_sec, offsetMinutes < 0 ? '-' : '+',
+			absoluteOffset / 60, absoluteOffset % 60));
+		if (length <= 0)
+			return 0;
+
+		return std::min(static_cast<size_t>(length), DateHeader::MaxLength - 1);
+	}
+
+	// Sequence lock:  the sequence is odd while the snapshot is being
+	// written, and readers retry (or format the time themselves) if it
+	// changed while they were copying.  The snapshot is stored in atomic
+	// words so that concurrent reads and writes are well defined.
+	class Cache
+	{
+	public:
+		explicit Cache(const DateHeader::Zone &zone) : zone(zone) {}
+
+		size_t Read(const time_t &now, char *buffer)
+		{
+			const unsigned int maxAttempts(4);
+			unsigned int i;
+			for (i = 0; i < maxAttempts; ++i)
+			{
+				const uint32_t before(sequence.load(std::memory_order_acquire));
+				if (before & 1)
+					continue;
+
+				const int64_t cachedSecond(second.load(std::memory_order_relaxed));
+				const size_t cachedLength(length.load(std::memory_order_relaxed));
+				uint64_t copy[wordCount];
+				for (size_t w = 0; w < wordCount; ++w)
+					copy[w] = words[w].load(std::memory_order_relaxed);
+
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (sequence.load(std::memory_order_relaxed) != before)
+					continue;
+				else if (cachedSecond != static_cast<int64_t>(now))
+					break;
+
+				memcpy(buffer, copy, cachedLength);
+				return cachedLength;
+			}
+
+			// Out of date:  format the time, and publish it unless another
+			// thread is already doing so
+			const size_t formattedLength(FormatTime(now, zone, buffer));
+			if (formattedLength > 0 && !updating.test_and_set(std::memory_order_acquire))
+			{
+				Publish(now, buffer, formattedLength);
+				updating.clear(std::memory_order_release);
+			}
+
+			return formattedLength;
+		}
+
+	private:
+		static const size_t wordCount = DateHeader::MaxLength / sizeof(uint64_t);
+
+		const DateHeader::Zone zone;
+		std::atomic<uint32_t> sequence{ 0 };
+		std::atomic<int64_t> second{ -1 };
+		std::atomic<size_t> length{ 0 };
+		std::atomic<uint64_t> words[wordCount] = {};
+		std::atomic_flag updating = ATOMIC_FLAG_INIT;
+
+		void Publish(const time_t &now, const char *text, const size_t &textLength)
+		{
+			uint64_t copy[wordCount] = {};
+			memcpy(copy, text, textLength);
+
+			const uint32_t s(sequence.load(std::memory_order_relaxed));
+			sequence.store(s + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			second.store(static_cast<int64_t>(now), std::memory_order_relaxed);
+			length.store(textLength, std::memory_order_relaxed);
+			for (size_t w = 0; w < wordCount; ++w)
+				words[w].store(copy[w], std::memory_order_relaxed);
+
+			sequence.store(s + 2, std::memory_order_release);
+		}
+	};
+
+	Cache& GetCache(const DateHeader::Zone &zone)
+	{
+		static Cache localCache(DateHeader::Zone::Local);
+		static Cache utcCache(DateHeader::Zone::UTC);
+		return zone == DateHeader::Zone::UTC ? utcCache : localCache;
+	}
+}
+
+//==========================================================================
+// Class:			DateHeader
+// Function:		Format
+//
+// Description:		Writes the current time, formatted for a Date: header.
+//
+// Input Arguments:
+//		zone	= const Zone&
+//
+// Output Arguments:
+//		buffer	= char*, at least MaxLength characters
+//
+// Return Value:
+//		size_t, number of characters written
+//
+//==========================================================================
+size_t DateHeader::Format(char *buffer, const Zone &zone)
+{
+	return GetCache(zone).Read(time(nullptr), buffer);
+}
+
+//==========================================================================
+// Class:			DateHeader
+// Function:		Get
+//
+// Description:		Returns the current time, formatted for a Date: header.
+//
+// Input Arguments:
+//		zone	= const Zone&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string
+//
+//==========================================================================
+std::string DateHeader::Get(const Zone &zone)
+{
+	char buffer[MaxLength];
+	return std::string(buffer, Format(buffer, zone));
+}
@@ -0,0 +1,34 @@
+// File:  dateHeader.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Cached formatting of the current time for Date: headers (RFC 5322).
+
+#ifndef DATE_HEADER_H_
+#define DATE_HEADER_H_
+
+// Standard C++ headers
+#include <string>
+#include <cstddef>
+
+// The formatted time is cached for each zone and updated at most once per
+// second, by whichever thread first notices that it is out of date.  Readers
+// copy it through a sequence lock, so they never block and never call
+// localtime() (which takes a global lock in some C libraries).
+namespace DateHeader
+{
+	enum class Zone
+	{
+		Local,// i.e. "Fri, 16 Oct 2026 09:30:00 -0500"
+		UTC// i.e. "Fri, 16 Oct 2026 14:30:00 +0000"
+	};
+
+	const size_t MaxLength(40);
+
+	// Writes the current time (without a terminator) and returns the number
+	// of characters written.  The buffer must hold at least MaxLength
+	// characters.
+	size_t Format(char *buffer, const Zone &zone = Zone::Local);
+	std::string Get(const Zone &zone = Zone::Local);
+}
+
+#endif// DATE_HEADER_H_
@@ -0,0 +1,711 @@
+// File:  dkimSigner.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Adds DKIM signatures (RFC 6376, rsa-sha256 and RFC 8463
+//        ed25519-sha256) to message payloads.
+
+// Local headers
+#include "dkimSigner.h"
+#include "base64.h"
+#include "utilities/uString.h"
+
+// OpenSSL headers
+#include <openssl/pem.h>
+
+// Standard C++ headers
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <iostream>
+
+std::mutex DKIMSigner::cacheMutex;
+std::map<std::string, DKIMSigner::CachedKey> DKIMSigner::keys;
+std::map<const std::string*, DKIMSigner::SharedBody> DKIMSigner::sharedBodies;
+
+//==========================================================================
+// Class:			DKIMSigner
+// Function:		DKIMSigner
+//
+// Description:		Constructor for DKIMSigner class.  Loads the private key
+//					(or takes it from the cache).
+//
+// Input Arguments:
+//		settings	= const Settings&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+DKIMSigner::DKIMSigner(const Settings &settings) : settings(settings), key(LoadKey(settings))
+{
+	if (settings.headers.empty())
+		headers = { "from", "to", "subject", "date", "message-id", "mime-version",
+			"content-type", "content-transfer-encoding" };
+	else
+	{
+		for (const auto& h : settings.headers)
+		{
+			headers.push_back(h);
+			std::transform(headers.back().begin(), headers.back().end(), headers.back().begin(), [](unsigned char c)
+			{
+				return static_cast<char>(std::tolower(c));
+			});
+		}
+	}
+}
+
+//==========================================================================
+// Class:			DKIMSigner
+// Function:		Sign
+//
+// Description:		Reads the payload to hash its header fields and body, and
+//					inserts the DKIM-Signature field at the start.  A shared
+//					body which ends the payload is only read the first time
+//					it is signed.
+//
+// Input Arguments:
+//		payload	= PayloadReader&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool DKIMSigner::Sign(PayloadReader &payload) const
+{
+	if (!key)
+		return false;
+
+	Scanner scanner;
+	std::string bodyHash;
+	std::vector<char> buffer;
+	size_t i;
+	for (i = 0; i < payload.sources.size(); ++i)
+	{
+		PayloadReader::Source &source(*payload.sources[i]);
+		const PayloadReader::SharedTextSource *shared(dynamic_cast<const PayloadReader::SharedTextSource*>(&source));
+		if (shared)
+		{
+			const std::shared_ptr<const std::string> &text(shared->GetText());
+			if (i + 1 < payload.sources.size() || !scanner.InHeader() || !scanner.AtLineStart())
+			{
+				scanner.Update(text->data(), text->size());
+				continue;
+			}
+
+			SharedBody sharedBody;
+			if (FindSharedBody(text, sharedBody))
+				scanner.header.append(*text, 0, sharedBody.headerLength);
+			else
+			{
+				const size_t start(scanner.header.size());
+				scanner.Update(text->data(), text->size());
+				sharedBody.headerLength = scanner.header.size() - start;
+				sharedBody.bodyHash = scanner.body.Finish();
+				AddSharedBody(text, sharedBody);
+			}
+
+			bodyHash = sharedBody.bodyHash;
+			break;
+		}
+
+		if (buffer.empty())
+			buffer.resize(65536);
+
+		source.Rewind();
+		size_t size;
+		while ((size = source.Read(buffer.data(), buffer.size())) > 0)
+			scanner.Update(buffer.data(), size);
+	}
+
+	if (bodyHash.empty())
+		bodyHash = scanner.body.Finish();
+
+	// The last instance of each field is signed (RFC 6376 section 5.4.2)
+	const std::vector<std::string_view> fields(SplitFields(scanner.header));
+	std::string canonical;
+	std::string names;
+	for (const auto& h : headers)
+	{
+		const auto field(std::find_if(fields.rbegin(), fields.rend(), [&h](const std::string_view &f)
+		{
+			return GetFieldName(f) == h;
+		}));
+
+		if (field == fields.rend())
+			continue;
+
+		AppendCanonicalField(*field, canonical);
+		if (!names.empty())
+			names.push_back(':');
+		names.append(h);
+	}
+
+	std::string signatureField("DKIM-Signature: v=1; a=");
+	signatureField.append(EVP_PKEY_id(key.get()) == EVP_PKEY_ED25519 ? "ed25519-sha256" : "rsa-sha256");
+	signatureField.append("; c=relaxed/relaxed; d=" + settings.domain + "; s=" + settings.selector + ";\n");
+	signatureField.append("\tt=" + std::to_string(std::time(nullptr)) + "; h=" + names + ";\n");
+	signatureField.append("\tbh=" + bodyHash + ";\n");
+	signatureField.append("\tb=");
+
+	// Signature field is hashed last, with an empty b= and no final CRLF
+	AppendCanonicalField(signatureField, canonical);
+	canonical.resize(canonical.size() - 2);
+
+	std::string signature;
+	if (!MakeSignature(canonical, signature))
+		return false;
+
+	signatureField.append(Base64::Encode(signature, false)).append("\n");
+	payload.sources.insert(payload.sources.begin(), std::unique_ptr<PayloadReader::Source>(
+		new PayloadReader::TextSource(std::move(signatureField))));
+	return payload.Rewind();
+}
+
+//==========================================================================
+// Class:			DKIMSigner
+// Function:		MakeSignature
+//
+// Description:		Signs the canonicalized header fields.  For Ed25519, the
+//					SHA-256 hash of the data is signed (RFC 8463).
+//
+// Input Arguments:
+//		data		= const std::string&
+//
+// Output Arguments:
+//		signature	= std::string&
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool DKIMSigner::MakeSignature(const std::string &data, std::string &signature) const
+{
+	std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> context(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+	if (!context)
+		return false;
+
+	size_t length;
+	if (EVP_PKEY_id(key.get()) == EVP_PKEY_ED25519)
+	{
+		unsigned char digest[EVP_MAX_MD_SIZE];
+		unsigned int digestLength;
+		if (EVP_Digest(data.data(), data.size(), digest, &digestLength, EVP_sha256(), nullptr) != 1 ||
+			EVP_DigestSignInit(context.get(), nullptr, nullptr, nullptr, key.get()) != 1 ||
+			EVP_DigestSign(context.get(), nullptr, &length, digest, digestLength) != 1)
+			return false;
+
+		signature.resize(length);
+		if (EVP_DigestSign(context.get(), reinterpret_cast<unsigned char*>(&signature[0]), &length, digest, digestLength) != 1)
+			return false;
+	}
+	else
+	{
+		if (EVP_DigestSignInit(context.get(), nullptr, EVP_sha256(), nullptr, key.get()) != 1 ||
+			EVP_DigestSignUpdate(context.get(), data.data(), data.size()) != 1 ||
+			EVP_DigestSignFinal(context.get(), nullptr, &length) != 1)
+			return false;
+
+		signature.resize(length);
+		if (EVP_DigestSignFinal(context.get(), reinterpret_cast<unsigned char*>(&signature[0]), &length) != 1)
+			return false;
+	}
+
+	signature.resize(length);
+	return true;
+}
+
+//==========================================================================
+// Class:			DKIMSigner
+// Function:		LoadKey (static)
+//
+// Description:		Returns the private key for the selector, reading it from
+//					the file if it has not been read before.
+//
+// Input Arguments:
+//		settings	= const Settings&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::shared_ptr<EVP_PKEY>, empty on failure
+//
+//==========================================================================
+std::shared_ptr<EVP_PKEY> DKIMSigner::LoadKey(const Settings &settings)
+{
+	const std::string id(settings.selector + "._domainkey." + settings.domain);
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	const auto it(keys.find(id));
+	if (it != keys.end() && it->second.path == settings.privateKeyPath)
+		return it->second.key;
+
+	BIO *file(BIO_new_file(settings.privateKeyPath.c_str(), "r"));
+	if (!file)
+	{
+		Cerr << "Failed to open DKIM private key file '" << UString::ToStringType(settings.privateKeyPath) << "'\n";
+		return nullptr;
+	}
+
+	std::shared_ptr<EVP_PKEY> key(PEM_read_bio_PrivateKey(file, nullptr, nullptr, nullptr), EVP_PKEY_free);
+	BIO_free(file);
+	if (!key)
+	{
+		Cerr << "Failed to read DKIM private key from '" << UString::ToStringType(settings.privateKeyPath) << "'\n";
+		return nullptr;
+	}
+
+	if (EVP_PKEY_id(key.get()) != EVP_PKEY_RSA && EVP_PKEY_id(key.get()) != EVP_PKEY_ED25519)
+	{
+		Cerr << "DKIM private key must be RSA or Ed25519\n";
+		return nullptr;
+	}
+
+	keys[id] = { settings.privateKeyPath, key };
+	return key;
+}
+
+//==========================================================================
+// Class:			DKIMSigner
+// Function:		FindSharedBody (static)
+//
+// Description:		Looks up the cached hash of a shared body.
+//
+// Input Arguments:
+//		text		= const std::shared_ptr<const std::string>&
+//
+// Output Arguments:
+//		sharedBody	= SharedBody&
+//
+// Return Value:
+//		bool, true if found
+//
+//==========================================================================
+bool DKIMSigner::FindSharedBody(const std::shared_ptr<const std::string> &text, SharedBody &sharedBody)
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	const auto it(sharedBodies.find(text.get()));
+	if (it == sharedBodies.end() || it->second.text.lock() != text)
+		return false;
+
+	sharedBody = it->second;
+	return true;
+}
+
+//==========================================================================
+// Class:			DKIMSigner
+// Function:		AddSharedBody (static)
+//
+// Description:		Caches the hash of a shared body.  Entries for bodies
+//					which no longer exist are removed at the same time.
+//
+// Input Arguments:
+//		text		= const std::shared_ptr<const std::string>&
+//		sharedBody	= const SharedBody&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void DKIMSigner::AddSharedBody(const std::shared_ptr<const std::string> &text, const SharedBody &sharedBody)
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	auto it(sharedBodies.begin());
+	while (it != sharedBodies.end())
+	{
+		if (it->second.text.expired())
+			it = sharedBodies.erase(it);
+		else
+			++it;
+	}
+
+	SharedBody &entry(sharedBodies[text.get()]);
+	entry = sharedBody;
+	entry.text = text;
+}
+
+//==========================================================================
+// Class:			DKIMSigner
+// Function:		SplitFields (static)
+//
+// Description:		Splits the header into fields (including any folded
+//					continuation lines).
+//
+// Input Arguments:
+//		header	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::vector<std::string_view>
+//
+//==========================================================================
+std::vector<std::string_view> DKIMSigner::SplitFields(const std::string &header)
+{
+	std::vector<std::string_view> fields;
+	size_t start(0);
+	while (start < header.size())
+	{
+		size_t end(start);
+		do
+		{
+			end = header.find('\n', end);
+			end = end == std::string::npos ? header.size() : end + 1;
+		} while (end < header.size() && (header[end] == ' ' || header[end] == '\t'));
+
+		const std::string_view field(header.data() + start, end - start);
+		if (field.find(':') != std::string_view::npos)
+			fields.push_back(field);
+		start = end;
+	}
+
+	return fields;
+}
+
+//==========================================================================
+// Class:			DKIMSigner
+// Function:		GetFieldName (static)
+//
+// Description:		Returns the (lower case) name of the header field.
+//
+// Input Arguments:
+//		field	= const std::string_view&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string
+//
+//==========================================================================
+std::string DKIMSigner::GetFieldName(const std::string_view &field)
+{
+	std::string name(field.substr(0, field.find(':')));
+	while (!name.empty() && (name.back() == ' ' || name.back() == '\t'))
+		name.pop_back();
+
+	std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c)
+	{
+		return static_cast<char>(std::tolower(c));
+	});
+	return name;
+}
+
+//==========================================================================
+// Class:			DKIMSigner
+// Function:		AppendCanonicalField (static)
+//
+// Description:		Appends the header field with relaxed canonicalization
+//					(RFC 6376 section 3.4.2):  lower case name, unfolded
+//					value with runs of whitespace reduced to one space and
+//					no whitespace at either end.
+//
+// Input Arguments:
+//		field	= const std::string_view&
+//
+// Output Arguments:
+//		out		= std::string&
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void DKIMSigner::AppendCanonicalField(const std::string_view &field, std::string &out)
+{
+	out.append(GetFieldName(field));
+	out.push_back(':');
+
+	bool space(false);
+	bool started(false);
+	size_t i;
+	for (i = field.find(':') + 1; i < field.size(); ++i)
+	{
+		const char c(field[i]);
+		if (c == '\r' || c == '\n')
+			continue;
+		else if (c == ' ' || c == '\t')
+		{
+			space = true;
+			continue;
+		}
+
+		if (space && started)
+			out.push_back(' ');
+		space = false;
+		started = true;
+		out.push_back(c);
+	}
+
+	out.append("\r\n");
+}
+
+//==========================================================================
+// Class:			DKIMSigner::Scanner
+// Function:		Update
+//
+// Description:		Adds data to the header until the first empty line, and
+//					passes everything after it to the body hash.
+//
+// Input Arguments:
+//		data	= const char*
+//		size	= const size_t&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void DKIMSigner::Scanner::Update(const char *data, const size_t &size)
+{
+	size_t i(0);
+	if (inHeader)
+	{
+		for (; i < size; ++i)
+		{
+			if (data[i] == '\n')
+			{
+				if (lineEmpty)
+				{
+					inHeader = false;
+					++i;
+					break;
+				}
+
+				lineEmpty = true;
+			}
+			else if (data[i] != '\r')
+				lineEmpty = false;
+		}
+
+		header.append(data, i);
+	}
+
+	if (i < size)
+		body.Update(data + i, size - i);
+}
+
+//==========================================================================
+// Class:			DKIMSigner::BodyHasher
+// Function:		BodyHasher
+//
+// Description:		Constructor for BodyHasher class.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+DKIMSigner::BodyHasher::BodyHasher() : context(EVP_MD_CTX_new())
+{
+	EVP_DigestInit_ex(context, EVP_sha256(), nullptr);
+}
+
+//==========================================================================
+// Class:			DKIMSigner::BodyHasher
+// Function:		~BodyHasher
+//
+// Description:		Destructor for BodyHasher class.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+DKIMSigner::BodyHasher::~BodyHasher()
+{
+	EVP_MD_CTX_free(context);
+}
+
+//==========================================================================
+// Class:			DKIMSigner::BodyHasher
+// Function:		Update
+//
+// Description:		Hashes the next part of the body with relaxed
+//					canonicalization (RFC 6376 section 3.4.4):  line endings
+//					become CRLF, runs of whitespace become one space,
+//					whitespace at the ends of lines and empty lines at the
+//					end of the body are removed.  Runs of other characters
+//					are hashed directly from the input.
+//
+// Input Arguments:
+//		data	= const char*
+//		size	= const size_t&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void DKIMSigner::BodyHasher::Update(const char *data, const size_t &size)
+{
+	size_t runStart(size);
+	size_t i;
+	for (i = 0; i < size; ++i)
+	{
+		const char c(data[i]);
+		const bool special(c == ' ' || c == '\t' || c == '\r' || c == '\n');
+		if (!special)
+		{
+			if (runStart == size)
+			{
+				if (pendingCR)// Lone CR is ordinary text
+				{
+					pendingCR = false;
+					StartContent();
+					Hash("\r", 1);
+				}
+
+				StartContent();
+				runStart = i;
+			}
+			continue;
+		}
+
+		if (runStart < size)
+		{
+			Hash(data + runStart, i - runStart);
+			runStart = size;
+		}
+
+		if (c == '\n')
+		{
+			pendingCR = false;
+			pendingSpace = false;
+			if (lineStarted)
+				Hash("\r\n", 2);
+			else
+				++emptyLines;
+			lineStarted = false;
+			continue;
+		}
+
+		if (pendingCR)
+		{
+			pendingCR = false;
+			StartContent();
+			Hash("\r", 1);
+		}
+
+		if (c == '\r')
+			pendingCR = true;
+		else
+			pendingSpace = true;
+	}
+
+	if (runStart < size)
+		Hash(data + runStart, size - runStart);
+}
+
+//==========================================================================
+// Class:			DKIMSigner::BodyHasher
+// Function:		Finish
+//
+// Description:		Completes the hash.  A body which does not end with a
+//					line ending is hashed as if it did.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string, base64 encoded digest
+//
+//==========================================================================
+std::string DKIMSigner::BodyHasher::Finish()
+{
+	if (pendingCR)
+	{
+		pendingCR = false;
+		StartContent();
+		Hash("\r", 1);
+	}
+
+	if (lineStarted)
+		Hash("\r\n", 2);
+
+	unsigned char digest[EVP_MAX_MD_SIZE];
+	unsigned int length(0);
+	EVP_DigestFinal_ex(context, digest, &length);
+	return Base64::Encode(std::string(reinterpret_cast<const char*>(digest), length), false);
+}
+
+//==========================================================================
+// Class:			DKIMSigner::BodyHasher
+// Function:		StartContent
+//
+// Description:		Hashes the empty lines and whitespace which precede
+//					content on the current line.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void DKIMSigner::BodyHasher::StartContent()
+{
+	if (!lineStarted)
+	{
+		for (; emptyLines > 0; --emptyLines)
+			Hash("\r\n", 2);
+		lineStarted = true;
+	}
+
+	if (pendingSpace)
+	{
+		Hash(" ", 1);
+		pendingSpace = false;
+	}
+}
+
+//==========================================================================
+// Class:			DKIMSigner::BodyHasher
+// Function:		Hash
+//
+// Description:		Adds canonicalized data to the digest.
+//
+// Input Arguments:
+//		data	= const char*
+//		size	= const size_t&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void DKIMSigner::BodyHasher::Hash(const char *data, const size_t &size)
+{
+	EVP_DigestUpdate(context, data, size);
+}
@@ -0,0 +1,122 @@
+// File:  dkimSigner.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Adds DKIM signatures (RFC 6376, rsa-sha256 and RFC 8463
+//        ed25519-sha256) to message payloads.
+
+#ifndef DKIM_SIGNER_H_
+#define DKIM_SIGNER_H_
+
+// Local headers
+#include "payloadReader.h"
+
+// OpenSSL headers
+#include <openssl/evp.h>
+
+// Standard C++ headers
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <map>
+#include <mutex>
+
+// Headers and body are both signed with relaxed canonicalization.  Sign()
+// reads the payload once, hashing the body as it streams (attachments are
+// not loaded into memory), and then inserts the DKIM-Signature field in
+// front of the payload.  The body hash of a shared body (a
+// Message::renderedBody) is computed once and reused for every message
+// which sends it.  Parsed private keys are cached per selector, so signers
+// may be created freely.  All methods are thread-safe.
+class DKIMSigner
+{
+public:
+	struct Settings
+	{
+		std::string domain;// d=
+		std::string selector;// s=
+		std::string privateKeyPath;// PEM; RSA for rsa-sha256, Ed25519 for ed25519-sha256
+		std::vector<std::string> headers;// Names of header fields to sign; empty for the defaults
+	};
+
+	explicit DKIMSigner(const Settings &settings);
+
+	bool IsValid() const { return key != nullptr; }
+	bool Sign(PayloadReader &payload) const;
+
+	// Relaxed body canonicalization and SHA-256, fed incrementally
+	class BodyHasher
+	{
+	public:
+		BodyHasher();
+		~BodyHasher();
+
+		BodyHasher(const BodyHasher&) = delete;
+		BodyHasher& operator=(const BodyHasher&) = delete;
+
+		void Update(const char *data, const size_t &size);
+		std::string Finish();// Base64 of the digest
+
+	private:
+		EVP_MD_CTX *context;
+
+		size_t emptyLines = 0;// Not yet hashed, in case they end the body
+		bool lineStarted = false;
+		bool pendingSpace = false;
+		bool pendingCR = false;
+
+		void Hash(const char *data, const size_t &size);
+		void StartContent();
+	};
+
+private:
+	const Settings settings;
+	std::vector<std::string> headers;// Lower case
+	std::shared_ptr<EVP_PKEY> key;
+
+	// Splits the message at the first empty line
+	class Scanner
+	{
+	public:
+		void Update(const char *data, const size_t &size);
+
+		std::string header;
+		BodyHasher body;
+
+		bool InHeader() const { return inHeader; }
+		bool AtLineStart() const { return lineEmpty; }
+
+	private:
+		bool inHeader = true;
+		bool lineEmpty = true;
+	};
+
+	struct CachedKey
+	{
+		std::string path;
+		std::shared_ptr<EVP_PKEY> key;
+	};
+
+	struct SharedBody
+	{
+		std::weak_ptr<const std::string> text;
+		size_t headerLength;// Part of the text preceding (and including) the empty line
+		std::string bodyHash;
+	};
+
+	static std::mutex cacheMutex;
+	static std::map<std::string, CachedKey> keys;// By selector and domain
+	static std::map<const std::string*, SharedBody> sharedBodies;
+
+	static std::shared_ptr<EVP_PKEY> LoadKey(const Settings &settings);
+	static bool FindSharedBody(const std::shared_ptr<const std::string> &text, SharedBody &sharedBody);
+	static void AddSharedBody(const std::shared_ptr<const std::string> &text, const SharedBody &sharedBody);
+
+	static std::vector<std::string_view> SplitFields(const std::string &header);
+	static std::string GetFieldName(const std::string_view &field);
+	static void AppendCanonicalField(const std::string_view &field, std::string &out);
+
+	bool MakeSignature(const std::string &data, std::string &signature) const;
+};
+
+#endif// DKIM_SIGNER_H_
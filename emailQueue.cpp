@@ -0,0 +1,403 @@
+// File:  emailQueue.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Bounded queue of messages which are sent in the background by a pool
+//        of worker threads, each with its own SMTP connection.
+
+// Local headers
+#include "emailQueue.h"
+#include "smtpSession.h"
+
+// Standard C++ headers
+#include <cassert>
+#include <memory>
+
+//==========================================================================
+// Class:			EmailQueue
+// Function:		EmailQueue
+//
+// Description:		Constructor for EmailQueue class.  Starts the worker
+//					threads.
+//
+// Input Arguments:
+//		loginInfo	= const EmailSender::LoginInfo&
+//		workerCount	= const unsigned int&, number of threads (and SMTP
+//					  connections)
+//		capacity	= const size_t&, maximum number of messages waiting to be
+//					  sent
+//		policy		= const OverflowPolicy&
+//		testMode	= const bool&
+//		outStream	= UString::OStream&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+EmailQueue::EmailQueue(const EmailSender::LoginInfo &loginInfo, const unsigned int &workerCount,
+	const size_t &capacity, const OverflowPolicy &policy, const bool &testMode,
+	UString::OStream &outStream) : loginInfo(loginInfo), capacity(capacity), policy(policy),
+	testMode(testMode), outStream(outStream)
+{
+	assert(workerCount > 0 && capacity > 0);
+
+	unsigned int i;
+	for (i = 0; i < workerCount; ++i)
+		workers.push_back(std::thread(&EmailQueue::WorkerThreadEntry, this));
+}
+
+//==========================================================================
+// Class:			EmailQueue
+// Function:		~EmailQueue
+//
+// Description:		Destructor for EmailQueue class.  Waits for queued
+//					messages to be sent.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+EmailQueue::~EmailQueue()
+{
+	Shutdown();
+}
+
+//==========================================================================
+// Class:			EmailQueue
+// Function:		Add
+//
+// Description:		Queues the message to be sent.  If the queue is full, the
+//					behavior depends on the overflow policy.
+//
+// Input Arguments:
+//		message		= EmailSender::Message
+//		callback	= CompletionCallback
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true if the message was queued, false otherwise
+//
+//==========================================================================
+bool EmailQueue::Add(EmailSender::Message message, CompletionCallback callback)
+{
+	Job dropped;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (policy == OverflowPolicy::Block)
+			spaceAvailable.wait(lock, [this]()
+			{
+				return pending.size() + waitingForRetry.size() < capacity || stopping;
+			});
+
+		if (stopping)
+			return false;
+
+		if (pending.size() + waitingForRetry.size() >= capacity)
+		{
+			if (policy == OverflowPolicy::Reject || pending.empty())
+				return false;
+
+			dropped = std::move(pending.front());
+			pending.pop_front();
+		}
+
+		Job job;
+		job.message = std::move(message);
+		job.callback = std::move(callback);
+		pending.push_back(std::move(job));
+	}
+
+	jobAvailable.notify_one();
+	if (dropped.callback)
+		dropped.callback(MakeRejectedResult());
+
+	return true;
+}
+
+//==========================================================================
+// Class:			EmailQueue
+// Function:		Add
+//
+// Description:		Queues the message to be sent.  If the queue is full, the
+//					behavior depends on the overflow policy.
+//
+// Input Arguments:
+//		message	= EmailSender::Message
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::future<SendResult>
+//
+//==========================================================================
+std::future<SendResult> EmailQueue::Add(EmailSender::Message message)
+{
+	auto promise(std::make_shared<std::promise<SendResult>>());
+	std::future<SendResult> result(promise->get_future());
+	if (!Add(std::move(message), [promise](const SendResult &sendResult)
+	{
+		promise->set_value(sendResult);
+	}))
+		promise->set_value(MakeRejectedResult());
+
+	return result;
+}
+
+//==========================================================================
+// Class:			EmailQueue
+// Function:		SetRetryPolicy
+//
+// Description:		Sets the policy for retrying failed messages.  Without a
+//					policy (the default), failed messages are not retried.
+//
+// Input Arguments:
+//		policy	= std::shared_ptr<const RetryPolicy>
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void EmailQueue::SetRetryPolicy(std::shared_ptr<const RetryPolicy> policy)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	retryPolicy = std::move(policy);
+}
+
+//==========================================================================
+// Class:			EmailQueue
+// Function:		Shutdown
+//
+// Description:		Stops accepting messages and stops the worker threads.
+//					Unless discardPending is true, messages already queued
+//					are sent first.  Discarded messages are reported as
+//					failures.  Messages whose retry time has not arrived are
+//					not retried and are reported with their last result.
+//
+// Input Arguments:
+//		discardPending	= const bool&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void EmailQueue::Shutdown(const bool &discardPending)
+{
+	std::deque<Job> discarded;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		if (discardPending)
+			discarded.swap(pending);
+	}
+
+	jobAvailable.notify_all();
+	spaceAvailable.notify_all();
+
+	for (auto& w : workers)
+	{
+		if (w.joinable())
+			w.join();
+	}
+
+	std::multimap<std::chrono::steady_clock::time_point, Job> retries;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		retries.swap(waitingForRetry);
+	}
+
+	for (auto& job : discarded)
+	{
+		if (job.callback)
+			job.callback(MakeRejectedResult());
+	}
+
+	for (auto& r : retries)
+	{
+		if (r.second.callback)
+			r.second.callback(r.second.lastResult);
+	}
+}
+
+//==========================================================================
+// Class:			EmailQueue
+// Function:		GetPendingCount
+//
+// Description:		Returns the number of messages waiting to be sent
+//					(including those waiting to be retried).
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		size_t
+//
+//==========================================================================
+size_t EmailQueue::GetPendingCount() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return pending.size() + waitingForRetry.size();
+}
+
+//==========================================================================
+// Class:			EmailQueue
+// Function:		WaitForJob
+//
+// Description:		Waits for the next message to send.  Messages whose retry
+//					time has arrived are sent before new messages.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		job	= Job&
+//
+// Return Value:
+//		bool, true if a job was assigned, false if the worker should exit
+//
+//==========================================================================
+bool EmailQueue::WaitForJob(Job &job)
+{
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true)
+		{
+			const auto now(std::chrono::steady_clock::now());
+			while (!waitingForRetry.empty() && waitingForRetry.begin()->first <= now)
+			{
+				pending.push_front(std::move(waitingForRetry.begin()->second));
+				waitingForRetry.erase(waitingForRetry.begin());
+			}
+
+			if (!pending.empty() || stopping)
+				break;
+			else if (waitingForRetry.empty())
+				jobAvailable.wait(lock);
+			else
+				jobAvailable.wait_until(lock, waitingForRetry.begin()->first);
+		}
+
+		if (pending.empty())
+			return false;
+
+		job = std::move(pending.front());
+		pending.pop_front();
+	}
+
+	spaceAvailable.notify_one();
+	return true;
+}
+
+//==========================================================================
+// Class:			EmailQueue
+// Function:		WorkerThreadEntry
+//
+// Description:		Entry point for worker threads.  Each worker keeps its own
+//					SMTP session open between messages.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void EmailQueue::WorkerThreadEntry()
+{
+	SMTPSession session(loginInfo, testMode, outStream);
+	session.DisableSignaling();// Signals are not safe with multiple threads
+
+	Job job;
+	while (WaitForJob(job))
+	{
+		EmailSender sender(job.message, loginInfo, testMode, outStream);
+		sender.Send(session);
+		++job.attempts;
+		Complete(job, sender.GetLastResult());
+	}
+}
+
+//==========================================================================
+// Class:			EmailQueue
+// Function:		Complete
+//
+// Description:		Handles the result of an attempt to send a message.  If
+//					the message should be retried, it is held until its retry
+//					time; otherwise the callback is called.
+//
+// Input Arguments:
+//		job		= Job&
+//		result	= const SendResult&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void EmailQueue::Complete(Job &job, const SendResult &result)
+{
+	if (!result.success)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (retryPolicy && !stopping && retryPolicy->ShouldRetry(result, job.attempts, job.retryDelayMs))
+		{
+			if (testMode)
+				outStream << "Retrying in " << job.retryDelayMs << " ms" << std::endl;
+
+			job.lastResult = result;
+			waitingForRetry.emplace(std::chrono::steady_clock::now() + std::chrono::milliseconds(job.retryDelayMs),
+				std::move(job));
+			jobAvailable.notify_one();
+			return;
+		}
+	}
+
+	if (job.callback)
+		job.callback(result);
+}
+
+//==========================================================================
+// Class:			EmailQueue
+// Function:		MakeRejectedResult (static)
+//
+// Description:		Creates the result reported for messages which were not
+//					queued or were discarded from the queue.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		SendResult
+//
+//==========================================================================
+SendResult EmailQueue::MakeRejectedResult()
+{
+	return SendResult::Deferred("Message was discarded from the queue");
+}
@@ -0,0 +1,98 @@
+// File:  emailQueue.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Bounded queue of messages which are sent in the background by a pool
+//        of worker threads, each with its own SMTP connection.
+
+#ifndef EMAIL_QUEUE_H_
+#define EMAIL_QUEUE_H_
+
+// Local headers
+#include "emailSender.h"
+#include "sendResult.h"
+#include "retryPolicy.h"
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+
+// Add() may be called from any thread.  Completion callbacks are called from
+// the worker threads.  With a retry policy, messages which fail transiently
+// are held (without occupying a worker) until their retry time.
+class EmailQueue
+{
+public:
+	// Behavior of Add() when the queue is full
+	enum class OverflowPolicy
+	{
+		Block,// Wait for space
+		Reject,// Fail the new message immediately
+		DropOldest// Fail the oldest queued message to make room
+	};
+
+	typedef std::function<void(const SendResult &result)> CompletionCallback;
+
+	EmailQueue(const EmailSender::LoginInfo &loginInfo, const unsigned int &workerCount,
+		const size_t &capacity, const OverflowPolicy &policy = OverflowPolicy::Block,
+		const bool &testMode = false, UString::OStream &outStream = Cout);
+	~EmailQueue();
+
+	EmailQueue(const EmailQueue&) = delete;
+	EmailQueue& operator=(const EmailQueue&) = delete;
+
+	// Returns false if the message was not queued (in which case the callback is not called)
+	bool Add(EmailSender::Message message, CompletionCallback callback);
+	// If the message was not queued, the future is immediately ready with a failed result
+	std::future<SendResult> Add(EmailSender::Message message);
+
+	void SetRetryPolicy(std::shared_ptr<const RetryPolicy> policy);
+
+	// Stops the workers after the queued messages are sent (or discarded)
+	void Shutdown(const bool &discardPending = false);
+
+	size_t GetPendingCount() const;
+
+private:
+	const EmailSender::LoginInfo loginInfo;
+	const size_t capacity;
+	const OverflowPolicy policy;
+	const bool testMode;
+	UString::OStream &outStream;
+
+	struct Job
+	{
+		EmailSender::Message message;
+		CompletionCallback callback;
+
+		unsigned int attempts = 0;
+		unsigned int retryDelayMs = 0;
+		SendResult lastResult;
+	};
+
+	mutable std::mutex mutex;
+	std::condition_variable jobAvailable;
+	std::condition_variable spaceAvailable;
+	std::deque<Job> pending;
+	std::multimap<std::chrono::steady_clock::time_point, Job> waitingForRetry;
+	std::shared_ptr<const RetryPolicy> retryPolicy;
+	bool stopping = false;
+
+	std::vector<std::thread> workers;
+
+	void WorkerThreadEntry();
+	bool WaitForJob(Job &job);
+	void Complete(Job &job, const SendResult &result);
+
+	static SendResult MakeRejectedResult();
+};
+
+#endif// EMAIL_QUEUE_H_
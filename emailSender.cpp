@@ -6,9 +6,12 @@
 // Local headers
 #include "emailSender.h"
 #include "oAuth2Interface.h"
-
-// rpi headers
-#include "utilities/timingUtility.h"
+#include "smtpSession.h"
+#include "smtpClient.h"
+#include "base64.h"
+#include "rateLimiter.h"
+#include "messageBuilder.h"
+#include "dkimSigner.h"
 
 // OS headers
 #ifdef _WIN32
@@ -26,6 +29,8 @@
 #include <time.h>
 #include <sstream>
 #include <cstring>
+#include <numeric>
+#include <cstdio>
 #include <cctype>
 #include <cassert>
 #include <algorithm>
@@ -55,17 +60,43 @@
 EmailSender::EmailSender(const std::string &subject, const std::string &message,
 	const std::string &attachmentFileName, const std::vector<AddressInfo> &recipients,
 	const LoginInfo &loginInfo, const bool &useHTML, const bool& testMode,
-	UString::OStream &outStream) : subject(subject), message(message), attachmentFileName(attachmentFileName),
-	recipients(recipients), loginInfo(loginInfo), useHTML(useHTML), testMode(testMode),
+	UString::OStream &outStream) : EmailSender(Message{ subject, message, ToAttachmentList(attachmentFileName),
+	recipients, useHTML, nullptr, nullptr, std::vector<std::string>() }, loginInfo, testMode, outStream)
+{
+}
+
+//==========================================================================
+// Class:			EmailSender
+// Function:		EmailSender
+//
+// Description:		Constructor for EmailSender class.  If the message has a
+//					rendered body, the body text and attachments are not
+//					copied.
+//
+// Input Arguments:
+//		message		= const Message&
+//		loginInfo	= const LoginInfo&
+//		testMode	= const bool&
+//		outStream	= UString::OStream&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+EmailSender::EmailSender(const Message &message, const LoginInfo &loginInfo, const bool& testMode,
+	UString::OStream &outStream) : content(CopyContent(message)), loginInfo(loginInfo), testMode(testMode),
 	outStream(outStream)
 {
-	assert(recipients.size() > 0);
-	assert(!useHTML || attachmentFileName.empty());
+	assert(content.recipients.size() > 0);
 
 	if (testMode)
 	{
 		outStream << "Using cURL version:" << std::endl << curl_version() << std::endl;
-		outStream << "Attachment file name: '" << UString::ToStringType(attachmentFileName) << "'" << std::endl;
+		for (const auto& a : content.attachments)
+			outStream << "Attachment file name: '" << UString::ToStringType(a.fileName) << "'" << std::endl;
 	}
 }
 
@@ -88,83 +119,78 @@ EmailSender::EmailSender(const std::string &subject, const std::string &message,
 //==========================================================================
 bool EmailSender::Send()
 {
-	CURL *curl = curl_easy_init();
-	CURLcode result;
-
-	if (!curl)
-		return false;
-
-	GeneratePayloadText();
-	uploadCtx.linesRead = 0;
-	uploadCtx.et = this;
-
-	struct curl_slist *recipientList = nullptr;
-
-	curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
-	curl_easy_setopt(curl, CURLOPT_URL, loginInfo.smtpUrl.c_str());
-
-	if (disableSignaling)
-		curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+	SMTPSession session(loginInfo, testMode, outStream);
+	session.DisableSignaling(disableSignaling);
+	return Send(session);
+}
 
-	if (!loginInfo.caCertificatePath.empty())
-		curl_easy_setopt(curl, CURLOPT_CAPATH, loginInfo.caCertificatePath.c_str());
+//==========================================================================
+// Class:			EmailSender
+// Function:		Send
+//
+// Description:		Sends e-mail as specified using an existing session.  The
+//					session's connection is reused if it is still open.
+//					Long recipient lists are split over several transactions
+//					(with the same body); sending stops at the first
+//					transaction which fails.
+//
+// Input Arguments:
+//		session	= SMTPSession&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool
+//
+//==========================================================================
+bool EmailSender::Send(SMTPSession &session)
+{
+	PrintRecipients();
+	ResetRecipientResults();
+	ResetSharedContent();
 
-	if (loginInfo.oAuth2Token.empty())
-	{
-		if (loginInfo.useSSL)
-			curl_easy_setopt(curl, CURLOPT_USE_SSL, CURLUSESSL_ALL);
-		curl_easy_setopt(curl, CURLOPT_PASSWORD, loginInfo.password.c_str());
-	}
-	else
+	std::vector<size_t> remaining(content.recipients.size());
+	std::iota(remaining.begin(), remaining.end(), 0);
+	while (!remaining.empty())
 	{
-		curl_easy_setopt(curl, CURLOPT_USE_SSL, CURLUSESSL_ALL);
-		curl_easy_setopt(curl, CURLOPT_XOAUTH2_BEARER, UString::ToNarrowString(OAuth2Interface::Get().GetAccessToken()).c_str());
-	}
+		const size_t count(maxRecipientsPerTransaction > 0 ? std::min(maxRecipientsPerTransaction, remaining.size()) : remaining.size());
+		const std::vector<AddressInfo> chunk(GetChunk(remaining, count));
+		PreparePayload(chunk);
 
-	if (testMode)
-	{
-		outStream << "Sending messages from " << UString::ToStringType(loginInfo.localEmail) << " to ";
-		unsigned int i;
-		for (i = 0; i < recipients.size(); i++)
+		const bool success(session.Send(chunk, &PayloadReader::CURLReadCallback, &PayloadReader::CURLSeekCallback, &payload));
+		lastResult = session.GetLastResult();
+
+		// libcurl does not report the reply to each RCPT
+		size_t i;
+		for (i = 0; i < count; ++i)
 		{
-			if (i > 0)
-				outStream << ", ";
-			outStream << UString::ToStringType(recipients[i].address);
+			recipientResults[remaining[i]].reply.code = static_cast<int>(lastResult.responseCode);
+			recipientResults[remaining[i]].reply.text = lastResult.description;
 		}
-		outStream << std::endl;
-		curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
-	}
-
-	curl_easy_setopt(curl, CURLOPT_USERNAME, loginInfo.localEmail.c_str());
-	curl_easy_setopt(curl, CURLOPT_MAIL_FROM, ("<" + loginInfo.localEmail + ">").c_str());
-
-	for (const auto& r : recipients)
-		recipientList = curl_slist_append(recipientList, ("<" + r.address + ">").c_str());
-	curl_easy_setopt(curl, CURLOPT_MAIL_RCPT, recipientList);
 
-	curl_easy_setopt(curl, CURLOPT_READFUNCTION, &EmailSender::PayloadSource);
-	curl_easy_setopt(curl, CURLOPT_READDATA, &uploadCtx);
+		if (!success)
+			return false;
 
-	//curl_easy_setopt(curl, CURLOPT_DEBUGFUNCTION, DebugCallback);
-	result = curl_easy_perform(curl);
-
-	if(result != CURLE_OK)
-		outStream << "Failed sending e-mail:  " << curl_easy_strerror(result) << std::endl;
-
-    curl_slist_free_all(recipientList);
-    curl_easy_cleanup(curl);
+		remaining.erase(remaining.begin(), remaining.begin() + count);
+	}
 
-	return result == CURLE_OK;
+	return true;
 }
 
 //==========================================================================
 // Class:			EmailSender
-// Function:		SendREST
+// Function:		Send
 //
-// Description:		Sends e-mail as using Google's REST API.
+// Description:		Sends e-mail as specified using an existing SMTPClient.
+//					The client's connection is reused if it is still open.
+//					Long recipient lists are split over several transactions
+//					(with the same body), no larger than the server's limit
+//					if it declares one.  Recipients rejected in one
+//					transaction do not stop the others.
 //
 // Input Arguments:
-//		None
+//		client	= SMTPClient&
 //
 // Output Arguments:
 //		None
@@ -173,51 +199,91 @@ bool EmailSender::Send()
 //		bool
 //
 //==========================================================================
-bool EmailSender::SendREST()
+bool EmailSender::Send(SMTPClient &client)
 {
-	EmailPOSTer poster;
-	poster.SetVerboseOutput(testMode);
+	PrintRecipients();
+	ResetRecipientResults();
+	ResetSharedContent();
 
-	EmailPOSTer::AdditionalPostData postHeaders;
-	postHeaders.headerList = curl_slist_append(postHeaders.headerList, (std::string("Authorization: Bearer ") + UString::ToNarrowString(OAuth2Interface::Get().GetAccessToken())).c_str());
-	postHeaders.headerList = curl_slist_append(postHeaders.headerList, "Content-Type: application/json");
+	// Connect first, so the server's recipient limit is known
+	if (!client.Open())
+	{
+		lastResult = client.GetLastResult();
+		return false;
+	}
 
-	GeneratePayloadText();
-	std::string mail;
-	for (const auto& line : payloadText)
-		mail.append(line);
+	std::vector<size_t> remaining(content.recipients.size());
+	std::iota(remaining.begin(), remaining.end(), 0);
 
-	mail = Base64Encode(mail, false);
+	size_t limit(maxRecipientsPerTransaction);
+	bool success(true);
+	SendResult failure;
+	while (!remaining.empty())
+	{
+		const size_t serverLimit(client.GetExtensions().maxRecipients);
+		if (serverLimit > 0 && (limit == 0 || serverLimit < limit))
+			limit = serverLimit;
 
-	std::string jsonBody(std::string("{ raw: \"") + mail + std::string("\"}"));
-	std::string response;
-	const auto result(poster.POST(UString::ToStringType(loginInfo.smtpUrl), jsonBody, postHeaders, response));
-	if (!result || testMode)
-		outStream << "Response to send POST:\n" << UString::ToStringType(response) << std::endl;
+		const size_t count(limit > 0 ? std::min(limit, remaining.size()) : remaining.size());
+		const std::vector<AddressInfo> chunk(GetChunk(remaining, count));
+		PreparePayload(chunk);
 
-	return result;
-}
+		const bool sent(client.Send(chunk, payload));
+		lastResult = client.GetLastResult();
+		if (!sent && success)
+		{
+			success = false;
+			failure = lastResult;
+		}
 
-bool EmailSender::EmailPOSTer::POST(const UString::String &url, const std::string &data, const AdditionalPostData& additionalData, std::string &response)
-{
-	return DoCURLPost(url, data, response, &EmailSender::EmailPOSTer::AddOAuthToken, &additionalData);
-}
+		const std::vector<SMTPProtocol::RecipientResult> &results(client.GetRecipientResults());
+		if (results.size() != count || std::none_of(results.begin(), results.end(), [](const SMTPProtocol::RecipientResult &r)
+		{
+			return r.reply.code != 0;
+		}))
+			break;// Failure was not specific to these recipients (i.e. the connection failed)
 
-bool EmailSender::EmailPOSTer::AddOAuthToken(CURL* curl, const ModificationData* data)
-{
-	// Below is possibly better in newer versions of libcurl?
-	//curl_easy_setopt(curl, CURLOPT_XOAUTH2_BEARER, UString::ToNarrowString(OAuth2Interface::Get().GetAccessToken()).c_str());
-	const AdditionalPostData* args(dynamic_cast<const AdditionalPostData*>(data));
-	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, args->headerList);
+		const bool anyAccepted(std::any_of(results.begin(), results.end(), [](const SMTPProtocol::RecipientResult &r)
+		{
+			return r.reply.IsPositive();
+		}));
+
+		// Recipients refused because the transaction had too many are sent
+		// in the next transaction, which is limited to the number accepted
+		std::vector<size_t> next;
+		size_t i;
+		for (i = 0; i < count; ++i)
+		{
+			const SMTPProtocol::Reply &reply(results[i].reply);
+			if (reply.code == 452 && anyAccepted)
+				next.push_back(remaining[i]);
+			else if (reply.IsPositive() && !sent)// Recipient was accepted, but the message was not
+			{
+				recipientResults[remaining[i]].reply.code = static_cast<int>(lastResult.responseCode);
+				recipientResults[remaining[i]].reply.text = lastResult.description;
+			}
+			else
+				recipientResults[remaining[i]].reply = reply;
+		}
 
-	return true;
+		if (!next.empty())
+			limit = count - next.size();
+
+		next.insert(next.end(), remaining.begin() + count, remaining.end());
+		remaining.swap(next);
+	}
+
+	if (!success)
+		lastResult = failure;
+	return success;
 }
 
 //==========================================================================
 // Class:			EmailSender
-// Function:		GeneratePayloadText
+// Function:		PrintRecipients
 //
-// Description:		Generates e-mail payload.
+// Description:		In test mode, prints the sender and recipients of the
+//					message.
 //
 // Input Arguments:
 //		None
@@ -229,155 +295,184 @@ bool EmailSender::EmailPOSTer::AddOAuthToken(CURL* curl, const ModificationData*
 //		None
 //
 //==========================================================================
-void EmailSender::GeneratePayloadText()
+void EmailSender::PrintRecipients()
 {
-	payloadText.clear();
-	GenerateMessageText();
+	if (!testMode)
+		return;
 
-	auto payloadLines(7 + messageText.size());
-	std::string base64File;
-	if (!attachmentFileName.empty())
+	outStream << "Sending messages from " << UString::ToStringType(loginInfo.localEmail) << " to ";
+	unsigned int i;
+	for (i = 0; i < content.recipients.size(); i++)
 	{
-		assert(!useHTML);
-		unsigned int lines;
-		base64File = Base64EncodeFile(attachmentFileName, lines);
-		payloadLines += 18 + lines;// Not sure why 18 (I count 16), but there is an extra +2 that needs to be here
+		if (i > 0)
+			outStream << ", ";
+		outStream << UString::ToStringType(content.recipients[i].address);
 	}
-	else if (useHTML)
-		payloadLines += 11;
-
-	payloadText.resize(payloadLines);
+	outStream << std::endl;
+}
 
-	std::string list;
-	unsigned int k(0);
-	for (const auto& r : recipients)
+//==========================================================================
+// Class:			EmailSender
+// Function:		SendBatch (static)
+//
+// Description:		Sends each of the specified messages, one after the other,
+//					over the specified session.  The connection is opened and
+//					authenticated (at most) once for the whole batch.
+//
+// Input Arguments:
+//		messages	= const std::vector<Message>&
+//		session		= SMTPSession&
+//		testMode	= const bool&
+//		outStream	= UString::OStream&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::vector<bool>, true for each message that was sent successfully
+//
+//==========================================================================
+std::vector<bool> EmailSender::SendBatch(const std::vector<Message> &messages, SMTPSession &session,
+	const bool &testMode, UString::OStream &outStream)
+{
+	std::vector<bool> results;
+	results.reserve(messages.size());
+	for (const auto& m : messages)
 	{
-		if (!list.empty())
-			list.append(", ");
-		list.append(NameToHeaderAddress(r));
+		EmailSender sender(m, session.GetLoginInfo(), testMode, outStream);
+		results.push_back(sender.Send(session));
 	}
 
-	std::string boundary(GenerateBoundryID());
-
-	// Normal header
-	payloadText[k] = "Date: " + GetDateString() + "\n"; k++;
-	payloadText[k] = "To: " + list + "\n"; k++;
-	payloadText[k] = "From: " + loginInfo.localEmail + "\n"; k++;
-	payloadText[k] = "Message-ID: " + GenerateMessageID() + "\n"; k++;
-	payloadText[k] = "Subject: " + subject + "\n"; k++;
+	return results;
+}
 
-	// Special header contents when attaching a file
-	if (!attachmentFileName.empty())
-	{
-		payloadText[k] = "Content-Type: multipart/mixed; boundary=" + boundary + "\n"; k++;
-		payloadText[k] = "MIME-Version: 1.0\n"; k++;
-		payloadText[k] = "\n"; k++;
-		payloadText[k] = "This is a multi-part message in MIME format.\n"; k++;
-		payloadText[k] = "\n"; k++;
-		payloadText[k] = "--" + boundary + "\n"; k++;
-		payloadText[k] = "Content-Type: text/plain; charset=ISO-8859-1\n"; k++;
-		payloadText[k] = "Content-Transfer-Encoding: quoted-printable\n"; k++;
-	}
-	else if (useHTML)
-	{
-		payloadText[k] = "Content-Type: text/html; charset=ISO-8859-1\n"; k++;
-		payloadText[k] = "Content-Transfer-Encoding: quoted-printable\n"; k++;
-		payloadText[k] = "MIME-Version: 1.0\n"; k++;
-		payloadText[k] = "\n"; k++;
-		payloadText[k] = "<html>\n"; k++;
-		payloadText[k] = "<head>\n"; k++;
-		payloadText[k] = "<meta http-equiv=3D\"Content-Type\" content=3D\"text/html; charset=3D\"UTF-8\">\n"; k++;
-		payloadText[k] = "</head>\n"; k++;
-		payloadText[k] = "<body>\n"; k++;
-	}
+//==========================================================================
+// Class:			EmailSender
+// Function:		SendBatch (static)
+//
+// Description:		Sends each of the specified messages, one after the other,
+//					over a single new session.
+//
+// Input Arguments:
+//		messages	= const std::vector<Message>&
+//		loginInfo	= const LoginInfo&
+//		testMode	= const bool&
+//		outStream	= UString::OStream&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::vector<bool>, true for each message that was sent successfully
+//
+//==========================================================================
+std::vector<bool> EmailSender::SendBatch(const std::vector<Message> &messages, const LoginInfo &loginInfo,
+	const bool &testMode, UString::OStream &outStream)
+{
+	SMTPSession session(loginInfo, testMode, outStream);
+	return SendBatch(messages, session, testMode, outStream);
+}
 
-	// Normal body
-	payloadText[k] = "\n"; k++;// Empty line to divide headers from body
-	for (const auto& messageLine : messageText)
+//==========================================================================
+// Class:			EmailSender
+// Function:		SendREST
+//
+// Description:		Sends e-mail as using Google's REST API.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool
+//
+//==========================================================================
+bool EmailSender::SendREST()
+{
+	if (loginInfo.rateLimiter && !loginInfo.rateLimiter->Acquire(static_cast<unsigned int>(content.recipients.size())))
 	{
-		payloadText[k] = messageLine;
-		k++;
+		lastResult = SendResult::Deferred("Sending limit reached");
+		outStream << "Failed sending e-mail:  " << lastResult.description << std::endl;
+		return false;
 	}
 
-	// Special body contents when attaching a file
-	if (!attachmentFileName.empty())
-	{
-		const std::string fileNameOnly(attachmentFileName.substr(attachmentFileName.find_last_of('/') + 1));
-		const auto extension(GetExtension(attachmentFileName));
+	EmailPOSTer poster;
+	poster.SetVerboseOutput(testMode);
 
-		payloadText[k] = "\n"; k++;
-		payloadText[k] = "--" + boundary + "\n"; k++;
-		if (IsImageExtension(extension))
-		{
-			payloadText[k] = "Content-Type: image/" + extension + ";\n"; k++;
-		}
-		else
-		{
-			payloadText[k] = "Content-Type: image/" + extension + ";\n"; k++;// TODO:  How to attach other files?
-		}
-		payloadText[k] = "	name=\"" + fileNameOnly + "\"\n"; k++;
-		payloadText[k] = "Content-Transfer-Encoding: base64\n"; k++;
-		payloadText[k] = "Content-Disposition: attachment;\n"; k++;
-		payloadText[k] = "	filename=\"" + fileNameOnly + "\";\n"; k++;
+	EmailPOSTer::AdditionalPostData postData;
+	std::string url, body;
+	BuildRESTRequest(url, body, postData);
 
-		size_t cr(0);
-		while (cr != std::string::npos)
-		{
-			const size_t lastCr(cr);
-			cr = base64File.find("\n", lastCr + 1);
-			payloadText[k] = base64File.substr(lastCr,
-				std::min(cr - lastCr, (size_t)base64File.size() - lastCr)); k++;
-		}
-		payloadText[k] = "--" + boundary + "\n"; k++;
-	}
-	else if (useHTML)
-	{
-		// TODO:  Should it be the caller's responsiblity to already have
-		// formatted the message to include these tags?
-		payloadText[k] = "</body>\n"; k++;
-		payloadText[k] = "</html>\n"; k++;
-	}
+	std::string response;
+	EmailPOSTer::TransferStatus status;
+	poster.POST(UString::ToStringType(url), body, postData, response, &status);
+	lastResult = SendResult::Make(SendResult::Protocol::HTTP, static_cast<CURLcode>(status.curlCode),
+		status.responseCode, static_cast<unsigned int>(status.retryAfter * 1000));
+	if (!lastResult.success || testMode)
+		outStream << "Response to send POST:\n" << UString::ToStringType(response) << std::endl;
 
-	payloadText[k] = "\0"; k++;
+	if (loginInfo.rateLimiter && status.responseCode == 429)
+		loginInfo.rateLimiter->ReportThrottled();
 
-	assert(k == payloadLines);
+	curl_slist_free_all(postData.headerList);
+	return lastResult.success;
 }
 
 //==========================================================================
 // Class:			EmailSender
-// Function:		GenerateMessageText
+// Function:		BuildRESTRequest
 //
-// Description:		Creates the buffer for the message text.
+// Description:		Generates the URL, body and headers for sending this message
+//					using Google's REST API.  For media uploads, the body is
+//					left empty and the payload is streamed instead.
 //
 // Input Arguments:
 //		None
 //
 // Output Arguments:
-//		None
+//		url			= std::string&
+//		body		= std::string&
+//		postData	= EmailPOSTer::AdditionalPostData&, headerList must be
+//					  freed by the caller
 //
 // Return Value:
 //		None
 //
 //==========================================================================
-void EmailSender::GenerateMessageText()
+void EmailSender::BuildRESTRequest(std::string &url, std::string &body, EmailPOSTer::AdditionalPostData &postData)
 {
-	messageText.clear();
-	std::istringstream mStream(message);
-	std::string line;
+	postData.headerList = curl_slist_append(postData.headerList, (std::string("Authorization: Bearer ") + UString::ToNarrowString(OAuth2Interface::Get().GetAccessToken())).c_str());
 
-	while (std::getline(mStream, line))
-		messageText.push_back(line + '\n');
+	ResetSharedContent();
+	GeneratePayloadText(content, true);
+	if (mediaUpload)
+	{
+		url = GetMediaUploadURL(loginInfo.smtpUrl);
+		postData.headerList = curl_slist_append(postData.headerList, "Content-Type: message/rfc822");
+		postData.payload = &payload;
+		body.clear();
+	}
+	else
+	{
+		url = loginInfo.smtpUrl;
+		postData.headerList = curl_slist_append(postData.headerList, "Content-Type: application/json");
+		body = std::string("{\"raw\":\"") + Base64::Encode(payload.ReadAll(), false, Base64::Alphabet::URLSafe) + std::string("\"}");
+	}
 }
 
 //==========================================================================
 // Class:			EmailSender
-// Function:		NameToHeaderAddress
+// Function:		GetMediaUploadURL (static)
 //
-// Description:		Converts from a name to an address and name (i.e.
-//					user@domain (Name)).
+// Description:		Converts the URL of Gmail's send method to the URL for
+//					uploading the raw message (i.e. inserts "/upload" before
+//					the path and requests a simple media upload).  URLs which
+//					already specify an upload type are not modified.
 //
 // Input Arguments:
-//		a		= const AddressInfo
+//		url	= const std::string&
 //
 // Output Arguments:
 //		None
@@ -386,16 +481,28 @@ void EmailSender::GenerateMessageText()
 //		std::string
 //
 //==========================================================================
-std::string EmailSender::NameToHeaderAddress(const AddressInfo& a)
+std::string EmailSender::GetMediaUploadURL(const std::string &url)
 {
-	return a.displayName + " (" + a.address + ")";
+	if (url.find("uploadType=") != std::string::npos)
+		return url;
+
+	std::string uploadURL(url);
+	const std::string::size_type schemeEnd(url.find("://"));
+	const std::string::size_type pathStart(url.find('/', schemeEnd == std::string::npos ? 0 : schemeEnd + 3));
+	if (pathStart != std::string::npos && url.compare(pathStart, 8, "/upload/") != 0)
+		uploadURL.insert(pathStart, "/upload");
+
+	uploadURL.append(url.find('?') == std::string::npos ? "?" : "&");
+	uploadURL.append("uploadType=media");
+	return uploadURL;
 }
 
 //==========================================================================
 // Class:			EmailSender
-// Function:		GetDateString
+// Function:		PreparePayload
 //
-// Description:		Returns the formatted date string for the e-mail header.
+// Description:		Generates the payload so it is ready to be read by cURL,
+//					with a new Date and Message-ID.
 //
 // Input Arguments:
 //		None
@@ -404,35 +511,64 @@ std::string EmailSender::NameToHeaderAddress(const AddressInfo& a)
 //		None
 //
 // Return Value:
-//		std::string
+//		None
 //
 //==========================================================================
-std::string EmailSender::GetDateString()
+void EmailSender::PreparePayload()
 {
-	time_t nowTime;
-	time(&nowTime);
+	ResetSharedContent();
+	GeneratePayloadText(content);
+}
 
-	const unsigned int bufferSize(80);
-	char buffer[bufferSize];
+//==========================================================================
+// Class:			EmailSender
+// Function:		PreparePayload
+//
+// Description:		Generates the payload for a transaction to some of the
+//					recipients.  The body, Date and Message-ID are generated
+//					once and shared by all of the transactions of one send,
+//					since they carry the same message.
+//
+// Input Arguments:
+//		recipients	= const std::vector<AddressInfo>&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void EmailSender::PreparePayload(const std::vector<AddressInfo> &recipients)
+{
+	if (sharedMessageID.empty())
+	{
+		sharedDate = MessageBuilder::GenerateDate();
+		sharedMessageID = MessageBuilder::GenerateMessageID(loginInfo.localEmail);
+	}
 
-#ifdef _WIN32
-	struct tm now;
-	localtime_s(&now, &nowTime);
-	strftime(buffer, bufferSize, "%a, %d %b %Y %H:%M:%S %z", &now);
-#else
-	struct tm *now;
-	now = localtime(&nowTime);
-	strftime(buffer, bufferSize, "%a, %d %b %Y %H:%M:%S %z", now);
-#endif
+	if (recipients.size() == content.recipients.size())
+	{
+		GeneratePayloadText(content);
+		return;
+	}
+
+	if (!sharedBody)
+		sharedBody = content.renderedBody ? content.renderedBody : MessageBuilder::RenderBody(content);
 
-	return buffer;
+	Message chunk;
+	chunk.subject = content.subject;
+	chunk.recipients = recipients;
+	chunk.renderedBody = sharedBody;
+	chunk.undisclosedRecipients = content.undisclosedRecipients;
+	GeneratePayloadText(chunk);
 }
 
 //==========================================================================
 // Class:			EmailSender
-// Function:		GenerateMessageID
+// Function:		ResetRecipientResults
 //
-// Description:		Generates a unique message ID.
+// Description:		Clears the reply recorded for each recipient.
 //
 // Input Arguments:
 //		None
@@ -441,30 +577,27 @@ std::string EmailSender::GetDateString()
 //		None
 //
 // Return Value:
-//		std::string
+//		None
 //
 //==========================================================================
-std::string EmailSender::GenerateMessageID() const
+void EmailSender::ResetRecipientResults()
 {
-	UString::String id(_T("<"));
-	id.append(OAuth2Interface::Base36Encode(
-		std::chrono::duration_cast<std::chrono::milliseconds>(
-		TimingUtility::Clock::now().time_since_epoch()).count()));
-	id.append(_T("."));
-	id.append(OAuth2Interface::Base36Encode((int64_t)rand() * (int64_t)rand()
-		* (int64_t)rand() * (int64_t)rand()));
-	id.append(_T("@"));
-	id.append(UString::ToStringType(ExtractDomain(loginInfo.localEmail)));
-	id.append(_T(">"));
-
-	return UString::ToNarrowString(id);
+	recipientResults.resize(content.recipients.size());
+	size_t i;
+	for (i = 0; i < content.recipients.size(); ++i)
+	{
+		recipientResults[i].address = content.recipients[i].address;
+		recipientResults[i].reply = SMTPProtocol::Reply();
+	}
 }
 
 //==========================================================================
 // Class:			EmailSender
-// Function:		GenerateBoundryID
+// Function:		ResetSharedContent
 //
-// Description:		Generates a unique boundary ID.
+// Description:		Clears the body, Date and Message-ID shared by the
+//					transactions of the previous send, so the next send
+//					generates new ones.
 //
 // Input Arguments:
 //		None
@@ -473,229 +606,210 @@ std::string EmailSender::GenerateMessageID() const
 //		None
 //
 // Return Value:
-//		std::string
+//		None
 //
 //==========================================================================
-std::string EmailSender::GenerateBoundryID()
+void EmailSender::ResetSharedContent()
 {
-	return UString::ToNarrowString(OAuth2Interface::Base36Encode(
-		(int64_t)rand() * (int64_t)rand()
-		* (int64_t)rand() * (int64_t)rand()
-		* (int64_t)rand() * (int64_t)rand()
-		* (int64_t)rand() * (int64_t)rand()));
+	sharedBody.reset();
+	sharedDate.clear();
+	sharedMessageID.clear();
 }
 
 //==========================================================================
 // Class:			EmailSender
-// Function:		PayloadSource
+// Function:		GetChunk
 //
-// Description:		Copies message payload to the send buffer.
+// Description:		Returns the recipients for the next transaction.
 //
 // Input Arguments:
-//		ptr		= void*
-//		size	= size_t
-//		nmemb	= size_t
-//		userp	= void*
+//		indices	= const std::vector<size_t>&, recipients not yet sent to
+//		count	= const size_t&
 //
 // Output Arguments:
 //		None
 //
 // Return Value:
-//		size_t
+//		std::vector<AddressInfo>
 //
 //==========================================================================
-size_t EmailSender::PayloadSource(void *ptr, size_t size, size_t nmemb, void *userp)
+std::vector<EmailSender::AddressInfo> EmailSender::GetChunk(const std::vector<size_t> &indices, const size_t &count) const
+{
+	std::vector<AddressInfo> chunk(count);
+	size_t i;
+	for (i = 0; i < count; ++i)
+		chunk[i] = content.recipients[indices[i]];
+	return chunk;
+}
+
+bool EmailSender::EmailPOSTer::POST(const UString::String &url, const std::string &data, const AdditionalPostData& additionalData, std::string &response, TransferStatus *status)
 {
-	struct UploadStatus *uploadCtx = static_cast<struct UploadStatus*>(userp);
-	const char *data;
+	return DoCURLPost(url, data, response, &EmailSender::EmailPOSTer::ApplyAdditionalData, &additionalData, status);
+}
 
-	if ((size == 0) || (nmemb == 0) || ((size * nmemb) < 1))
-		return 0;
+bool EmailSender::EmailPOSTer::Prepare(CURL* curl, const UString::String &url, const std::string &data, const AdditionalPostData& additionalData, std::string &response) const
+{
+	return ConfigurePost(curl, url, data, response, &EmailSender::EmailPOSTer::ApplyAdditionalData, &additionalData);
+}
+
+bool EmailSender::EmailPOSTer::ApplyAdditionalData(CURL* curl, const ModificationData* data)
+{
+	// Below is possibly better in newer versions of libcurl?
+	//curl_easy_setopt(curl, CURLOPT_XOAUTH2_BEARER, UString::ToNarrowString(OAuth2Interface::Get().GetAccessToken()).c_str());
+	const AdditionalPostData* args(dynamic_cast<const AdditionalPostData*>(data));
+	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, args->headerList);
 
-	data = uploadCtx->et->payloadText[uploadCtx->linesRead].c_str();
-	if (data)
+	if (args->payload)
 	{
-		size_t len = strlen(data);
-		memcpy(ptr, data, len);
-		uploadCtx->linesRead++;
-		return len;
+		// With no POSTFIELDS, cURL reads the body from the callback
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, nullptr);
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(args->payload->GetSize()));
+		curl_easy_setopt(curl, CURLOPT_READFUNCTION, &PayloadReader::CURLReadCallback);
+		curl_easy_setopt(curl, CURLOPT_READDATA, args->payload);
+		curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, &PayloadReader::CURLSeekCallback);
+		curl_easy_setopt(curl, CURLOPT_SEEKDATA, args->payload);
 	}
 
-	return 0;
+	return true;
 }
 
 //==========================================================================
 // Class:			EmailSender
-// Function:		ExtractDomain
+// Function:		RenderBody (static)
 //
-// Description:		Extracts the domain from an e-mail address.
+// Description:		Renders the body (everything following the per-recipient
+//					headers, including encoded attachments) of the message.
+//					See MessageBuilder::RenderBody().
 //
 // Input Arguments:
-//		s	= const std::string&
+//		message	= const Message&
 //
 // Output Arguments:
 //		None
 //
 // Return Value:
-//		std::string
+//		std::shared_ptr<const std::string>
 //
 //==========================================================================
-std::string EmailSender::ExtractDomain(const std::string &s)
+std::shared_ptr<const std::string> EmailSender::RenderBody(const Message &message)
 {
-	size_t start = s.find("@");
-	if (start == std::string::npos)
-		return "";
-
-	return s.substr(start + 1);
+	return MessageBuilder::RenderBody(message);
 }
 
 //==========================================================================
 // Class:			EmailSender
-// Function:		Base64Encode
+// Function:		RenderPayload
 //
-// Description:		Encodes the specified string into a base64 string.
+// Description:		Generates the complete message (headers and body) as it
+//					would be sent.
 //
 // Input Arguments:
-//		s			= const std::string&
-//		wrapLines	= const bool&
+//		None
 //
 // Output Arguments:
-//		lines	= unsigned int*
+//		None
 //
 // Return Value:
 //		std::string
 //
 //==========================================================================
-std::string EmailSender::Base64Encode(const std::string &s, const bool& wrapLines, unsigned int *lines)
+std::string EmailSender::RenderPayload()
 {
-	const char* charset = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-
-	unsigned int localLines = 0;
-	std::string buf;
-	for (unsigned int i = 0; i < s.size(); i += 3)
-	{
-		unsigned char oct1(s[i]);
-		unsigned char oct2(0);
-		unsigned char oct3(0);
-
-		if (i + 1 < s.size())
-			oct2 = s[i + 1];
-		if (i + 2 < s.size())
-			oct3 = s[i + 2];
-
-		unsigned char hex1(oct1 >> 2);
-		unsigned char hex2(((oct1 & 0x3) << 4) | (oct2 >> 4));
-		unsigned char hex3(((oct2 & 0xf) << 2) | (oct3 >> 6));
-		unsigned char hex4(oct3 & 0x3f);
-
-		buf += charset[hex1];
-		buf += charset[hex2];
-
-		if (i + 1 < s.size())
-			buf += charset[hex3];
-		else
-			buf += "=";
-
-		if (i + 2 < s.size())
-			buf += charset[hex4];
-		else
-			buf += "=";
-
-		if (wrapLines && (buf.size() - localLines) % 76 == 0)
-		{
-			buf += "\n";
-			localLines++;
-		}
-	}
-
-	if (wrapLines)
-		buf += "\n";
-
-	if (lines)
-		*lines = localLines;
-
-	return buf;
+	PreparePayload();
+	return payload.ReadAll();
 }
 
 //==========================================================================
 // Class:			EmailSender
-// Function:		Base64EncodeFile
+// Function:		GeneratePayloadText
 //
-// Description:		Encodes the specified file into a base64 string.
+// Description:		Generates e-mail payload, signed if the login has a DKIM
+//					signer.  Uses the shared Date and Message-ID while the
+//					recipients of one send are split over several
+//					transactions.
 //
 // Input Arguments:
-//		fileName	= const std::string
+//		message		= const Message&
+//		bccHeader	= const bool&, lists undisclosed recipients in a Bcc
+//					  field (for Gmail's API)
 //
 // Output Arguments:
-//		lines	= unsigned int&
+//		None
 //
 // Return Value:
-//		std::string
+//		None
 //
 //==========================================================================
-std::string EmailSender::Base64EncodeFile(const std::string &fileName, unsigned int &lines)
+void EmailSender::GeneratePayloadText(const Message &message, const bool &bccHeader)
 {
-	lines = 1;
-	std::ifstream inFile(fileName.c_str(), std::ios::binary);
-	if (!inFile.is_open() || !inFile.good())
-		return std::string();
-
-	// FIXME:  Perofrmance could be improved by pre-allocating the return buffer
+	payload.Clear();
+	MessageBuilder::Build(message, loginInfo.localEmail, payload, bccHeader, sharedDate, sharedMessageID);
 
-	inFile >> std::noskipws;
-	unsigned char uc;
-	std::string s;
-	while (inFile >> uc, !inFile.eof())
-		s.push_back(uc);
-
-	return Base64Encode(s, true, &lines);
+	if (loginInfo.dkimSigner && !loginInfo.dkimSigner->Sign(payload))
+		outStream << "Failed to add DKIM signature" << std::endl;
 }
 
 //==========================================================================
 // Class:			EmailSender
-// Function:		GetExtension
+// Function:		CopyContent (static)
 //
-// Description:		Returns the extension (everything after the '.') for the
-//					specified text.
+// Description:		Copies the parts of the message which are required to
+//					send it.  If the message has a rendered body, the body
+//					text and attachments are not copied.
 //
 // Input Arguments:
-//		s	= const std::string&
+//		message	= const Message&
 //
 // Output Arguments:
 //		None
 //
 // Return Value:
-//		std::string
+//		Message
 //
 //==========================================================================
-std::string EmailSender::GetExtension(const std::string &s)
+EmailSender::Message EmailSender::CopyContent(const Message &message)
 {
-	return s.substr(s.find_last_of('.') + 1);
+	Message content;
+	content.subject = message.subject;
+	content.recipients = message.recipients;
+	content.useHTML = message.useHTML;
+	content.undisclosedRecipients = message.undisclosedRecipients;
+	content.renderedBody = message.renderedBody;
+	if (content.renderedBody)
+		return content;
+
+	content.attachments = message.attachments;
+	content.bodyTemplate = message.bodyTemplate;
+	if (content.bodyTemplate)
+		content.templateValues = message.templateValues;
+	else
+		content.message = message.message;
+
+	return content;
 }
 
 //==========================================================================
 // Class:			EmailSender
-// Function:		IsImageExtension
+// Function:		ToAttachmentList
 //
-// Description:		Returns true if the extension is a known image format.
+// Description:		Converts a single (optional) attachment file name into
+//					a list of attachments.
 //
 // Input Arguments:
-//		extension	= std::string
+//		fileName	= const std::string&, may be empty
 //
 // Output Arguments:
 //		None
 //
 // Return Value:
-//		bool
+//		std::vector<Attachment>
 //
 //==========================================================================
-bool EmailSender::IsImageExtension(std::string extension)
+std::vector<EmailSender::Attachment> EmailSender::ToAttachmentList(const std::string &fileName)
 {
-	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c){ return static_cast<unsigned char>(std::tolower(c)); });
-	return extension == std::string("jpg") ||
-		extension == std::string("jpeg") ||
-		extension == std::string("png") ||
-		extension == std::string("bmp");
+	if (fileName.empty())
+		return std::vector<Attachment>();
+	return std::vector<Attachment>(1, Attachment{ fileName, std::string(), std::string() });
 }
 
 int EmailSender::DebugCallback(CURL*, curl_infotype type, char* data, size_t size, void*)
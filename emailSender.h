@@ -9,6 +9,9 @@
 // Local headers
 #include "utilities/uString.h"
 #include "jsonInterface.h"
+#include "payloadReader.h"
+#include "sendResult.h"
+#include "smtpProtocol.h"
 
 // cURL headers
 #include <curl/curl.h>
@@ -18,6 +21,15 @@
 #include <vector>
 #include <memory>
 
+class SMTPSession;
+class SMTPClient;
+class SendEngine;
+class SMTPEventEngine;
+class RESTBatchSender;
+class MessageTemplate;
+class RateLimiter;
+class DKIMSigner;
+
 class EmailSender
 {
 public:
@@ -29,6 +41,8 @@ public:
 		std::string password;
 		bool useSSL;
 		std::string caCertificatePath;
+		std::shared_ptr<RateLimiter> rateLimiter;// Optional; share one instance between all senders for the account
+		std::shared_ptr<const DKIMSigner> dkimSigner;// Optional; signs every message sent with this login
 	};
 
 	struct AddressInfo
@@ -37,52 +51,70 @@ public:
 		std::string displayName;
 	};
 
+	struct Attachment
+	{
+		std::string fileName;
+		std::string contentType;// If empty, determined from the file extension
+		std::string contentID;// If not empty, attachment is inline and can be referenced from HTML as "cid:<contentID>"
+	};
+
+	struct Message
+	{
+		std::string subject;
+		std::string message;
+		std::vector<Attachment> attachments;
+		std::vector<AddressInfo> recipients;
+		bool useHTML = false;
+
+		// From RenderBody(); if set, message, attachments and useHTML are ignored
+		std::shared_ptr<const std::string> renderedBody;
+
+		// If set, used in place of message with values substituted for its fields
+		std::shared_ptr<const MessageTemplate> bodyTemplate;
+		std::vector<std::string> templateValues;// Ordered by field index (see MessageTemplate::MakeValues())
+
+		// If set, the To field reads "undisclosed-recipients:;" and the recipients only appear in the envelope
+		bool undisclosedRecipients = false;
+	};
+
 	EmailSender(const std::string &subject, const std::string &message, const std::string &attachmentFileName,
 		const std::vector<AddressInfo> &recipients, const LoginInfo &loginInfo, const bool &useHTML,
 		const bool &testMode, UString::OStream &outStream = Cout);
+	EmailSender(const Message &message, const LoginInfo &loginInfo, const bool &testMode,
+		UString::OStream &outStream = Cout);
 
 	bool Send();
+	bool Send(SMTPSession &session);
+	bool Send(SMTPClient &client);// Pipelined/chunked transfer (see SMTPProtocol)
 
 	bool SendREST();
+	void UseMediaUpload(const bool& use = true) { mediaUpload = use; }// Stream raw MIME for SendREST() instead of base64-in-JSON
+
+	// Details of the last Send() or SendREST()
+	const SendResult& GetLastResult() const { return lastResult; }
+
+	static std::vector<bool> SendBatch(const std::vector<Message> &messages, SMTPSession &session,
+		const bool &testMode, UString::OStream &outStream = Cout);
+	static std::vector<bool> SendBatch(const std::vector<Message> &messages, const LoginInfo &loginInfo,
+		const bool &testMode, UString::OStream &outStream = Cout);
 
 	void DisableSignaling(const bool& disable = true) { disableSignaling = disable; }
 
-private:
-	const std::string subject;
-	const std::string message;
-	const std::string attachmentFileName;
-	const std::vector<AddressInfo> recipients;
-	const LoginInfo loginInfo;
-	const bool useHTML;
-	const bool testMode;
-	bool disableSignaling;
-	UString::OStream &outStream;
+	// Longer recipient lists are split over several transactions (zero for no limit; SMTP only)
+	void SetMaxRecipientsPerTransaction(const size_t &count) { maxRecipientsPerTransaction = count; }
 
-	struct UploadStatus
-	{
-		int linesRead = 0;
-		EmailSender* et = nullptr;
-	} uploadCtx;
-
-	static size_t PayloadSource(void *ptr, size_t size, size_t nmemb, void *userp);
-	void GeneratePayloadText();
-	std::vector<std::string> payloadText;
-
-	void GenerateMessageText();
-	std::vector<std::string> messageText;
-
-	std::string NameToHeaderAddress(const AddressInfo &a);
-	static std::string GetDateString();
-	std::string GenerateMessageID() const;
-	static std::string GenerateBoundryID();
-	static std::string ExtractDomain(const std::string &s);
-	static std::string Base64EncodeFile(const std::string &fileName, unsigned int &lines);
-	static std::string Base64Encode(const std::string &s, const bool& wrapLines = true, unsigned int *lines = nullptr);
-	static std::string GetExtension(const std::string &s);
-	
-	static bool IsImageExtension(std::string extension);
-	
-	static int DebugCallback(CURL* handle, curl_infotype type, char* data, size_t size, void *userp);
+	// Server's reply to each recipient from the last Send() (zero for recipients
+	// which were not attempted).  Only SMTPClient reports the reply to each RCPT;
+	// with SMTPSession, each recipient gets the reply to its transaction.
+	const std::vector<SMTPProtocol::RecipientResult>& GetRecipientResults() const { return recipientResults; }
+
+	static std::shared_ptr<const std::string> RenderBody(const Message &message);// Same as MessageBuilder::RenderBody()
+	std::string RenderPayload();// Complete message as it would be sent (i.e. for MessageSpool)
+
+private:
+	friend class SendEngine;
+	friend class RESTBatchSender;
+	friend class SMTPEventEngine;
 
 	class EmailPOSTer : public JSONInterface
 	{
@@ -90,13 +122,46 @@ private:
 		struct AdditionalPostData : public ModificationData
 		{
 			curl_slist* headerList = nullptr;
+			PayloadReader* payload = nullptr;// If set, streamed as the request body in place of data
 		};
 
-		bool POST(const UString::String &url, const std::string &data, const AdditionalPostData& additionalData, std::string &response);
+		using JSONInterface::TransferStatus;
+
+		bool POST(const UString::String &url, const std::string &data, const AdditionalPostData& additionalData, std::string &response, TransferStatus *status = nullptr);
+		bool Prepare(CURL* curl, const UString::String &url, const std::string &data, const AdditionalPostData& additionalData, std::string &response) const;
 
 	private:
-		static bool AddOAuthToken(CURL* curl, const ModificationData* tokenInfo);
+		static bool ApplyAdditionalData(CURL* curl, const ModificationData* data);
 	};
+
+	const Message content;
+	const LoginInfo loginInfo;
+	const bool testMode;
+	bool disableSignaling = false;
+	bool mediaUpload = false;
+	size_t maxRecipientsPerTransaction = 100;
+	UString::OStream &outStream;
+	SendResult lastResult;
+	std::vector<SMTPProtocol::RecipientResult> recipientResults;
+
+	void GeneratePayloadText(const Message &message, const bool &bccHeader = false);
+	void PrintRecipients();
+	void PreparePayload();
+	void PreparePayload(const std::vector<AddressInfo> &recipients);
+	void ResetRecipientResults();
+	void ResetSharedContent();
+	std::vector<AddressInfo> GetChunk(const std::vector<size_t> &indices, const size_t &count) const;
+	void BuildRESTRequest(std::string &url, std::string &body, EmailPOSTer::AdditionalPostData &postData);
+	PayloadReader payload;
+	std::shared_ptr<const std::string> sharedBody;// Rendered once when the recipients are split
+	std::string sharedDate;// Same for every transaction of one send when the recipients are split
+	std::string sharedMessageID;
+
+	static Message CopyContent(const Message &message);
+	static std::vector<Attachment> ToAttachmentList(const std::string &fileName);
+	static std::string GetMediaUploadURL(const std::string &url);
+
+	static int DebugCallback(CURL* handle, curl_infotype type, char* data, size_t size, void *userp);
 };
 
 #endif// EMAIL_SENDER_H_
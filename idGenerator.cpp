@@ -0,0 +1,124 @@
+// File:  idGenerator.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Fast, thread-safe random values and base-36 formatting for unique
+//        identifiers (i.e. Message-IDs and MIME boundaries).
+
+// Local headers
+#include "idGenerator.h"
+
+// Standard C++ headers
+#include <random>
+#include <thread>
+#include <chrono>
+#include <functional>
+
+namespace
+{
+	uint64_t SplitMix64(uint64_t &state)
+	{
+		uint64_t z(state += 0x9e3779b97f4a7c15ULL);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	}
+
+	uint64_t RotateLeft(const uint64_t &x, const int &k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+
+	class Xoshiro256
+	{
+	public:
+		Xoshiro256()
+		{
+			// The thread ID and time are mixed in as well, in case
+			// random_device is deterministic on this platform
+			std::random_device device;
+			uint64_t seed((static_cast<uint64_t>(device()) << 32) ^ device());
+			seed ^= std::hash<std::thread::id>()(std::this_thread::get_id());
+			seed ^= static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+
+			for (auto& s : state)
+				s = SplitMix64(seed);
+		}
+
+		uint64_t Next()
+		{
+			const uint64_t result(RotateLeft(state[1] * 5, 7) * 9);
+			const uint64_t t(state[1] << 17);
+
+			state[2] ^= state[0];
+			state[3] ^= state[1];
+			state[1] ^= state[2];
+			state[0] ^= state[3];
+			state[2] ^= t;
+			state[3] = RotateLeft(state[3], 45);
+
+			return result;
+		}
+
+	private:
+		uint64_t state[4];
+	};
+}
+
+//==========================================================================
+// Class:			IDGenerator
+// Function:		Next
+//
+// Description:		Returns the next random value from this thread's
+//					generator.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		uint64_t
+//
+//==========================================================================
+uint64_t IDGenerator::Next()
+{
+	thread_local Xoshiro256 generator;
+	return generator.Next();
+}
+
+//==========================================================================
+// Class:			IDGenerator
+// Function:		ToBase36
+//
+// Description:		Formats the value in base 36.
+//
+// Input Arguments:
+//		value	= uint64_t
+//
+// Output Arguments:
+//		buffer	= char*, at least MaxBase36Length characters
+//
+// Return Value:
+//		size_t, number of characters written
+//
+//==========================================================================
+size_t IDGenerator::ToBase36(uint64_t value, char *buffer)
+{
+	static const char charset[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+
+	// Digits are generated from the end, then moved to the front
+	char digits[MaxBase36Length];
+	size_t start(MaxBase36Length);
+	do
+	{
+		digits[--start] = charset[value % 36];
+		value /= 36;
+	} while (value);
+
+	const size_t length(MaxBase36Length - start);
+	for (size_t i = 0; i < length; ++i)
+		buffer[i] = digits[start + i];
+
+	return length;
+}
@@ -0,0 +1,27 @@
+// File:  idGenerator.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Fast, thread-safe random values and base-36 formatting for unique
+//        identifiers (i.e. Message-IDs and MIME boundaries).
+
+#ifndef ID_GENERATOR_H_
+#define ID_GENERATOR_H_
+
+// Standard C++ headers
+#include <cstdint>
+#include <cstddef>
+
+// Each thread has its own generator (xoshiro256**), seeded from the OS on
+// first use, so generating IDs requires no locking.
+namespace IDGenerator
+{
+	uint64_t Next();
+
+	// Writes the value in base 36 (lower case, no terminator) and returns the
+	// number of characters written.  The buffer must hold at least
+	// MaxBase36Length characters.
+	const size_t MaxBase36Length(13);
+	size_t ToBase36(uint64_t value, char *buffer);
+}
+
+#endif// ID_GENERATOR_H_
@@ -25,6 +25,7 @@
 
 // Local headers
 #include "jsonInterface.h"
+#include "multiplexedTransport.h"
 
 //==========================================================================
 // Class:			JSONInterface
@@ -51,6 +52,7 @@ JSONInterface::JSONInterface(const UString::String& userAgent) : userAgent(userA
 // Function:		DoCURLPost
 //
 // Description:		Creates a cURL object, POSTs, obtains response, and cleans up.
+//					Uses the shared transport if it is enabled.
 //
 // Input Arguments:
 //		url					= const UString::String&
@@ -60,6 +62,7 @@ JSONInterface::JSONInterface(const UString::String& userAgent) : userAgent(userA
 //
 // Output Arguments:
 //		response	= std::string&
+//		status		= TransferStatus* (optional), details of the transfer
 //
 // Return Value:
 //		bool, true for success, false otherwise
@@ -67,7 +70,7 @@ JSONInterface::JSONInterface(const UString::String& userAgent) : userAgent(userA
 //==========================================================================
 bool JSONInterface::DoCURLPost(const UString::String &url, const std::string &data,
 	std::string &response, CURLModification curlModification,
-	const ModificationData* modificationData) const
+	const ModificationData* modificationData, TransferStatus* status) const
 {
 	CURL *curl = curl_easy_init();
 	if (!curl)
@@ -76,6 +79,64 @@ bool JSONInterface::DoCURLPost(const UString::String &url, const std::string &da
 		return false;
 	}
 
+	if (!ConfigurePost(curl, url, data, response, curlModification, modificationData))
+	{
+		curl_easy_cleanup(curl);
+		return false;
+	}
+
+	const auto transport(MultiplexedTransport::Get());
+	CURLcode result = transport ? transport->Perform(curl) : curl_easy_perform(curl);
+	if (status)
+	{
+		status->curlCode = result;
+		curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status->responseCode);
+#if LIBCURL_VERSION_NUM >= 0x074200
+		curl_off_t retryAfter(0);
+		if (curl_easy_getinfo(curl, CURLINFO_RETRY_AFTER, &retryAfter) == CURLE_OK)
+			status->retryAfter = static_cast<long>(retryAfter);
+#endif
+	}
+
+//	curl_free(urlEncodedData);
+	if(result != CURLE_OK)
+	{
+		Cerr << "Failed issuing https POST:  " << curl_easy_strerror(result) << "." << std::endl;
+		curl_easy_cleanup(curl);
+		return false;
+	}
+
+	curl_easy_cleanup(curl);
+	return true;
+}
+
+//==========================================================================
+// Class:			JSONInterface
+// Function:		ConfigurePost
+//
+// Description:		Sets the options required to POST on an existing cURL
+//					object, but does not perform the request.  The data and
+//					response arguments must remain valid until the request is
+//					complete.
+//
+// Input Arguments:
+//		curl				= CURL*
+//		url					= const UString::String&
+//		data				= const std::string&
+//		curlModification	= CURLModification
+//		modificationData	= const ModificationData*
+//
+// Output Arguments:
+//		response	= std::string&
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool JSONInterface::ConfigurePost(CURL *curl, const UString::String &url, const std::string &data,
+	std::string &response, CURLModification curlModification,
+	const ModificationData* modificationData) const
+{
 	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, JSONInterface::CURLWriteCallback);
 	response.clear();
 	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
@@ -108,17 +169,6 @@ bool JSONInterface::DoCURLPost(const UString::String &url, const std::string &da
 		return false;
 
 	curl_easy_setopt(curl, CURLOPT_URL, UString::ToNarrowString(url).c_str());
-	CURLcode result = curl_easy_perform(curl);
-
-//	curl_free(urlEncodedData);
-	if(result != CURLE_OK)
-	{
-		Cerr << "Failed issuing https POST:  " << curl_easy_strerror(result) << "." << std::endl;
-		curl_easy_cleanup(curl);
-		return false;
-	}
-
-	curl_easy_cleanup(curl);
 	return true;
 }
 
@@ -127,6 +177,7 @@ bool JSONInterface::DoCURLPost(const UString::String &url, const std::string &da
 // Function:		DoCURLGet
 //
 // Description:		Creates a cURL object, GETs, obtains response, and cleans up.
+//					Uses the shared transport if it is enabled.
 //
 // Input Arguments:
 //		url					= const std::string&
@@ -173,7 +224,8 @@ bool JSONInterface::DoCURLGet(const UString::String &url, std::string &response,
 		return false;
 
 	curl_easy_setopt(curl, CURLOPT_URL, UString::ToNarrowString(url).c_str());
-	CURLcode result = curl_easy_perform(curl);
+	const auto transport(MultiplexedTransport::Get());
+	CURLcode result = transport ? transport->Perform(curl) : curl_easy_perform(curl);
 
 	if(result != CURLE_OK)
 	{
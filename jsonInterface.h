@@ -46,7 +46,17 @@ protected:
 	typedef bool (*CURLModification)(CURL*, const ModificationData*);
 	static bool DoNothing(CURL*, const ModificationData*) { return true; }
 
+	struct TransferStatus
+	{
+		int curlCode = 0;// CURLcode
+		long responseCode = 0;
+		long retryAfter = 0;// [sec], from the Retry-After header
+	};
+
 	bool DoCURLPost(const UString::String &url, const std::string &data,
+		std::string &response, CURLModification curlModification = &JSONInterface::DoNothing,
+		const ModificationData* modificationData = nullptr, TransferStatus* status = nullptr) const;
+	bool ConfigurePost(CURL *curl, const UString::String &url, const std::string &data,
 		std::string &response, CURLModification curlModification = &JSONInterface::DoNothing,
 		const ModificationData* modificationData = nullptr) const;
 	bool DoCURLGet(const UString::String &url, std::string &response,
@@ -0,0 +1,52 @@
+// File:  lineScanner.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Splits text into lines without copying.
+
+// Local headers
+#include "lineScanner.h"
+
+// Standard C++ headers
+#include <cstring>
+
+//==========================================================================
+// Class:			LineScanner
+// Function:		Next
+//
+// Description:		Finds the next line.  The search for the terminator uses
+//					memchr(), which the C library implements with SIMD
+//					instructions.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		line	= std::string_view&, excluding the line terminator
+//
+// Return Value:
+//		bool, true if a line was found, false at the end of the text
+//
+//==========================================================================
+bool LineScanner::Next(std::string_view &line)
+{
+	if (position >= text.size())
+		return false;
+
+	const char *start(text.data() + position);
+	const size_t remaining(text.size() - position);
+	const char *end(static_cast<const char*>(memchr(start, '\n', remaining)));
+	if (!end)
+	{
+		line = std::string_view(start, remaining);
+		position = text.size();
+		return true;
+	}
+
+	size_t length(end - start);
+	position += length + 1;
+	if (length > 0 && start[length - 1] == '\r')
+		--length;
+
+	line = std::string_view(start, length);
+	return true;
+}
@@ -0,0 +1,30 @@
+// File:  lineScanner.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Splits text into lines without copying.
+
+#ifndef LINE_SCANNER_H_
+#define LINE_SCANNER_H_
+
+// Standard C++ headers
+#include <string_view>
+
+// Lines are returned as views into the original text (which must outlive the
+// scanner), without their "\n" or "\r\n" terminators, so that the caller can
+// write them with uniform line endings.  A final line without a terminator is
+// returned like any other; text ending in a terminator does not produce an
+// extra empty line.
+class LineScanner
+{
+public:
+	explicit LineScanner(const std::string_view &text) : text(text) {}
+
+	bool Next(std::string_view &line);
+	void Rewind() { position = 0; }
+
+private:
+	const std::string_view text;
+	size_t position = 0;
+};
+
+#endif// LINE_SCANNER_H_
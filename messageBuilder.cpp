@@ -0,0 +1,475 @@
+// File:  messageBuilder.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Renders messages (headers, body and attachments) into a payload,
+//        independently of any transport.
+
+// Local headers
+#include "messageBuilder.h"
+#include "messageTemplate.h"
+#include "quotedPrintable.h"
+#include "mimeTypes.h"
+#include "lineScanner.h"
+#include "idGenerator.h"
+#include "dateHeader.h"
+
+// rpi headers
+#include "utilities/timingUtility.h"
+
+// Standard C++ headers
+#include <chrono>
+
+//==========================================================================
+// Class:			MessageBuilder
+// Function:		Build (static)
+//
+// Description:		Appends the complete message to the payload.  The header
+//					text is sized exactly before it is generated.
+//					Undisclosed recipients only appear in the envelope, or in
+//					a Bcc field if requested (for Gmail's API, which reads
+//					the recipients from the header and removes Bcc).  The
+//					Date and Message-ID are generated unless they are given
+//					(so transactions carrying the same message to different
+//					recipients can share them).
+//
+// Input Arguments:
+//		message		= const EmailSender::Message&
+//		fromAddress	= const std::string&
+//		bccHeader	= const bool&
+//		date		= const std::string&, empty to use the current time
+//		messageID	= const std::string&, empty to generate a new one
+//
+// Output Arguments:
+//		payload		= PayloadReader&
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void MessageBuilder::Build(const EmailSender::Message &message, const std::string &fromAddress, PayloadReader &payload,
+	const bool &bccHeader, const std::string &date, const std::string &messageID)
+{
+	const bool bcc(message.undisclosedRecipients && bccHeader);
+
+	std::string list;
+	if (!message.undisclosedRecipients || bcc)
+	{
+		for (const auto& r : message.recipients)
+		{
+			if (!list.empty())
+				list.append(", ");
+			list.append(NameToHeaderAddress(r));
+		}
+	}
+
+	char generatedDate[DateHeader::MaxLength];
+	const char *dateText(date.c_str());
+	size_t dateLength(date.size());
+	if (date.empty())
+	{
+		dateLength = DateHeader::Format(generatedDate);
+		dateText = generatedDate;
+	}
+
+	const std::string id(messageID.empty() ? GenerateMessageID(fromAddress) : messageID);
+
+	static const std::string dateField("Date: "), toField("To: "), bccField("Bcc: "), fromField("From: "),
+		messageIDField("Message-ID: "), subjectField("Subject: "), undisclosed("undisclosed-recipients:;");
+
+	const std::string &toList(message.undisclosedRecipients ? undisclosed : list);
+
+	std::string text;
+	text.reserve(dateField.size() + dateLength + toField.size() + toList.size()
+		+ (bcc ? bccField.size() + list.size() + 1 : 0)
+		+ fromField.size() + fromAddress.size() + messageIDField.size() + id.size()
+		+ subjectField.size() + message.subject.size() + 5);
+
+	// Normal header
+	text.append(dateField).append(dateText, dateLength).append("\n");
+	text.append(toField).append(toList).append("\n");
+	if (bcc)
+		text.append(bccField).append(list).append("\n");
+	text.append(fromField).append(fromAddress).append("\n");
+	text.append(messageIDField).append(id).append("\n");
+	text.append(subjectField).append(message.subject).append("\n");
+
+	if (message.renderedBody)
+	{
+		payload.AppendText(std::move(text));
+		payload.Append(std::unique_ptr<PayloadReader::Source>(new PayloadReader::SharedTextSource(message.renderedBody)));
+		return;
+	}
+
+	GenerateBody(message.message, message.bodyTemplate, message.templateValues, message.attachments,
+		message.useHTML, text, payload);
+}
+
+//==========================================================================
+// Class:			MessageBuilder
+// Function:		Render (static)
+//
+// Description:		Generates the complete message as a single string.
+//
+// Input Arguments:
+//		message		= const EmailSender::Message&
+//		fromAddress	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string
+//
+//==========================================================================
+std::string MessageBuilder::Render(const EmailSender::Message &message, const std::string &fromAddress)
+{
+	PayloadReader reader;
+	Build(message, fromAddress, reader);
+	return reader.ReadAll();
+}
+
+//==========================================================================
+// Class:			MessageBuilder
+// Function:		RenderBody (static)
+//
+// Description:		Renders the body (everything following the per-recipient
+//					headers, including encoded attachments) of the message.
+//					When the same message is sent to many recipients, the
+//					result can be assigned to Message::renderedBody so the
+//					body is generated once and shared by all of the senders.
+//
+// Input Arguments:
+//		message	= const EmailSender::Message&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::shared_ptr<const std::string>
+//
+//==========================================================================
+std::shared_ptr<const std::string> MessageBuilder::RenderBody(const EmailSender::Message &message)
+{
+	PayloadReader reader;
+	std::string text;
+	GenerateBody(message.message, message.bodyTemplate, message.templateValues, message.attachments,
+		message.useHTML, text, reader);
+	return std::make_shared<const std::string>(reader.ReadAll());
+}
+
+//==========================================================================
+// Class:			MessageBuilder
+// Function:		GenerateBody (static)
+//
+// Description:		Appends the MIME headers, message body and attachments
+//					to the payload.  Attachments are streamed from their
+//					files when the payload is read.  Attachments with a
+//					Content-ID are placed in a multipart/related part with
+//					the body, nested within multipart/mixed if there are
+//					also regular attachments.
+//
+// Input Arguments:
+//		message			= const std::string&, ignored if bodyTemplate is set
+//		bodyTemplate	= const std::shared_ptr<const MessageTemplate>&, may be
+//						  empty
+//		templateValues	= const std::vector<std::string>&, ordered by field
+//						  index
+//		attachments		= const std::vector<Attachment>&
+//		useHTML			= const bool&
+//		text			= std::string&, text already generated, but not yet
+//						  added to the payload
+//
+// Output Arguments:
+//		payload		= PayloadReader&
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void MessageBuilder::GenerateBody(const std::string &message, const std::shared_ptr<const MessageTemplate> &bodyTemplate,
+	const std::vector<std::string> &templateValues, const std::vector<EmailSender::Attachment> &attachments,
+	const bool &useHTML, std::string &text, PayloadReader &payload)
+{
+	text.reserve(text.size() + message.size() + message.size() / 16 + 1024);
+
+	const std::string bodyType(useHTML ? "text/html" : "text/plain");
+
+	// Attachments referenced by Content-ID are grouped with the body in a
+	// multipart/related part (RFC 2387); any others follow it in a
+	// multipart/mixed part
+	std::vector<const EmailSender::Attachment*> inlineAttachments, otherAttachments;
+	for (const auto& a : attachments)
+	{
+		if (a.contentID.empty())
+			otherAttachments.push_back(&a);
+		else
+			inlineAttachments.push_back(&a);
+	}
+
+	const std::string mixedBoundary(otherAttachments.empty() ? std::string() : GenerateBoundryID());
+	const std::string relatedBoundary(inlineAttachments.empty() ? std::string() : GenerateBoundryID());
+
+	// Special header contents when attaching files
+	if (!otherAttachments.empty())
+	{
+		text.append("Content-Type: multipart/mixed; boundary=" + mixedBoundary + "\n");
+		text.append("MIME-Version: 1.0\n");
+		text.append("\n");
+		text.append("This is a multi-part message in MIME format.\n");
+		text.append("\n");
+		text.append("--" + mixedBoundary + "\n");
+	}
+
+	if (!inlineAttachments.empty())
+	{
+		text.append("Content-Type: multipart/related; type=\"" + bodyType + "\"; boundary=" + relatedBoundary + "\n");
+		if (otherAttachments.empty())
+		{
+			text.append("MIME-Version: 1.0\n");
+			text.append("\n");
+			text.append("This is a multi-part message in MIME format.\n");
+		}
+		text.append("\n");
+		text.append("--" + relatedBoundary + "\n");
+	}
+
+	text.append("Content-Type: " + bodyType + "; charset=ISO-8859-1\n");
+	text.append("Content-Transfer-Encoding: quoted-printable\n");
+	if (attachments.empty())
+		text.append("MIME-Version: 1.0\n");
+
+	// Normal body
+	text.append("\n");// Empty line to divide headers from body
+	QuotedPrintable::Encoder encoder;
+	if (useHTML)
+	{
+		encoder.Encode("<html>\n"
+			"<head>\n"
+			"<meta http-equiv=\"Content-Type\" content=\"text/html; charset=\"UTF-8\">\n"
+			"</head>\n"
+			"<body>\n", text);
+	}
+
+	if (bodyTemplate)
+	{
+		// Encoded separately; the template ends with a newline, so the text which follows starts a new line
+		payload.AppendText(std::move(text));
+		payload.Append(std::unique_ptr<PayloadReader::Source>(new QuotedPrintable::Source(
+			std::unique_ptr<PayloadReader::Source>(new MessageTemplate::Source(bodyTemplate, templateValues)))));
+		text.clear();
+	}
+	else
+	{
+		LineScanner scanner(message);
+		std::string_view line;
+		while (scanner.Next(line))
+		{
+			encoder.Encode(line.data(), line.size(), text);
+			encoder.Encode("\n", 1, text);
+		}
+	}
+
+	if (useHTML)
+	{
+		// TODO:  Should it be the caller's responsiblity to already have
+		// formatted the message to include these tags?
+		encoder.Encode("</body>\n"
+			"</html>\n", text);
+	}
+	encoder.Finish(text);
+
+	if (!inlineAttachments.empty())
+	{
+		for (const auto& a : inlineAttachments)
+			AppendAttachment(*a, relatedBoundary, text, payload);
+		text.append("--" + relatedBoundary + "--\n");
+	}
+
+	if (!otherAttachments.empty())
+	{
+		for (const auto& a : otherAttachments)
+			AppendAttachment(*a, mixedBoundary, text, payload);
+		text.append("--" + mixedBoundary + "--\n");
+	}
+
+	payload.AppendText(std::move(text));
+}
+
+//==========================================================================
+// Class:			MessageBuilder
+// Function:		AppendAttachment (static)
+//
+// Description:		Appends the part headers for the attachment to the text,
+//					then adds the text and the attachment to the payload.  The
+//					attachment is streamed from its file when the payload is
+//					read.
+//
+// Input Arguments:
+//		attachment	= const EmailSender::Attachment&
+//		boundary	= const std::string&, of the enclosing multipart part
+//		text		= std::string&, text already generated, but not yet
+//					  added to the payload (cleared on return)
+//
+// Output Arguments:
+//		payload		= PayloadReader&
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void MessageBuilder::AppendAttachment(const EmailSender::Attachment &attachment, const std::string &boundary,
+	std::string &text, PayloadReader &payload)
+{
+	const std::string fileNameOnly(ExtractFileName(attachment.fileName));
+
+	text.append("\n");
+	text.append("--" + boundary + "\n");
+	text.append("Content-Type: " + (attachment.contentType.empty() ?
+		std::string(MIMETypes::FromFileName(attachment.fileName)) : attachment.contentType) + ";\n");
+	text.append("	name=\"" + fileNameOnly + "\"\n");
+	text.append("Content-Transfer-Encoding: base64\n");
+	if (attachment.contentID.empty())
+		text.append("Content-Disposition: attachment;\n");
+	else
+	{
+		text.append("Content-ID: <" + attachment.contentID + ">\n");
+		text.append("Content-Disposition: inline;\n");
+	}
+	text.append("	filename=\"" + fileNameOnly + "\"\n");
+	text.append("\n");
+
+	payload.AppendText(std::move(text));
+	payload.Append(std::unique_ptr<PayloadReader::Source>(new PayloadReader::Base64FileSource(attachment.fileName)));
+	text.clear();
+}
+
+//==========================================================================
+// Class:			MessageBuilder
+// Function:		NameToHeaderAddress (static)
+//
+// Description:		Converts from a name to an address and name (i.e.
+//					user@domain (Name)).
+//
+// Input Arguments:
+//		a		= const EmailSender::AddressInfo&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string
+//
+//==========================================================================
+std::string MessageBuilder::NameToHeaderAddress(const EmailSender::AddressInfo& a)
+{
+	return a.displayName + " (" + a.address + ")";
+}
+
+//==========================================================================
+// Class:			MessageBuilder
+// Function:		GenerateDate (static)
+//
+// Description:		Generates the Date field's value for the current time.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string
+//
+//==========================================================================
+std::string MessageBuilder::GenerateDate()
+{
+	char date[DateHeader::MaxLength];
+	return std::string(date, DateHeader::Format(date));
+}
+
+//==========================================================================
+// Class:			MessageBuilder
+// Function:		GenerateMessageID (static)
+//
+// Description:		Generates a unique message ID.
+//
+// Input Arguments:
+//		fromAddress	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string
+//
+//==========================================================================
+std::string MessageBuilder::GenerateMessageID(const std::string &fromAddress)
+{
+	// "<" + time + "." + random + "@"
+	char buffer[2 * IDGenerator::MaxBase36Length + 3];
+	size_t length(0);
+	buffer[length++] = '<';
+	length += IDGenerator::ToBase36(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+		TimingUtility::Clock::now().time_since_epoch()).count()), buffer + length);
+	buffer[length++] = '.';
+	length += IDGenerator::ToBase36(IDGenerator::Next(), buffer + length);
+	buffer[length++] = '@';
+
+	const std::string::size_type at(fromAddress.find('@'));
+	const size_t domainLength(at == std::string::npos ? 0 : fromAddress.size() - at - 1);
+
+	std::string id;
+	id.reserve(length + domainLength + 1);
+	id.append(buffer, length);
+	if (domainLength > 0)
+		id.append(fromAddress, at + 1, domainLength);
+	id.push_back('>');
+
+	return id;
+}
+
+//==========================================================================
+// Class:			MessageBuilder
+// Function:		GenerateBoundryID (static)
+//
+// Description:		Generates a unique boundary ID.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string
+//
+//==========================================================================
+std::string MessageBuilder::GenerateBoundryID()
+{
+	char buffer[2 * IDGenerator::MaxBase36Length];
+	size_t length(IDGenerator::ToBase36(IDGenerator::Next(), buffer));
+	length += IDGenerator::ToBase36(IDGenerator::Next(), buffer + length);
+	return std::string(buffer, length);
+}
+
+//==========================================================================
+// Class:			MessageBuilder
+// Function:		ExtractFileName (static)
+//
+// Description:		Returns the file name (without the directory) from the
+//					specified path.
+//
+// Input Arguments:
+//		path	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string
+//
+//==========================================================================
+std::string MessageBuilder::ExtractFileName(const std::string &path)
+{
+	return path.substr(path.find_last_of("/\\") + 1);
+}
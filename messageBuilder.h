@@ -0,0 +1,49 @@
+// File:  messageBuilder.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Renders messages (headers, body and attachments) into a payload,
+//        independently of any transport.
+
+#ifndef MESSAGE_BUILDER_H_
+#define MESSAGE_BUILDER_H_
+
+// Local headers
+#include "emailSender.h"
+#include "payloadReader.h"
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+#include <memory>
+
+// The payload is built from a small number of pieces (header text, shared or
+// template bodies, attachment files), so its exact size is known before any
+// of it is read.  Render() uses this to produce the message in a single
+// allocation.
+class MessageBuilder
+{
+public:
+	// Attachments are streamed from their files when the payload is read
+	static void Build(const EmailSender::Message &message, const std::string &fromAddress, PayloadReader &payload,
+		const bool &bccHeader = false, const std::string &date = std::string(), const std::string &messageID = std::string());
+	static std::string Render(const EmailSender::Message &message, const std::string &fromAddress);
+
+	// Everything following the per-recipient headers, for use as Message::renderedBody
+	static std::shared_ptr<const std::string> RenderBody(const EmailSender::Message &message);
+
+	static std::string GenerateBoundryID();
+	static std::string GenerateDate();
+	static std::string GenerateMessageID(const std::string &fromAddress);
+
+private:
+	static void GenerateBody(const std::string &message, const std::shared_ptr<const MessageTemplate> &bodyTemplate,
+		const std::vector<std::string> &templateValues, const std::vector<EmailSender::Attachment> &attachments,
+		const bool &useHTML, std::string &text, PayloadReader &payload);
+	static void AppendAttachment(const EmailSender::Attachment &attachment, const std::string &boundary,
+		std::string &text, PayloadReader &payload);
+
+	static std::string NameToHeaderAddress(const EmailSender::AddressInfo &a);
+	static std::string ExtractFileName(const std::string &path);
+};
+
+#endif// MESSAGE_BUILDER_H_
@@ -0,0 +1,1020 @@
+// File:  messageSpool.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Persistent, append-only spool of rendered messages which survives a
+//        crash or restart of the process.
+
+// Local headers
+#include "messageSpool.h"
+
+// OS headers
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+// Standard C++ headers
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <cassert>
+#include <iomanip>
+#include <sstream>
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		Constant definitions
+//
+// Description:		Constant definitions for the MessageSpool class.  Each
+//					record begins with the magic number, the length of the
+//					record body and the CRC of the body.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+const uint32_t MessageSpool::recordMagic(0x4C4F5053);// "SPOL"
+const size_t MessageSpool::recordHeaderSize(12);
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		MessageSpool
+//
+// Description:		Constructor for MessageSpool class.
+//
+// Input Arguments:
+//		directory			= const std::string&
+//		segmentSize			= const size_t&, size at which a new segment
+//							  file is started
+//		commitIntervalMs	= const unsigned int&, maximum time between
+//							  writing appended messages to disk
+//		outStream			= UString::OStream&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+MessageSpool::MessageSpool(const std::string &directory, const size_t &segmentSize,
+	const unsigned int &commitIntervalMs, UString::OStream &outStream) : directory(directory),
+	segmentSize(segmentSize), commitIntervalMs(commitIntervalMs), outStream(outStream)
+{
+	assert(segmentSize > 0 && segmentSize <= 0xFFFFFFFF);
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		~MessageSpool
+//
+// Description:		Destructor for MessageSpool class.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+MessageSpool::~MessageSpool()
+{
+	Close();
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		Open
+//
+// Description:		Opens the spool, creating the directory if necessary.
+//					Undelivered messages from existing segments are made
+//					available to Next().  New messages are always appended
+//					to a new segment.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool MessageSpool::Open()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	assert(!commitThread.joinable());
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (error)
+	{
+		outStream << "Failed to create spool directory '" << UString::ToStringType(directory) << "':  "
+			<< UString::ToStringType(error.message()) << std::endl;
+		return false;
+	}
+
+	std::vector<uint32_t> numbers;
+	for (const auto& file : std::filesystem::directory_iterator(directory, error))
+	{
+		if (file.path().extension() != ".log")
+			continue;
+
+		std::istringstream ss(file.path().stem().string());
+		uint32_t number;
+		if (ss >> number)
+			numbers.push_back(number);
+	}
+
+	if (error)
+	{
+		outStream << "Failed to read spool directory '" << UString::ToStringType(directory) << "':  "
+			<< UString::ToStringType(error.message()) << std::endl;
+		return false;
+	}
+
+	std::sort(numbers.begin(), numbers.end());
+	for (const auto& n : numbers)
+	{
+		if (!RecoverSegment(n))
+			return false;
+	}
+
+	activeSegment = numbers.empty() ? 1 : numbers.back() + 1;
+	activeSize = 0;
+	segments[activeSegment].active = true;
+
+	stopping = false;
+	commitFailed = false;
+	commitThread = std::thread(&MessageSpool::CommitThreadEntry, this);
+	return true;
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		Close
+//
+// Description:		Writes any remaining messages to disk, stops the commit
+//					thread and closes all files.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void MessageSpool::Close()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+
+	commitRequested.notify_all();
+	entryAvailable.notify_all();
+	if (commitThread.joinable())
+		commitThread.join();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto& s : segments)
+		CloseFiles(s.second);
+
+	segments.clear();
+	uncommitted.clear();
+	ready.clear();
+	handedOut.clear();
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		Append
+//
+// Description:		Adds the message to the spool.  The message is buffered
+//					and written to disk by the commit thread; call Commit()
+//					to wait for it to be written.
+//
+// Input Arguments:
+//		recipients	= const std::vector<EmailSender::AddressInfo>&
+//		payload		= const std::string&, complete message (headers and body)
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		EntryID
+//
+//==========================================================================
+MessageSpool::EntryID MessageSpool::Append(const std::vector<EmailSender::AddressInfo> &recipients,
+	const std::string &payload)
+{
+	size_t bodySize(4 + payload.size());
+	for (const auto& r : recipients)
+		bodySize += 8 + r.address.size() + r.displayName.size();
+
+	std::string record;
+	record.reserve(recordHeaderSize + bodySize);
+	AppendUInt32(record, recordMagic);
+	AppendUInt32(record, static_cast<uint32_t>(bodySize));
+	AppendUInt32(record, 0);// CRC placeholder
+
+	AppendUInt32(record, static_cast<uint32_t>(recipients.size()));
+	for (const auto& r : recipients)
+	{
+		AppendUInt32(record, static_cast<uint32_t>(r.address.size()));
+		record.append(r.address);
+		AppendUInt32(record, static_cast<uint32_t>(r.displayName.size()));
+		record.append(r.displayName);
+	}
+	record.append(payload);
+
+	std::string crc;
+	AppendUInt32(crc, ComputeCRC32(record.data() + recordHeaderSize, bodySize));
+	record.replace(8, 4, crc);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	assert(commitThread.joinable());
+	if (activeSize > 0 && activeSize + record.size() > segmentSize)
+	{
+		segments[activeSegment].active = false;
+		++activeSegment;
+		segments[activeSegment].active = true;
+		activeSize = 0;
+	}
+
+	Segment &segment(segments[activeSegment]);
+	const EntryID id(MakeID(activeSegment, static_cast<uint32_t>(activeSize)));
+	segment.unwrittenLog.append(record);
+	++segment.recordCount;
+	activeSize += record.size();
+
+	uncommitted.push_back(id);
+	++appendSequence;
+	return id;
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		Commit
+//
+// Description:		Waits until all messages appended so far are on disk.
+//					Callers waiting at the same time share a single sync.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool MessageSpool::Commit()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	if (!commitThread.joinable())
+		return false;
+
+	const uint64_t target(appendSequence);
+	++commitWaiters;
+	commitRequested.notify_one();
+	committed.wait(lock, [this, target]()
+	{
+		return commitSequence >= target || commitFailed || stopping;
+	});
+	--commitWaiters;
+
+	return !commitFailed && commitSequence >= target;
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		Next
+//
+// Description:		Reads the next message which has been written to disk and
+//					has not been handed out.  The caller must later call
+//					MarkDelivered() or Release() with the entry's ID.  The
+//					record is read without holding the mutex, so Append() is
+//					never blocked by the disk.
+//
+// Input Arguments:
+//		timeoutMs	= const unsigned int&
+//
+// Output Arguments:
+//		entry		= Entry&
+//
+// Return Value:
+//		bool, true if an entry was read, false otherwise
+//
+//==========================================================================
+bool MessageSpool::Next(Entry &entry, const unsigned int &timeoutMs)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		if (!entryAvailable.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]()
+		{
+			return !ready.empty() || stopping;
+		}) || ready.empty())
+			return false;
+
+		// Handed out before unlocking, so the segment can not be removed while
+		// the record is read
+		const EntryID id(ready.front());
+		ready.pop_front();
+		handedOut.insert(id);
+
+		const std::string fileName(GetLogFileName(GetSegment(id)));
+		lock.unlock();
+
+		FILE *file(fopen(fileName.c_str(), "rb"));
+		const bool success(file && ReadRecord(file, GetOffset(id), entry));
+		if (file)
+			fclose(file);
+
+		lock.lock();
+		if (success)
+		{
+			entry.id = id;
+			return true;
+		}
+
+		// Record is unreadable - count it as delivered so the segment can be removed
+		outStream << "Discarding corrupt spool record " << GetOffset(id) << " in '"
+			<< UString::ToStringType(fileName) << "'" << std::endl;
+		handedOut.erase(id);
+		const auto segment(segments.find(GetSegment(id)));
+		if (segment != segments.end())// Not closed while reading
+		{
+			AppendUInt32(segment->second.unwrittenIndex, GetOffset(id));
+			++segment->second.deliveredCount;
+		}
+	}
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		MarkDelivered
+//
+// Description:		Records that the message was delivered, so it will not be
+//					recovered if the process restarts.
+//
+// Input Arguments:
+//		id	= const EntryID&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void MessageSpool::MarkDelivered(const EntryID &id)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (handedOut.erase(id) == 0)
+		return;
+
+	Segment &segment(segments[GetSegment(id)]);
+	AppendUInt32(segment.unwrittenIndex, GetOffset(id));
+	++segment.deliveredCount;
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		Release
+//
+// Description:		Returns a message which was not delivered to the spool,
+//					so it will be handed out again.
+//
+// Input Arguments:
+//		id	= const EntryID&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void MessageSpool::Release(const EntryID &id)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (handedOut.erase(id) == 0)
+			return;
+		ready.push_front(id);
+	}
+
+	entryAvailable.notify_one();
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		GetUndeliveredCount
+//
+// Description:		Returns the number of messages which have not been
+//					delivered.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		size_t
+//
+//==========================================================================
+size_t MessageSpool::GetUndeliveredCount() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	size_t count(0);
+	for (const auto& s : segments)
+		count += s.second.recordCount - s.second.deliveredCount;
+	return count;
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		CommitThreadEntry
+//
+// Description:		Entry point for the commit thread.  Periodically (or when
+//					requested by Commit()) writes buffered messages and
+//					delivery records to disk.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void MessageSpool::CommitThreadEntry()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	bool exit(false);
+	while (!exit)
+	{
+		commitRequested.wait_for(lock, std::chrono::milliseconds(commitIntervalMs), [this]()
+		{
+			return stopping || (commitWaiters > 0 && commitSequence < appendSequence);
+		});
+		exit = stopping;
+
+		const uint64_t sequence(appendSequence);
+		const size_t newlyCommitted(uncommitted.size());
+
+		lock.unlock();
+		const bool success(WriteUnwritten());
+		lock.lock();
+
+		if (success)
+		{
+			commitSequence = sequence;
+			ready.insert(ready.end(), uncommitted.begin(), uncommitted.begin() + newlyCommitted);
+			uncommitted.erase(uncommitted.begin(), uncommitted.begin() + newlyCommitted);
+			RemoveDeliveredSegments();
+		}
+		else
+			commitFailed = true;
+
+		committed.notify_all();
+		if (newlyCommitted > 0)
+			entryAvailable.notify_all();
+	}
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		WriteUnwritten
+//
+// Description:		Writes buffered records and index entries to their files
+//					and syncs them.  Only the commit thread opens, writes and
+//					closes the segment files, so the mutex is held only while
+//					taking the buffers.  Files of inactive segments are closed
+//					after writing to limit the number of open files.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool MessageSpool::WriteUnwritten()
+{
+	struct Work
+	{
+		FILE **file;
+		std::string fileName;
+		std::string data;
+		bool closeAfter;
+	};
+
+	std::vector<Work> work;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto& s : segments)
+		{
+			if (!s.second.unwrittenLog.empty())
+			{
+				work.push_back(Work{ &s.second.log, GetLogFileName(s.first), std::string(), !s.second.active });
+				work.back().data.swap(s.second.unwrittenLog);
+			}
+
+			if (!s.second.unwrittenIndex.empty())
+			{
+				work.push_back(Work{ &s.second.index, GetIndexFileName(s.first), std::string(), !s.second.active });
+				work.back().data.swap(s.second.unwrittenIndex);
+			}
+		}
+	}
+
+	bool createdFile(false);
+	for (auto& w : work)
+	{
+		if (!*w.file)
+		{
+			createdFile = createdFile || !std::filesystem::exists(w.fileName);
+			*w.file = fopen(w.fileName.c_str(), "ab");
+		}
+
+		if (!*w.file || fwrite(w.data.data(), 1, w.data.size(), *w.file) != w.data.size() || !SyncFile(*w.file))
+		{
+			outStream << "Failed to write spool file '" << UString::ToStringType(w.fileName) << "'" << std::endl;
+			return false;
+		}
+
+		if (w.closeAfter)
+		{
+			fclose(*w.file);
+			*w.file = nullptr;
+		}
+	}
+
+#ifndef _WIN32
+	// New directory entries must also be synced to survive a crash
+	if (createdFile)
+	{
+		const int fd(open(directory.c_str(), O_RDONLY));
+		if (fd >= 0)
+		{
+			fsync(fd);
+			close(fd);
+		}
+	}
+#endif
+
+	return true;
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		RemoveDeliveredSegments
+//
+// Description:		Removes segments which are complete and whose messages
+//					have all been delivered.  Must be called from the commit
+//					thread with the mutex locked.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void MessageSpool::RemoveDeliveredSegments()
+{
+	auto it(segments.begin());
+	while (it != segments.end())
+	{
+		Segment &s(it->second);
+		if (s.active || s.deliveredCount < s.recordCount || !s.unwrittenLog.empty())
+		{
+			++it;
+			continue;
+		}
+
+		CloseFiles(s);
+		std::remove(GetLogFileName(it->first).c_str());
+		std::remove(GetIndexFileName(it->first).c_str());
+		it = segments.erase(it);
+	}
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		CloseFiles
+//
+// Description:		Closes the files associated with the segment.
+//
+// Input Arguments:
+//		segment	= Segment&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void MessageSpool::CloseFiles(Segment &segment)
+{
+	if (segment.log)
+		fclose(segment.log);
+	if (segment.index)
+		fclose(segment.index);
+
+	segment.log = nullptr;
+	segment.index = nullptr;
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		RecoverSegment
+//
+// Description:		Finds the undelivered messages in an existing segment.
+//					Each record's CRC is checked, and the segment is
+//					truncated at the first record which is incomplete or
+//					does not match its CRC (i.e. a record which was being
+//					written when the process crashed), so that record is
+//					never handed out.
+//
+// Input Arguments:
+//		number	= const uint32_t&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool MessageSpool::RecoverSegment(const uint32_t &number)
+{
+	const std::string logFileName(GetLogFileName(number));
+	const std::string indexFileName(GetIndexFileName(number));
+
+	std::set<uint32_t> delivered;
+	std::error_code error;
+	const auto indexSize(std::filesystem::file_size(indexFileName, error));
+	if (!error)
+	{
+		std::string index(static_cast<size_t>(indexSize), '\0');
+		FILE *file(fopen(indexFileName.c_str(), "rb"));
+		if (!file || fread(&index[0], 1, index.size(), file) != index.size())
+		{
+			if (file)
+				fclose(file);
+			outStream << "Failed to read spool index '" << UString::ToStringType(indexFileName) << "'" << std::endl;
+			return false;
+		}
+		fclose(file);
+
+		size_t position(0);
+		uint32_t offset;
+		while (ReadUInt32(index, position, offset))
+			delivered.insert(offset);
+
+		// Drop a partially written entry so new entries are aligned
+		if (position != index.size())
+			std::filesystem::resize_file(indexFileName, position, error);
+	}
+
+	const auto logSize(std::filesystem::file_size(logFileName, error));
+	FILE *file(fopen(logFileName.c_str(), "rb"));
+	if (error || !file)
+	{
+		if (file)
+			fclose(file);
+		outStream << "Failed to open spool segment '" << UString::ToStringType(logFileName) << "'" << std::endl;
+		return false;
+	}
+
+	Segment segment;
+	uint64_t offset(0);
+	std::string header(recordHeaderSize, '\0');
+	std::string body;
+	while (offset + recordHeaderSize <= logSize)
+	{
+		if (fseek(file, static_cast<long>(offset), SEEK_SET) != 0 ||
+			fread(&header[0], 1, header.size(), file) != header.size())
+			break;
+
+		size_t position(0);
+		uint32_t magic, length, crc;
+		if (!ReadUInt32(header, position, magic) || !ReadUInt32(header, position, length) ||
+			!ReadUInt32(header, position, crc) || magic != recordMagic ||
+			offset + recordHeaderSize + length > logSize)
+			break;
+
+		body.resize(length);
+		if (fread(&body[0], 1, body.size(), file) != body.size() || ComputeCRC32(body.data(), body.size()) != crc)
+			break;
+
+		++segment.recordCount;
+		if (delivered.find(static_cast<uint32_t>(offset)) != delivered.end())
+			++segment.deliveredCount;
+		else
+			ready.push_back(MakeID(number, static_cast<uint32_t>(offset)));
+
+		offset += recordHeaderSize + length;
+	}
+	fclose(file);
+
+	if (offset != logSize)
+	{
+		outStream << "Removing incomplete records at end of spool segment '"
+			<< UString::ToStringType(logFileName) << "'" << std::endl;
+		std::filesystem::resize_file(logFileName, offset, error);
+	}
+
+	if (segment.deliveredCount == segment.recordCount)
+	{
+		std::remove(logFileName.c_str());
+		std::remove(indexFileName.c_str());
+		return true;
+	}
+
+	segments[number] = std::move(segment);
+	return true;
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		ReadRecord (static)
+//
+// Description:		Reads and checks the record at the specified offset.
+//
+// Input Arguments:
+//		file	= FILE*
+//		offset	= const uint32_t&
+//
+// Output Arguments:
+//		entry	= Entry& (id is not set)
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool MessageSpool::ReadRecord(FILE *file, const uint32_t &offset, Entry &entry)
+{
+	std::string header(recordHeaderSize, '\0');
+	if (fseek(file, static_cast<long>(offset), SEEK_SET) != 0 ||
+		fread(&header[0], 1, header.size(), file) != header.size())
+		return false;
+
+	size_t position(0);
+	uint32_t magic, length, crc;
+	if (!ReadUInt32(header, position, magic) || !ReadUInt32(header, position, length) ||
+		!ReadUInt32(header, position, crc) || magic != recordMagic)
+		return false;
+
+	std::string body(length, '\0');
+	if (fread(&body[0], 1, body.size(), file) != body.size() || ComputeCRC32(body.data(), body.size()) != crc)
+		return false;
+
+	position = 0;
+	uint32_t count;
+	if (!ReadUInt32(body, position, count))
+		return false;
+
+	entry.recipients.clear();
+	uint32_t i;
+	for (i = 0; i < count; ++i)
+	{
+		EmailSender::AddressInfo r;
+		uint32_t size;
+		if (!ReadUInt32(body, position, size) || position + size > body.size())
+			return false;
+		r.address = body.substr(position, size);
+		position += size;
+
+		if (!ReadUInt32(body, position, size) || position + size > body.size())
+			return false;
+		r.displayName = body.substr(position, size);
+		position += size;
+
+		entry.recipients.push_back(std::move(r));
+	}
+
+	entry.payload = body.substr(position);
+	return true;
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		GetLogFileName
+//
+// Description:		Returns the path to the specified segment's log file.
+//
+// Input Arguments:
+//		number	= const uint32_t&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string
+//
+//==========================================================================
+std::string MessageSpool::GetLogFileName(const uint32_t &number) const
+{
+	std::ostringstream ss;
+	ss << directory << '/' << std::setw(10) << std::setfill('0') << number << ".log";
+	return ss.str();
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		GetIndexFileName
+//
+// Description:		Returns the path to the specified segment's index file.
+//
+// Input Arguments:
+//		number	= const uint32_t&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string
+//
+//==========================================================================
+std::string MessageSpool::GetIndexFileName(const uint32_t &number) const
+{
+	std::ostringstream ss;
+	ss << directory << '/' << std::setw(10) << std::setfill('0') << number << ".idx";
+	return ss.str();
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		MakeID (static)
+//
+// Description:		Combines the segment number and offset into an entry ID.
+//
+// Input Arguments:
+//		segment	= const uint32_t&
+//		offset	= const uint32_t&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		EntryID
+//
+//==========================================================================
+MessageSpool::EntryID MessageSpool::MakeID(const uint32_t &segment, const uint32_t &offset)
+{
+	return (static_cast<EntryID>(segment) << 32) | offset;
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		AppendUInt32 (static)
+//
+// Description:		Appends the value to the string (little-endian).
+//
+// Input Arguments:
+//		s		= std::string&
+//		value	= const uint32_t&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void MessageSpool::AppendUInt32(std::string &s, const uint32_t &value)
+{
+	const char bytes[4] = { static_cast<char>(value & 0xFF), static_cast<char>((value >> 8) & 0xFF),
+		static_cast<char>((value >> 16) & 0xFF), static_cast<char>((value >> 24) & 0xFF) };
+	s.append(bytes, 4);
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		ReadUInt32 (static)
+//
+// Description:		Reads a little-endian value from the string.
+//
+// Input Arguments:
+//		s			= const std::string&
+//		position	= size_t&, advanced past the value on success
+//
+// Output Arguments:
+//		value		= uint32_t&
+//
+// Return Value:
+//		bool, true for success, false if the string is too short
+//
+//==========================================================================
+bool MessageSpool::ReadUInt32(const std::string &s, size_t &position, uint32_t &value)
+{
+	if (position + 4 > s.size())
+		return false;
+
+	const unsigned char *bytes(reinterpret_cast<const unsigned char*>(s.data() + position));
+	value = static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+		(static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+	position += 4;
+	return true;
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		ComputeCRC32 (static)
+//
+// Description:		Computes the CRC-32 (as used by zlib) of the data.
+//
+// Input Arguments:
+//		data	= const char*
+//		size	= const size_t&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		uint32_t
+//
+//==========================================================================
+uint32_t MessageSpool::ComputeCRC32(const char *data, const size_t &size)
+{
+	static const std::vector<uint32_t> table([]()
+	{
+		std::vector<uint32_t> t(256);
+		uint32_t i;
+		for (i = 0; i < 256; ++i)
+		{
+			uint32_t c(i);
+			int k;
+			for (k = 0; k < 8; ++k)
+				c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+			t[i] = c;
+		}
+		return t;
+	}());
+
+	uint32_t crc(0xFFFFFFFF);
+	size_t i;
+	for (i = 0; i < size; ++i)
+		crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+	return crc ^ 0xFFFFFFFF;
+}
+
+//==========================================================================
+// Class:			MessageSpool
+// Function:		SyncFile (static)
+//
+// Description:		Flushes the file's buffers and waits for the data to
+//					reach the disk.
+//
+// Input Arguments:
+//		file	= FILE*
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool MessageSpool::SyncFile(FILE *file)
+{
+	if (fflush(file) != 0)
+		return false;
+
+#ifdef _WIN32
+	return _commit(_fileno(file)) == 0;
+#else
+	return fsync(fileno(file)) == 0;
+#endif
+}
@@ -0,0 +1,128 @@
+// File:  messageSpool.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Persistent, append-only spool of rendered messages which survives a
+//        crash or restart of the process.
+
+#ifndef MESSAGE_SPOOL_H_
+#define MESSAGE_SPOOL_H_
+
+// Local headers
+#include "emailSender.h"
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdint>
+
+// The spool directory holds numbered segment files (*.log) containing the
+// messages and matching index files (*.idx) listing the offsets of delivered
+// messages.  Append() only copies the message to a buffer; a background
+// thread writes buffered messages and syncs them to disk together (group
+// commit).  Messages are handed out by Next() only once they are on disk.
+// When every message in a segment has been delivered, its files are removed.
+// All methods are thread-safe.
+class MessageSpool
+{
+public:
+	MessageSpool(const std::string &directory, const size_t &segmentSize = 64 * 1024 * 1024,
+		const unsigned int &commitIntervalMs = 10, UString::OStream &outStream = Cout);
+	~MessageSpool();
+
+	MessageSpool(const MessageSpool&) = delete;
+	MessageSpool& operator=(const MessageSpool&) = delete;
+
+	// Recovers undelivered messages from an existing spool and starts the commit thread
+	bool Open();
+	void Close();
+
+	typedef uint64_t EntryID;
+
+	struct Entry
+	{
+		EntryID id;
+		std::vector<EmailSender::AddressInfo> recipients;
+		std::string payload;
+	};
+
+	EntryID Append(const std::vector<EmailSender::AddressInfo> &recipients, const std::string &payload);
+	bool Commit();// Blocks until everything appended so far is on disk
+
+	// Waits up to timeoutMs for a message which has not been handed out yet
+	bool Next(Entry &entry, const unsigned int &timeoutMs = 0);
+	void MarkDelivered(const EntryID &id);
+	void Release(const EntryID &id);// Returns a message to the spool (i.e. to be retried)
+
+	size_t GetUndeliveredCount() const;
+
+private:
+	static const uint32_t recordMagic;
+	static const size_t recordHeaderSize;
+
+	const std::string directory;
+	const size_t segmentSize;
+	const unsigned int commitIntervalMs;
+	UString::OStream &outStream;
+
+	struct Segment
+	{
+		FILE *log = nullptr;// For appending
+		FILE *index = nullptr;
+
+		bool active = false;
+		size_t recordCount = 0;
+		size_t deliveredCount = 0;
+
+		std::string unwrittenLog;
+		std::string unwrittenIndex;
+	};
+
+	mutable std::mutex mutex;
+	std::condition_variable commitRequested;
+	std::condition_variable committed;
+	std::condition_variable entryAvailable;
+
+	std::map<uint32_t, Segment> segments;
+	uint32_t activeSegment = 0;
+	size_t activeSize = 0;
+
+	std::deque<EntryID> uncommitted;
+	std::deque<EntryID> ready;
+	std::set<EntryID> handedOut;
+
+	uint64_t appendSequence = 0;
+	uint64_t commitSequence = 0;
+	unsigned int commitWaiters = 0;
+	bool commitFailed = false;
+	bool stopping = false;
+	std::thread commitThread;
+
+	void CommitThreadEntry();
+	bool WriteUnwritten();
+	void RemoveDeliveredSegments();
+	void CloseFiles(Segment &segment);
+
+	bool RecoverSegment(const uint32_t &number);
+	static bool ReadRecord(FILE *file, const uint32_t &offset, Entry &entry);
+
+	std::string GetLogFileName(const uint32_t &number) const;
+	std::string GetIndexFileName(const uint32_t &number) const;
+
+	static EntryID MakeID(const uint32_t &segment, const uint32_t &offset);
+	static uint32_t GetSegment(const EntryID &id) { return static_cast<uint32_t>(id >> 32); }
+	static uint32_t GetOffset(const EntryID &id) { return static_cast<uint32_t>(id & 0xFFFFFFFF); }
+
+	static void AppendUInt32(std::string &s, const uint32_t &value);
+	static bool ReadUInt32(const std::string &s, size_t &position, uint32_t &value);
+	static uint32_t ComputeCRC32(const char *data, const size_t &size);
+	static bool SyncFile(FILE *file);
+};
+
+#endif// MESSAGE_SPOOL_H_
@@ -0,0 +1,303 @@
+// File:  messageTemplate.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Message text containing {field} placeholders, parsed once and then
+//        rendered for each recipient directly into the payload.
+
+// Local headers
+#include "messageTemplate.h"
+
+// Standard C++ headers
+#include <cstring>
+#include <algorithm>
+#include <cassert>
+
+//==========================================================================
+// Class:			MessageTemplate
+// Function:		Constant definitions
+//
+// Description:		Constant definitions for the MessageTemplate class.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+const size_t MessageTemplate::npos(std::string::npos);
+
+//==========================================================================
+// Class:			MessageTemplate
+// Function:		MessageTemplate
+//
+// Description:		Constructor for MessageTemplate class.  Parses the text
+//					into literal and field segments.  As with plain messages,
+//					the rendered text always ends with a newline.
+//
+// Input Arguments:
+//		text	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+MessageTemplate::MessageTemplate(const std::string &text)
+{
+	std::string literal;
+	size_t start(0);
+	size_t open;
+	while ((open = text.find('{', start)) != std::string::npos)
+	{
+		literal.append(text, start, open - start);
+		if (open + 1 < text.size() && text[open + 1] == '{')
+		{
+			literal.push_back('{');
+			start = open + 2;
+			continue;
+		}
+
+		const size_t close(text.find_first_of("{}\n", open + 1));
+		if (close == std::string::npos || text[close] != '}' || close == open + 1)
+		{
+			// Not a placeholder - keep the brace as written
+			literal.push_back('{');
+			start = open + 1;
+			continue;
+		}
+
+		AddLiteral(literal);
+		literal.clear();
+		AddField(text.substr(open + 1, close - open - 1));
+		start = close + 1;
+	}
+
+	literal.append(text, start, std::string::npos);
+	if (!text.empty() && text.back() != '\n')
+		literal.push_back('\n');
+	AddLiteral(literal);
+}
+
+//==========================================================================
+// Class:			MessageTemplate
+// Function:		AddLiteral
+//
+// Description:		Adds a literal text segment.
+//
+// Input Arguments:
+//		text	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void MessageTemplate::AddLiteral(const std::string &text)
+{
+	if (!text.empty())
+		segments.push_back(Segment{ text, npos });
+}
+
+//==========================================================================
+// Class:			MessageTemplate
+// Function:		AddField
+//
+// Description:		Adds a field segment.  Fields which appear more than once
+//					share an index.
+//
+// Input Arguments:
+//		name	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void MessageTemplate::AddField(const std::string &name)
+{
+	size_t index(GetFieldIndex(name));
+	if (index == npos)
+	{
+		index = fieldNames.size();
+		fieldNames.push_back(name);
+	}
+
+	segments.push_back(Segment{ std::string(), index });
+}
+
+//==========================================================================
+// Class:			MessageTemplate
+// Function:		GetFieldIndex
+//
+// Description:		Returns the index of the named field.
+//
+// Input Arguments:
+//		name	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		size_t, npos if the template has no such field
+//
+//==========================================================================
+size_t MessageTemplate::GetFieldIndex(const std::string &name) const
+{
+	const auto it(std::find(fieldNames.begin(), fieldNames.end(), name));
+	if (it == fieldNames.end())
+		return npos;
+	return static_cast<size_t>(it - fieldNames.begin());
+}
+
+//==========================================================================
+// Class:			MessageTemplate
+// Function:		MakeValues
+//
+// Description:		Arranges the named values in field index order.
+//
+// Input Arguments:
+//		values	= const std::map<std::string, std::string>&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::vector<std::string>
+//
+//==========================================================================
+std::vector<std::string> MessageTemplate::MakeValues(const std::map<std::string, std::string> &values) const
+{
+	std::vector<std::string> ordered(fieldNames.size());
+	for (size_t i = 0; i < fieldNames.size(); ++i)
+	{
+		const auto it(values.find(fieldNames[i]));
+		if (it != values.end())
+			ordered[i] = it->second;
+	}
+
+	return ordered;
+}
+
+//==========================================================================
+// Class:			MessageTemplate::Source
+// Function:		Source
+//
+// Description:		Constructor for Source class.
+//
+// Input Arguments:
+//		messageTemplate	= std::shared_ptr<const MessageTemplate>
+//		values			= std::vector<std::string>, ordered by field index
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+MessageTemplate::Source::Source(std::shared_ptr<const MessageTemplate> messageTemplate,
+	std::vector<std::string> values) : messageTemplate(std::move(messageTemplate)), values(std::move(values))
+{
+	assert(this->messageTemplate);
+	for (size_t i = 0; i < this->messageTemplate->segments.size(); ++i)
+		size += GetSegmentText(i).size();
+}
+
+//==========================================================================
+// Class:			MessageTemplate::Source
+// Function:		AddCanonicalSize
+//
+// Description:		Counts the rendered size with canonical line endings,
+//					directly from the segments.
+//
+// Input Arguments:
+//		size	= PayloadReader::CanonicalSize&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true
+//
+//==========================================================================
+bool MessageTemplate::Source::AddCanonicalSize(PayloadReader::CanonicalSize &size)
+{
+	for (size_t i = 0; i < messageTemplate->segments.size(); ++i)
+		size.Add(GetSegmentText(i));
+	return true;
+}
+
+//==========================================================================
+// Class:			MessageTemplate::Source
+// Function:		GetSegmentText
+//
+// Description:		Returns the text for the specified segment (the literal
+//					text or the field's value).
+//
+// Input Arguments:
+//		i	= const size_t&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		const std::string&
+//
+//==========================================================================
+const std::string& MessageTemplate::Source::GetSegmentText(const size_t &i) const
+{
+	static const std::string empty;
+	const Segment &s(messageTemplate->segments[i]);
+	if (s.field == npos)
+		return s.text;
+	else if (s.field < values.size())
+		return values[s.field];
+	return empty;
+}
+
+//==========================================================================
+// Class:			MessageTemplate::Source
+// Function:		Read
+//
+// Description:		Copies the next portion of the rendered text to the buffer.
+//
+// Input Arguments:
+//		size	= const size_t&
+//
+// Output Arguments:
+//		buffer	= char*
+//
+// Return Value:
+//		size_t, number of bytes written to buffer
+//
+//==========================================================================
+size_t MessageTemplate::Source::Read(char *buffer, const size_t &size)
+{
+	size_t totalRead(0);
+	while (totalRead < size && segment < messageTemplate->segments.size())
+	{
+		const std::string &text(GetSegmentText(segment));
+		const size_t length(std::min(size - totalRead, text.size() - position));
+		memcpy(buffer + totalRead, text.data() + position, length);
+		totalRead += length;
+		position += length;
+
+		if (position == text.size())
+		{
+			++segment;
+			position = 0;
+		}
+	}
+
+	return totalRead;
+}
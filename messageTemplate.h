@@ -0,0 +1,70 @@
+// File:  messageTemplate.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Message text containing {field} placeholders, parsed once and then
+//        rendered for each recipient directly into the payload.
+
+#ifndef MESSAGE_TEMPLATE_H_
+#define MESSAGE_TEMPLATE_H_
+
+// Local headers
+#include "payloadReader.h"
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+// Placeholders are written as {name}.  Use {{ for a literal '{'.  Values are
+// inserted verbatim, so for HTML messages they must already be escaped.
+class MessageTemplate
+{
+public:
+	explicit MessageTemplate(const std::string &text);
+
+	const std::vector<std::string>& GetFieldNames() const { return fieldNames; }
+	size_t GetFieldIndex(const std::string &name) const;// Returns npos if not found
+
+	// Arranges values by field index (as required by Source); fields without a value are left empty
+	std::vector<std::string> MakeValues(const std::map<std::string, std::string> &values) const;
+
+	class Source : public PayloadReader::Source
+	{
+	public:
+		// values are ordered by field index
+		Source(std::shared_ptr<const MessageTemplate> messageTemplate, std::vector<std::string> values);
+
+		size_t Read(char *buffer, const size_t &size) override;
+		bool Rewind() override { segment = 0; position = 0; return true; }
+		size_t GetSize() override { return size; }
+		bool AddCanonicalSize(PayloadReader::CanonicalSize &size) override;
+
+	private:
+		const std::shared_ptr<const MessageTemplate> messageTemplate;
+		const std::vector<std::string> values;
+		size_t size = 0;
+
+		size_t segment = 0;
+		size_t position = 0;
+
+		const std::string& GetSegmentText(const size_t &i) const;
+	};
+
+	static const size_t npos;
+
+private:
+	struct Segment
+	{
+		std::string text;// Literal text (if field == npos)
+		size_t field;
+	};
+
+	std::vector<Segment> segments;
+	std::vector<std::string> fieldNames;
+
+	void AddLiteral(const std::string &text);
+	void AddField(const std::string &name);
+};
+
+#endif// MESSAGE_TEMPLATE_H_
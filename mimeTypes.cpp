@@ -0,0 +1,134 @@
+// File:  mimeTypes.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Lookup of MIME content types from file extensions.
+
+// Local headers
+#include "mimeTypes.h"
+
+// Standard C++ headers
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace
+{
+	struct Entry
+	{
+		const char *extension;
+		const char *type;
+	};
+
+	// Must remain sorted by extension (lower case) for binary search
+	const Entry table[] =
+	{
+		{ "7z", "application/x-7z-compressed" },
+		{ "avi", "video/x-msvideo" },
+		{ "bmp", "image/bmp" },
+		{ "csv", "text/csv" },
+		{ "doc", "application/msword" },
+		{ "docx", "application/vnd.openxmlformats-officedocument.wordprocessingml.document" },
+		{ "gif", "image/gif" },
+		{ "gz", "application/gzip" },
+		{ "htm", "text/html" },
+		{ "html", "text/html" },
+		{ "ico", "image/vnd.microsoft.icon" },
+		{ "ics", "text/calendar" },
+		{ "jpeg", "image/jpeg" },
+		{ "jpg", "image/jpeg" },
+		{ "json", "application/json" },
+		{ "log", "text/plain" },
+		{ "md", "text/markdown" },
+		{ "mov", "video/quicktime" },
+		{ "mp3", "audio/mpeg" },
+		{ "mp4", "video/mp4" },
+		{ "odp", "application/vnd.oasis.opendocument.presentation" },
+		{ "ods", "application/vnd.oasis.opendocument.spreadsheet" },
+		{ "odt", "application/vnd.oasis.opendocument.text" },
+		{ "pdf", "application/pdf" },
+		{ "png", "image/png" },
+		{ "ppt", "application/vnd.ms-powerpoint" },
+		{ "pptx", "application/vnd.openxmlformats-officedocument.presentationml.presentation" },
+		{ "rtf", "application/rtf" },
+		{ "svg", "image/svg+xml" },
+		{ "tar", "application/x-tar" },
+		{ "tif", "image/tiff" },
+		{ "tiff", "image/tiff" },
+		{ "txt", "text/plain" },
+		{ "wav", "audio/wav" },
+		{ "webp", "image/webp" },
+		{ "xls", "application/vnd.ms-excel" },
+		{ "xlsx", "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet" },
+		{ "xml", "application/xml" },
+		{ "zip", "application/zip" }
+	};
+
+	const char* const defaultType("application/octet-stream");
+}
+
+//==========================================================================
+// Class:			MIMETypes
+// Function:		FromExtension
+//
+// Description:		Returns the content type for the specified extension.
+//
+// Input Arguments:
+//		extension	= const std::string& (without the '.', any case)
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		const char*
+//
+//==========================================================================
+const char* MIMETypes::FromExtension(const std::string &extension)
+{
+	// No known extension is longer than this, so there is no need to allocate
+	char lower[8];
+	if (extension.empty() || extension.size() >= sizeof(lower))
+		return defaultType;
+
+	std::transform(extension.begin(), extension.end(), lower, [](unsigned char c)
+	{
+		return static_cast<char>(std::tolower(c));
+	});
+	lower[extension.size()] = '\0';
+
+	const Entry *end(table + sizeof(table) / sizeof(table[0]));
+	const Entry *match(std::lower_bound(table, end, lower, [](const Entry &e, const char *key)
+	{
+		return strcmp(e.extension, key) < 0;
+	}));
+
+	if (match == end || strcmp(match->extension, lower) != 0)
+		return defaultType;
+	return match->type;
+}
+
+//==========================================================================
+// Class:			MIMETypes
+// Function:		FromFileName
+//
+// Description:		Returns the content type for the specified file, based on
+//					its extension.
+//
+// Input Arguments:
+//		fileName	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		const char*
+//
+//==========================================================================
+const char* MIMETypes::FromFileName(const std::string &fileName)
+{
+	const size_t dot(fileName.find_last_of('.'));
+	const size_t slash(fileName.find_last_of("/\\"));
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+		return defaultType;
+
+	return FromExtension(fileName.substr(dot + 1));
+}
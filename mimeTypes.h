@@ -0,0 +1,19 @@
+// File:  mimeTypes.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Lookup of MIME content types from file extensions.
+
+#ifndef MIME_TYPES_H_
+#define MIME_TYPES_H_
+
+// Standard C++ headers
+#include <string>
+
+namespace MIMETypes
+{
+	// Returns "application/octet-stream" for unknown extensions
+	const char* FromExtension(const std::string &extension);
+	const char* FromFileName(const std::string &fileName);
+}
+
+#endif// MIME_TYPES_H_
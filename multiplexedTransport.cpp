@@ -0,0 +1,255 @@
+// File:  multiplexedTransport.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Shared HTTP/2 transport which runs requests from any thread as
+//        streams over one connection per origin.
+
+// Local headers
+#include "multiplexedTransport.h"
+
+//==========================================================================
+// Class:			MultiplexedTransport
+// Function:		Static member initialization
+//
+// Description:		Static member initialization for MultiplexedTransport
+//					class.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+std::mutex MultiplexedTransport::singletonMutex;
+std::shared_ptr<MultiplexedTransport> MultiplexedTransport::singleton;
+
+//==========================================================================
+// Class:			MultiplexedTransport
+// Function:		MultiplexedTransport
+//
+// Description:		Constructor for MultiplexedTransport class.  Starts the
+//					worker thread.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+MultiplexedTransport::MultiplexedTransport() : multi(curl_multi_init())
+{
+	curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+	worker = std::thread(&MultiplexedTransport::WorkerThreadEntry, this);
+}
+
+//==========================================================================
+// Class:			MultiplexedTransport
+// Function:		~MultiplexedTransport
+//
+// Description:		Destructor for MultiplexedTransport class.  Waits for
+//					transfers in progress to complete.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+MultiplexedTransport::~MultiplexedTransport()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+
+	curl_multi_wakeup(multi);
+	if (worker.joinable())
+		worker.join();
+
+	curl_multi_cleanup(multi);
+}
+
+//==========================================================================
+// Class:			MultiplexedTransport
+// Function:		Enable (static)
+//
+// Description:		Creates the shared transport, if it does not exist.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void MultiplexedTransport::Enable()
+{
+	std::lock_guard<std::mutex> lock(singletonMutex);
+	if (!singleton)
+		singleton = std::shared_ptr<MultiplexedTransport>(new MultiplexedTransport);
+}
+
+//==========================================================================
+// Class:			MultiplexedTransport
+// Function:		Disable (static)
+//
+// Description:		Releases the shared transport.  New requests use their
+//					own connections; the transport is destroyed once the
+//					requests in progress complete.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void MultiplexedTransport::Disable()
+{
+	std::shared_ptr<MultiplexedTransport> transport;
+	{
+		std::lock_guard<std::mutex> lock(singletonMutex);
+		transport.swap(singleton);
+	}
+}
+
+//==========================================================================
+// Class:			MultiplexedTransport
+// Function:		Get (static)
+//
+// Description:		Access method for the shared transport.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::shared_ptr<MultiplexedTransport>, nullptr if not enabled
+//
+//==========================================================================
+std::shared_ptr<MultiplexedTransport> MultiplexedTransport::Get()
+{
+	std::lock_guard<std::mutex> lock(singletonMutex);
+	return singleton;
+}
+
+//==========================================================================
+// Class:			MultiplexedTransport
+// Function:		Perform
+//
+// Description:		Runs the transfer on the worker thread and waits for it
+//					to complete.
+//
+// Input Arguments:
+//		curl	= CURL*, configured but not yet performed
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		CURLcode, result of the transfer
+//
+//==========================================================================
+CURLcode MultiplexedTransport::Perform(CURL *curl)
+{
+	curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_2TLS));
+	curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);// Wait for an existing connection rather than opening another
+	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);// Signals are not safe with multiple threads
+
+	Transfer transfer;
+	std::unique_lock<std::mutex> lock(mutex);
+	transfers[curl] = &transfer;
+	incoming.push_back(curl);
+	curl_multi_wakeup(multi);
+
+	transferComplete.wait(lock, [&transfer]()
+	{
+		return transfer.done;
+	});
+
+	return transfer.result;
+}
+
+//==========================================================================
+// Class:			MultiplexedTransport
+// Function:		WorkerThreadEntry
+//
+// Description:		Entry point for the worker thread.  Drives all transfers
+//					until stopped.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void MultiplexedTransport::WorkerThreadEntry()
+{
+	while (true)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (auto& curl : incoming)
+				curl_multi_add_handle(multi, curl);
+			incoming.clear();
+
+			if (stopping && transfers.empty())
+				break;
+		}
+
+		int running;
+		curl_multi_perform(multi, &running);
+
+		bool anyComplete(false);
+		int messagesInQueue;
+		CURLMsg *message;
+		while ((message = curl_multi_info_read(multi, &messagesInQueue)))
+		{
+			if (message->msg != CURLMSG_DONE)
+				continue;
+
+			CURL *curl(message->easy_handle);
+			const CURLcode result(message->data.result);
+			curl_multi_remove_handle(multi, curl);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			auto it(transfers.find(curl));
+			if (it != transfers.end())
+			{
+				it->second->result = result;
+				it->second->done = true;
+				transfers.erase(it);
+				anyComplete = true;
+			}
+		}
+
+		if (anyComplete)
+			transferComplete.notify_all();
+
+		curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+	}
+}
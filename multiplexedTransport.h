@@ -0,0 +1,68 @@
+// File:  multiplexedTransport.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Shared HTTP/2 transport which runs requests from any thread as
+//        streams over one connection per origin.
+
+#ifndef MULTIPLEXED_TRANSPORT_H_
+#define MULTIPLEXED_TRANSPORT_H_
+
+// cURL headers
+#include <curl/curl.h>
+
+// Standard C++ headers
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <map>
+
+// When enabled, JSONInterface requests (token refreshes, REST sends, API
+// GETs) are handed to a single background thread which owns a cURL multi
+// handle.  Connections (and TLS sessions) are kept open between requests,
+// and concurrent requests to the same origin wait to be multiplexed onto the
+// existing connection instead of opening new ones.  Servers which do not
+// support HTTP/2 fall back to HTTP/1.1 with connection reuse.
+class MultiplexedTransport
+{
+public:
+	~MultiplexedTransport();
+
+	MultiplexedTransport(const MultiplexedTransport&) = delete;
+	MultiplexedTransport& operator=(const MultiplexedTransport&) = delete;
+
+	static void Enable();
+	static void Disable();// Waits for transfers in progress to complete
+
+	// Returns nullptr unless enabled
+	static std::shared_ptr<MultiplexedTransport> Get();
+
+	// Blocks until the configured easy handle completes; the caller retains ownership of the handle
+	CURLcode Perform(CURL *curl);
+
+private:
+	MultiplexedTransport();
+
+	static std::mutex singletonMutex;
+	static std::shared_ptr<MultiplexedTransport> singleton;
+
+	struct Transfer
+	{
+		CURLcode result = CURLE_OK;
+		bool done = false;
+	};
+
+	CURLM *multi;
+	std::thread worker;
+
+	std::mutex mutex;
+	std::condition_variable transferComplete;
+	std::vector<CURL*> incoming;
+	std::map<CURL*, Transfer*> transfers;
+	bool stopping = false;
+
+	void WorkerThreadEntry();
+};
+
+#endif// MULTIPLEXED_TRANSPORT_H_
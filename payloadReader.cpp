@@ -0,0 +1,593 @@
+// File:  payloadReader.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Supplies a message payload to cURL from a sequence of sources, so
+//        large parts (i.e. attachments) can be streamed instead of held in memory.
+
+// Local headers
+#include "payloadReader.h"
+#include "base64.h"
+
+// Standard C++ headers
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+//==========================================================================
+// Class:			PayloadReader::Base64FileSource
+// Function:		Constant definitions
+//
+// Description:		Constant definitions for the Base64FileSource class.  The
+//					file is read this many encoded lines (57 bytes each) at a
+//					time, which sets the memory required by the source
+//					(about 57 kB in and 78 kB out).
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+const size_t PayloadReader::Base64FileSource::chunkLines(1024);
+
+//==========================================================================
+// Class:			PayloadReader
+// Function:		Clear
+//
+// Description:		Removes all sources.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void PayloadReader::Clear()
+{
+	sources.clear();
+	current = 0;
+}
+
+//==========================================================================
+// Class:			PayloadReader
+// Function:		Append
+//
+// Description:		Adds a source to the end of the payload.
+//
+// Input Arguments:
+//		source	= std::unique_ptr<Source>
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void PayloadReader::Append(std::unique_ptr<Source> source)
+{
+	sources.push_back(std::move(source));
+}
+
+//==========================================================================
+// Class:			PayloadReader
+// Function:		AppendText
+//
+// Description:		Adds the specified text to the end of the payload.
+//
+// Input Arguments:
+//		text	= std::string
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void PayloadReader::AppendText(std::string text)
+{
+	if (!text.empty())
+		Append(std::unique_ptr<Source>(new TextSource(std::move(text))));
+}
+
+//==========================================================================
+// Class:			PayloadReader
+// Function:		Read
+//
+// Description:		Fills the buffer with the next portion of the payload.
+//					The buffer is always filled completely unless the end of
+//					the payload is reached.
+//
+// Input Arguments:
+//		size	= const size_t&
+//
+// Output Arguments:
+//		buffer	= char*
+//
+// Return Value:
+//		size_t, number of bytes written to buffer
+//
+//==========================================================================
+size_t PayloadReader::Read(char *buffer, const size_t &size)
+{
+	size_t totalRead(0);
+	while (totalRead < size && current < sources.size())
+	{
+		const size_t bytesRead(sources[current]->Read(buffer + totalRead, size - totalRead));
+		if (bytesRead == 0)
+			++current;
+		totalRead += bytesRead;
+	}
+
+	return totalRead;
+}
+
+//==========================================================================
+// Class:			PayloadReader
+// Function:		Rewind
+//
+// Description:		Returns to the start of the payload.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool PayloadReader::Rewind()
+{
+	current = 0;
+	for (auto& s : sources)
+	{
+		if (!s->Rewind())
+			return false;
+	}
+
+	return true;
+}
+
+//==========================================================================
+// Class:			PayloadReader
+// Function:		GetSize
+//
+// Description:		Returns the total size of the payload.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		size_t
+//
+//==========================================================================
+size_t PayloadReader::GetSize()
+{
+	size_t size(0);
+	for (const auto& s : sources)
+		size += s->GetSize();
+	return size;
+}
+
+//==========================================================================
+// Class:			PayloadReader
+// Function:		GetCanonicalSize
+//
+// Description:		Finds the size of the payload once line endings are made
+//					canonical (as it is sent over SMTP).  Sources which hold
+//					their text, or which know how many lines they produce,
+//					are not read.  The payload must be rewound afterwards.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		size	= size_t&
+//
+// Return Value:
+//		bool, true for success, false if a source could not be rewound
+//
+//==========================================================================
+bool PayloadReader::GetCanonicalSize(size_t &size)
+{
+	CanonicalSize canonical;
+	for (const auto& s : sources)
+	{
+		if (!s->AddCanonicalSize(canonical))
+			return false;
+	}
+
+	size = canonical.Get();
+	return true;
+}
+
+//==========================================================================
+// Class:			PayloadReader
+// Function:		ReadAll
+//
+// Description:		Reads the (remainder of the) payload into a single string.
+//					This defeats the purpose of streaming, so it should only
+//					be used where the complete payload is required.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string
+//
+//==========================================================================
+std::string PayloadReader::ReadAll()
+{
+	std::string all(GetSize(), '\0');
+	all.resize(Read(&all[0], all.size()));
+	return all;
+}
+
+//==========================================================================
+// Class:			PayloadReader
+// Function:		CURLReadCallback (static)
+//
+// Description:		Read callback for cURL uploads.
+//
+// Input Arguments:
+//		size	= size_t
+//		nmemb	= size_t
+//		userp	= void*, must be pointer to PayloadReader
+//
+// Output Arguments:
+//		buffer	= char*
+//
+// Return Value:
+//		size_t, number of bytes written to buffer
+//
+//==========================================================================
+size_t PayloadReader::CURLReadCallback(char *buffer, size_t size, size_t nmemb, void *userp)
+{
+	return static_cast<PayloadReader*>(userp)->Read(buffer, size * nmemb);
+}
+
+//==========================================================================
+// Class:			PayloadReader
+// Function:		CURLSeekCallback (static)
+//
+// Description:		Seek callback for cURL uploads.  Only rewinding to the
+//					start of the payload is supported.
+//
+// Input Arguments:
+//		userp	= void*, must be pointer to PayloadReader
+//		offset	= curl_off_t
+//		origin	= int
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		int
+//
+//==========================================================================
+int PayloadReader::CURLSeekCallback(void *userp, curl_off_t offset, int origin)
+{
+	if (offset != 0 || origin != SEEK_SET)
+		return CURL_SEEKFUNC_CANTSEEK;
+
+	if (!static_cast<PayloadReader*>(userp)->Rewind())
+		return CURL_SEEKFUNC_FAIL;
+	return CURL_SEEKFUNC_OK;
+}
+
+//==========================================================================
+// Class:			PayloadReader::TextSource
+// Function:		Read
+//
+// Description:		Copies the next portion of the text to the buffer.
+//
+// Input Arguments:
+//		size	= const size_t&
+//
+// Output Arguments:
+//		buffer	= char*
+//
+// Return Value:
+//		size_t, number of bytes written to buffer
+//
+//==========================================================================
+size_t PayloadReader::TextSource::Read(char *buffer, const size_t &size)
+{
+	const size_t length(std::min(size, text.size() - position));
+	memcpy(buffer, text.data() + position, length);
+	position += length;
+	return length;
+}
+
+//==========================================================================
+// Class:			PayloadReader::SharedTextSource
+// Function:		Read
+//
+// Description:		Copies the next portion of the text to the buffer.
+//
+// Input Arguments:
+//		size	= const size_t&
+//
+// Output Arguments:
+//		buffer	= char*
+//
+// Return Value:
+//		size_t, number of bytes written to buffer
+//
+//==========================================================================
+size_t PayloadReader::SharedTextSource::Read(char *buffer, const size_t &size)
+{
+	const size_t length(std::min(size, text->size() - position));
+	memcpy(buffer, text->data() + position, length);
+	position += length;
+	return length;
+}
+
+//==========================================================================
+// Class:			PayloadReader::Base64FileSource
+// Function:		Base64FileSource
+//
+// Description:		Constructor for Base64FileSource class.  If the file
+//					cannot be opened, the source is empty.
+//
+// Input Arguments:
+//		fileName	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+PayloadReader::Base64FileSource::Base64FileSource(const std::string &fileName)
+	: file(fileName.c_str(), std::ios::binary)
+{
+	if (!file.is_open() || !file.good())
+		return;
+
+	file.seekg(0, std::ios::end);
+	const size_t fileSize(static_cast<size_t>(file.tellg()));
+	encodedSize = Base64::GetEncodedSize(fileSize, true);
+	lineCount = encodedSize - Base64::GetEncodedSize(fileSize, false);
+	file.seekg(0, std::ios::beg);
+}
+
+//==========================================================================
+// Class:			PayloadReader::Base64FileSource
+// Function:		Read
+//
+// Description:		Copies the next portion of the encoded file to the buffer,
+//					reading and encoding another chunk of the file as needed.
+//
+// Input Arguments:
+//		size	= const size_t&
+//
+// Output Arguments:
+//		buffer	= char*
+//
+// Return Value:
+//		size_t, number of bytes written to buffer
+//
+//==========================================================================
+size_t PayloadReader::Base64FileSource::Read(char *buffer, const size_t &size)
+{
+	if (outPosition == outLength && !Refill())
+		return 0;
+
+	const size_t length(std::min(size, outLength - outPosition));
+	memcpy(buffer, outBuffer.data() + outPosition, length);
+	outPosition += length;
+	return length;
+}
+
+//==========================================================================
+// Class:			PayloadReader::Base64FileSource
+// Function:		Rewind
+//
+// Description:		Returns to the start of the file.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool PayloadReader::Base64FileSource::Rewind()
+{
+	outPosition = 0;
+	outLength = 0;
+	if (!file.is_open())
+		return true;
+
+	file.clear();
+	file.seekg(0, std::ios::beg);
+	return file.good();
+}
+
+//==========================================================================
+// Class:			PayloadReader::Base64FileSource
+// Function:		Refill
+//
+// Description:		Reads and encodes the next chunk of the file.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true if more data is available, false at end of file
+//
+//==========================================================================
+bool PayloadReader::Base64FileSource::Refill()
+{
+	if (!file.is_open() || !file.good())
+		return false;
+
+	if (inBuffer.empty())
+	{
+		inBuffer.resize(chunkLines * Base64::BytesPerLine);
+		outBuffer.resize(Base64::GetEncodedSize(inBuffer.size(), true));
+	}
+
+	file.read(inBuffer.data(), inBuffer.size());
+	const size_t bytesRead(static_cast<size_t>(file.gcount()));
+	if (bytesRead == 0)
+		return false;
+
+	outPosition = 0;
+	outLength = Base64::Encode(inBuffer.data(), bytesRead, outBuffer.data(), true);
+	return true;
+}
+
+//==========================================================================
+// Class:			PayloadReader::CanonicalSize
+// Function:		Add
+//
+// Description:		Counts the next piece of text.  Line ends are found with
+//					memchr(), as when the text is sent.
+//
+// Input Arguments:
+//		text	= const char*
+//		length	= const size_t&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void PayloadReader::CanonicalSize::Add(const char *text, const size_t &length)
+{
+	if (length == 0)
+		return;
+
+	size += length;
+	size_t i(0);
+	while (i < length)
+	{
+		const char *newLine(static_cast<const char*>(memchr(text + i, '\n', length - i)));
+		if (!newLine)
+			break;
+
+		const size_t end(static_cast<size_t>(newLine - text));
+		if (!(end > 0 ? text[end - 1] == '\r' : previousCR))
+			++size;
+		i = end + 1;
+	}
+
+	previousCR = text[length - 1] == '\r';
+	atLineStart = text[length - 1] == '\n';
+}
+
+//==========================================================================
+// Class:			PayloadReader::CanonicalSize
+// Function:		AddWithoutCR
+//
+// Description:		Counts the next piece of text, which contains no "\r"
+//					(so every line feed is bare), without scanning it.
+//
+// Input Arguments:
+//		length		= const size_t&
+//		lineFeeds	= const size_t&
+//		first		= const char&, first character of the text
+//		last		= const char&, last character of the text
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void PayloadReader::CanonicalSize::AddWithoutCR(const size_t &length, const size_t &lineFeeds,
+	const char &first, const char &last)
+{
+	if (length == 0)
+		return;
+
+	size += length + lineFeeds;
+	if (previousCR && first == '\n')
+		--size;
+
+	previousCR = false;
+	atLineStart = last == '\n';
+}
+
+//==========================================================================
+// Class:			PayloadReader::Source
+// Function:		AddCanonicalSize
+//
+// Description:		Counts the source's size with canonical line endings by
+//					reading it, then rewinds it.
+//
+// Input Arguments:
+//		size	= CanonicalSize&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false if the source could not be rewound
+//
+//==========================================================================
+bool PayloadReader::Source::AddCanonicalSize(CanonicalSize &size)
+{
+	if (!Rewind())
+		return false;
+
+	char buffer[16384];
+	size_t length;
+	while ((length = Read(buffer, sizeof(buffer))) > 0)
+		size.Add(buffer, length);
+
+	return Rewind();
+}
+
+//==========================================================================
+// Class:			PayloadReader::Base64FileSource
+// Function:		AddCanonicalSize
+//
+// Description:		Counts the source's size with canonical line endings.
+//					Every encoded line ends with a bare "\n", so the file is
+//					not read.
+//
+// Input Arguments:
+//		size	= CanonicalSize&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true
+//
+//==========================================================================
+bool PayloadReader::Base64FileSource::AddCanonicalSize(CanonicalSize &size)
+{
+	size.AddWithoutCR(encodedSize, lineCount, 'A', '\n');
+	return true;
+}
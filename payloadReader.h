@@ -0,0 +1,135 @@
+// File:  payloadReader.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Supplies a message payload to cURL from a sequence of sources, so
+//        large parts (i.e. attachments) can be streamed instead of held in memory.
+
+#ifndef PAYLOAD_READER_H_
+#define PAYLOAD_READER_H_
+
+// cURL headers
+#include <curl/curl.h>
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+
+class PayloadReader
+{
+public:
+	// Size of text once bare "\n" line endings are written as "\r\n" and a
+	// final line ending is added (as for SMTP), counted over any number of
+	// pieces
+	class CanonicalSize
+	{
+	public:
+		void Add(const char *text, const size_t &length);
+		void Add(const std::string &text) { Add(text.data(), text.size()); }
+
+		// For text known to contain no "\r" (i.e. generated by an encoder)
+		void AddWithoutCR(const size_t &length, const size_t &lineFeeds, const char &first, const char &last);
+
+		size_t Get() const { return atLineStart ? size : size + 2; }
+
+	private:
+		size_t size = 0;
+		bool previousCR = false;
+		bool atLineStart = true;
+	};
+
+	class Source
+	{
+	public:
+		virtual ~Source() = default;
+
+		// Returns number of bytes written to buffer; zero indicates the end of the source
+		virtual size_t Read(char *buffer, const size_t &size) = 0;
+		virtual bool Rewind() = 0;
+		virtual size_t GetSize() = 0;// May read the source (i.e. to encode it) if the size is not known
+
+		// By default the source is read (and rewound) to count its line
+		// endings; returns false if it can not be rewound
+		virtual bool AddCanonicalSize(CanonicalSize &size);
+	};
+
+	class TextSource : public Source
+	{
+	public:
+		explicit TextSource(std::string text) : text(std::move(text)) {}
+
+		size_t Read(char *buffer, const size_t &size) override;
+		bool Rewind() override { position = 0; return true; }
+		size_t GetSize() override { return text.size(); }
+		bool AddCanonicalSize(CanonicalSize &size) override { size.Add(text); return true; }
+
+	private:
+		const std::string text;
+		size_t position = 0;
+	};
+
+	// For text shared between many payloads (i.e. a pre-rendered message body)
+	class SharedTextSource : public Source
+	{
+	public:
+		explicit SharedTextSource(std::shared_ptr<const std::string> text) : text(std::move(text)) {}
+
+		size_t Read(char *buffer, const size_t &size) override;
+		bool Rewind() override { position = 0; return true; }
+		size_t GetSize() override { return text->size(); }
+		bool AddCanonicalSize(CanonicalSize &size) override { size.Add(*text); return true; }
+
+		const std::shared_ptr<const std::string>& GetText() const { return text; }
+
+	private:
+		const std::shared_ptr<const std::string> text;
+		size_t position = 0;
+	};
+
+	class Base64FileSource : public Source
+	{
+	public:
+		explicit Base64FileSource(const std::string &fileName);
+
+		size_t Read(char *buffer, const size_t &size) override;
+		bool Rewind() override;
+		size_t GetSize() override { return encodedSize; }
+		bool AddCanonicalSize(CanonicalSize &size) override;
+
+	private:
+		static const size_t chunkLines;
+
+		std::ifstream file;
+		size_t encodedSize = 0;
+		size_t lineCount = 0;
+
+		std::vector<char> inBuffer;
+		std::vector<char> outBuffer;
+		size_t outPosition = 0;
+		size_t outLength = 0;
+
+		bool Refill();
+	};
+
+	void Clear();
+	void Append(std::unique_ptr<Source> source);
+	void AppendText(std::string text);
+
+	size_t Read(char *buffer, const size_t &size);
+	bool Rewind();
+	size_t GetSize();
+	bool GetCanonicalSize(size_t &size);// Without reading the sources which can count their line endings
+	std::string ReadAll();
+
+	static size_t CURLReadCallback(char *buffer, size_t size, size_t nmemb, void *userp);
+	static int CURLSeekCallback(void *userp, curl_off_t offset, int origin);
+
+private:
+	friend class DKIMSigner;
+
+	std::vector<std::unique_ptr<Source>> sources;
+	size_t current = 0;
+};
+
+#endif// PAYLOAD_READER_H_
@@ -0,0 +1,685 @@
+// File:  quotedPrintable.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Streaming quoted-printable encoding (RFC 2045) for message bodies.
+//        Runs of plain ASCII are found with SSE2 and copied in bulk.
+
+// Local headers
+#include "quotedPrintable.h"
+
+// Standard C++ headers
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define QUOTED_PRINTABLE_SSE2
+#endif
+
+#ifdef QUOTED_PRINTABLE_SSE2
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// Leaves room for the '=' of a soft line break
+	const size_t maxContentLength(QuotedPrintable::MaxLineLength - 1);
+
+	bool IsWhitespace(const char &c)
+	{
+		return c == ' ' || c == '\t';
+	}
+
+	// Characters which may be written as-is (whitespace only when it does
+	// not end a line)
+	bool IsLiteral(const char &c)
+	{
+		return (c >= ' ' && c <= '~' && c != '=') || c == '\t';
+	}
+
+	// Returns the length of the run of literal characters at the start of
+	// the input.  SSE2 is part of the x86-64 baseline, so no run-time
+	// selection is required.
+	size_t ScanLiteral(const char *input, const size_t &inputSize)
+	{
+		size_t i(0);
+#ifdef QUOTED_PRINTABLE_SSE2
+		const __m128i belowSpace(_mm_set1_epi8(' ' - 1));
+		const __m128i del(_mm_set1_epi8(0x7f));
+		const __m128i equals(_mm_set1_epi8('='));
+		const __m128i tab(_mm_set1_epi8('\t'));
+		for (; i + 16 <= inputSize; i += 16)
+		{
+			// Signed comparisons also exclude bytes >= 0x80 (negative)
+			const __m128i c(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)));
+			const __m128i printable(_mm_and_si128(_mm_cmpgt_epi8(c, belowSpace), _mm_cmplt_epi8(c, del)));
+			const __m128i literal(_mm_or_si128(_mm_andnot_si128(_mm_cmpeq_epi8(c, equals), printable),
+				_mm_cmpeq_epi8(c, tab)));
+			const unsigned int mask(static_cast<unsigned int>(_mm_movemask_epi8(literal)));
+			if (mask != 0xffff)
+			{
+#ifdef _MSC_VER
+				unsigned long first;
+				_BitScanForward(&first, ~mask);
+				return i + first;
+#else
+				return i + __builtin_ctz(~mask);
+#endif
+			}
+		}
+#endif
+		while (i < inputSize && IsLiteral(input[i]))
+			++i;
+
+		return i;
+	}
+}
+
+//==========================================================================
+// Class:			QuotedPrintable::Encoder
+// Function:		Encode
+//
+// Description:		Encodes the next piece of the input.
+//
+// Input Arguments:
+//		input		= const char*
+//		inputSize	= const size_t&
+//
+// Output Arguments:
+//		output		= std::string&, encoded text is appended
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void QuotedPrintable::Encoder::Encode(const char *input, const size_t &inputSize, std::string &output)
+{
+	output.reserve(output.size() + inputSize + inputSize / 16);
+
+	size_t i(0);
+	while (i < inputSize)
+	{
+		if (!pendingCR && pendingWhitespace == '\0')
+		{
+			// Whitespace within the run is followed by a literal character,
+			// so only whitespace at the end of the run needs special handling
+			size_t run(ScanLiteral(input + i, inputSize - i));
+			if (run > 0 && IsWhitespace(input[i + run - 1]))
+				--run;
+
+			if (run > 0)
+			{
+				Append(input + i, run, output);
+				i += run;
+				continue;
+			}
+		}
+
+		Put(input[i++], output);
+	}
+}
+
+//==========================================================================
+// Class:			QuotedPrintable::Encoder
+// Function:		Finish
+//
+// Description:		Writes any characters held back at the end of the input.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		output	= std::string&
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void QuotedPrintable::Encoder::Finish(std::string &output)
+{
+	if (pendingCR)
+	{
+		FlushWhitespace(false, output);
+		AppendEncoded('\r', output);
+		pendingCR = false;
+	}
+
+	FlushWhitespace(true, output);
+}
+
+//==========================================================================
+// Class:			QuotedPrintable::Encoder
+// Function:		Reset
+//
+// Description:		Prepares to encode new input.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void QuotedPrintable::Encoder::Reset()
+{
+	lineLength = 0;
+	pendingWhitespace = '\0';
+	pendingCR = false;
+}
+
+//==========================================================================
+// Class:			QuotedPrintable::Encoder
+// Function:		Put
+//
+// Description:		Encodes a single character.
+//
+// Input Arguments:
+//		c	= const char&
+//
+// Output Arguments:
+//		output	= std::string&
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void QuotedPrintable::Encoder::Put(const char &c, std::string &output)
+{
+	if (pendingCR)
+	{
+		pendingCR = false;
+		if (c != '\n')
+		{
+			FlushWhitespace(false, output);
+			AppendEncoded('\r', output);
+		}
+	}
+
+	if (c == '\r')
+		pendingCR = true;
+	else if (c == '\n')
+	{
+		FlushWhitespace(true, output);
+		output.push_back('\n');
+		lineLength = 0;
+	}
+	else
+	{
+		FlushWhitespace(false, output);
+		if (IsWhitespace(c))
+			pendingWhitespace = c;
+		else if (IsLiteral(c))
+			Append(&c, 1, output);
+		else
+			AppendEncoded(c, output);
+	}
+}
+
+//==========================================================================
+// Class:			QuotedPrintable::Encoder
+// Function:		Append
+//
+// Description:		Appends literal text, inserting soft line breaks as
+//					required.
+//
+// Input Arguments:
+//		text	= const char*
+//		length	= const size_t&
+//
+// Output Arguments:
+//		output	= std::string&
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void QuotedPrintable::Encoder::Append(const char *text, const size_t &length, std::string &output)
+{
+	size_t i(0);
+	while (i < length)
+	{
+		if (lineLength >= maxContentLength)
+		{
+			output.append("=\n");
+			lineLength = 0;
+		}
+
+		const size_t count(std::min(length - i, maxContentLength - lineLength));
+		output.append(text + i, count);
+		lineLength += count;
+		i += count;
+	}
+}
+
+//==========================================================================
+// Class:			QuotedPrintable::Encoder
+// Function:		AppendEncoded
+//
+// Description:		Appends the "=XX" form of the character.
+//
+// Input Arguments:
+//		c	= const char&
+//
+// Output Arguments:
+//		output	= std::string&
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void QuotedPrintable::Encoder::AppendEncoded(const char &c, std::string &output)
+{
+	static const char hexDigits[] = "0123456789ABCDEF";
+
+	if (lineLength + 3 > maxContentLength)
+	{
+		output.append("=\n");
+		lineLength = 0;
+	}
+
+	const unsigned char u(static_cast<unsigned char>(c));
+	const char encoded[] = { '=', hexDigits[u >> 4], hexDigits[u & 0x0f] };
+	output.append(encoded, 3);
+	lineLength += 3;
+}
+
+//==========================================================================
+// Class:			QuotedPrintable::Encoder
+// Function:		FlushWhitespace
+//
+// Description:		Writes the held whitespace character, if any.  At the end
+//					of a line it must be encoded so it is not stripped in
+//					transit.
+//
+// Input Arguments:
+//		endOfLine	= const bool&
+//
+// Output Arguments:
+//		output		= std::string&
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void QuotedPrintable::Encoder::FlushWhitespace(const bool &endOfLine, std::string &output)
+{
+	if (pendingWhitespace == '\0')
+		return;
+
+	if (endOfLine)
+		AppendEncoded(pendingWhitespace, output);
+	else
+		Append(&pendingWhitespace, 1, output);
+
+	pendingWhitespace = '\0';
+}
+
+//==========================================================================
+// Class:			QuotedPrintable
+// Function:		Encode
+//
+// Description:		Encodes the complete text.
+//
+// Input Arguments:
+//		s	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string
+//
+//==========================================================================
+std::string QuotedPrintable::Encode(const std::string &s)
+{
+	std::string encoded;
+	Encoder encoder;
+	encoder.Encode(s, encoded);
+	encoder.Finish(encoded);
+	return encoded;
+}
+
+//==========================================================================
+// Class:			QuotedPrintable::Source
+// Function:		Static member initialization
+//
+// Description:		Static member initialization for QuotedPrintable::Source
+//					class.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+const size_t QuotedPrintable::Source::chunkSize(16384);
+
+//==========================================================================
+// Class:			QuotedPrintable::Source
+// Function:		Source
+//
+// Description:		Constructor for QuotedPrintable::Source class.  The
+//					encoded size is not determined until it is needed.
+//
+// Input Arguments:
+//		input	= std::unique_ptr<PayloadReader::Source>
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+QuotedPrintable::Source::Source(std::unique_ptr<PayloadReader::Source> input) : input(std::move(input))
+{
+}
+
+//==========================================================================
+// Class:			QuotedPrintable::Source
+// Function:		GetSize
+//
+// Description:		Returns the encoded size.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		size_t
+//
+//==========================================================================
+size_t QuotedPrintable::Source::GetSize()
+{
+	FindEncodedCounts();
+	return encoded.size;
+}
+
+//==========================================================================
+// Class:			QuotedPrintable::Source
+// Function:		AddCanonicalSize
+//
+// Description:		Counts the encoded size with canonical line endings.  The
+//					input is read at most once, as for GetSize().
+//
+// Input Arguments:
+//		size	= PayloadReader::CanonicalSize&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true
+//
+//==========================================================================
+bool QuotedPrintable::Source::AddCanonicalSize(PayloadReader::CanonicalSize &size)
+{
+	FindEncodedCounts();
+	size.AddWithoutCR(encoded.size, encoded.lineFeeds, encoded.first, encoded.last);
+	return true;
+}
+
+//==========================================================================
+// Class:			QuotedPrintable::Source
+// Function:		FindEncodedCounts
+//
+// Description:		Determines the encoded size and line count.  If the input
+//					has been read to the end, they were counted as it was
+//					encoded.  If none of it has been read, the whole input is
+//					encoded now and kept for Read(), so the input is still
+//					only read once.  Otherwise (rarely) the input is encoded
+//					separately to count it.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void QuotedPrintable::Source::FindEncodedCounts()
+{
+	if (encodedKnown)
+		return;
+
+	if (inputConsumed == 0 && !inputComplete)
+	{
+		while (Refill())
+		{
+			// Encoded text accumulates in outBuffer
+		}
+	}
+	else
+	{
+		encoded = Measure();
+		encodedKnown = true;
+	}
+}
+
+//==========================================================================
+// Class:			QuotedPrintable::Source
+// Function:		Read
+//
+// Description:		Copies the next portion of the encoded text to the buffer.
+//
+// Input Arguments:
+//		size	= const size_t&
+//
+// Output Arguments:
+//		buffer	= char*
+//
+// Return Value:
+//		size_t, number of bytes written to buffer
+//
+//==========================================================================
+size_t QuotedPrintable::Source::Read(char *buffer, const size_t &size)
+{
+	size_t totalRead(0);
+	while (totalRead < size)
+	{
+		if (outPosition == outBuffer.size())
+		{
+			outBuffer.clear();
+			outPosition = 0;
+			if (!Refill() && outBuffer.empty())
+				break;
+		}
+
+		const size_t length(std::min(size - totalRead, outBuffer.size() - outPosition));
+		memcpy(buffer + totalRead, outBuffer.data() + outPosition, length);
+		totalRead += length;
+		outPosition += length;
+	}
+
+	return totalRead;
+}
+
+//==========================================================================
+// Class:			QuotedPrintable::Source
+// Function:		Rewind
+//
+// Description:		Returns to the start of the input.  If everything encoded
+//					since the last rewind is still buffered and none of it
+//					has been read (i.e. after GetSize()), it is kept instead.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool QuotedPrintable::Source::Rewind()
+{
+	if (outPosition == 0 && produced.size == outBuffer.size())
+		return true;
+
+	encoder.Reset();
+	inputComplete = false;
+	inputConsumed = 0;
+	produced = Counts();
+	outBuffer.clear();
+	outPosition = 0;
+	return input->Rewind();
+}
+
+//==========================================================================
+// Class:			QuotedPrintable::Source
+// Function:		Refill
+//
+// Description:		Reads and encodes the next chunk of the input, appending
+//					to outBuffer.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, false once the input is exhausted (after the encoder is
+//		finished), true otherwise
+//
+//==========================================================================
+bool QuotedPrintable::Source::Refill()
+{
+	if (inputComplete)
+		return false;
+
+	inBuffer.resize(chunkSize);
+	const size_t length(input->Read(&inBuffer[0], chunkSize));
+	const size_t startSize(outBuffer.size());
+	if (length == 0)
+	{
+		encoder.Finish(outBuffer);
+		produced.Add(outBuffer.data() + startSize, outBuffer.size() - startSize);
+		inputComplete = true;
+		if (!encodedKnown)
+		{
+			encoded = produced;
+			encodedKnown = true;
+		}
+		return false;
+	}
+
+	inputConsumed += length;
+	encoder.Encode(inBuffer.data(), length, outBuffer);
+	produced.Add(outBuffer.data() + startSize, outBuffer.size() - startSize);
+	return true;
+}
+
+//==========================================================================
+// Class:			QuotedPrintable::Source
+// Function:		Measure
+//
+// Description:		Encodes the whole input with a separate encoder to count
+//					the encoded size and lines, then returns the input to its
+//					previous position.  Only used when the size is requested
+//					partway through reading.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		Counts
+//
+//==========================================================================
+QuotedPrintable::Source::Counts QuotedPrintable::Source::Measure()
+{
+	Encoder counter;
+	std::string in(chunkSize, '\0'), out;
+	Counts counts;
+	size_t length;
+
+	input->Rewind();
+	while ((length = input->Read(&in[0], chunkSize)) > 0)
+	{
+		counter.Encode(in.data(), length, out);
+		counts.Add(out.data(), out.size());
+		out.clear();
+	}
+
+	counter.Finish(out);
+	counts.Add(out.data(), out.size());
+
+	input->Rewind();
+	size_t skipped(0);
+	while (skipped < inputConsumed && (length = input->Read(&in[0], std::min(chunkSize, inputConsumed - skipped))) > 0)
+		skipped += length;
+
+	return counts;
+}
+
+//==========================================================================
+// Class:			QuotedPrintable::Source::Counts
+// Function:		Add
+//
+// Description:		Counts the next piece of encoded text.
+//
+// Input Arguments:
+//		text	= const char*
+//		length	= const size_t&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void QuotedPrintable::Source::Counts::Add(const char *text, const size_t &length)
+{
+	if (length == 0)
+		return;
+
+	if (size == 0)
+		first = text[0];
+	last = text[length - 1];
+	size += length;
+	lineFeeds += static_cast<size_t>(std::count(text, text + length, '\n'));
+}
+
+//==========================================================================
+// Class:			QuotedPrintable
+// Function:		GetKernelName
+//
+// Description:		Returns the name of the scan kernel in use.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		const char*
+//
+//==========================================================================
+const char* QuotedPrintable::GetKernelName()
+{
+#ifdef QUOTED_PRINTABLE_SSE2
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,96 @@
+// File:  quotedPrintable.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Streaming quoted-printable encoding (RFC 2045) for message bodies.
+//        Runs of plain ASCII are found with SSE2 and copied in bulk.
+
+#ifndef QUOTED_PRINTABLE_H_
+#define QUOTED_PRINTABLE_H_
+
+// Local headers
+#include "payloadReader.h"
+
+// Standard C++ headers
+#include <string>
+#include <memory>
+#include <cstddef>
+
+namespace QuotedPrintable
+{
+	// Encoded lines (excluding the line break) never exceed this length;
+	// longer lines are split with soft line breaks ("=\n").
+	const size_t MaxLineLength(76);
+
+	// Input may be passed in pieces of any size; whitespace at the end of a
+	// piece is held until it is known whether it ends a line.  Line breaks
+	// ("\n" or "\r\n") are written as "\n".
+	class Encoder
+	{
+	public:
+		void Encode(const char *input, const size_t &inputSize, std::string &output);
+		void Encode(const std::string &input, std::string &output) { Encode(input.data(), input.size(), output); }
+		void Finish(std::string &output);// Must be called after the last piece
+		void Reset();
+
+	private:
+		size_t lineLength = 0;
+		char pendingWhitespace = '\0';
+		bool pendingCR = false;
+
+		void Put(const char &c, std::string &output);
+		void Append(const char *text, const size_t &length, std::string &output);
+		void AppendEncoded(const char &c, std::string &output);
+		void FlushWhitespace(const bool &endOfLine, std::string &output);
+	};
+
+	std::string Encode(const std::string &s);
+
+	// Encodes another source as it is read (i.e. a rendered MessageTemplate)
+	class Source : public PayloadReader::Source
+	{
+	public:
+		explicit Source(std::unique_ptr<PayloadReader::Source> input);
+
+		size_t Read(char *buffer, const size_t &size) override;
+		bool Rewind() override;
+		size_t GetSize() override;// Encodes the input to count its size unless it has already been read
+		bool AddCanonicalSize(PayloadReader::CanonicalSize &size) override;
+
+	private:
+		static const size_t chunkSize;
+
+		// Encoded text contains no "\r", so its canonical size follows from
+		// these
+		struct Counts
+		{
+			size_t size = 0;
+			size_t lineFeeds = 0;
+			char first = '\0';
+			char last = '\0';
+
+			void Add(const char *text, const size_t &length);
+		};
+
+		const std::unique_ptr<PayloadReader::Source> input;
+		Encoder encoder;
+		bool inputComplete = false;
+		size_t inputConsumed = 0;// Since the last rewind
+		Counts produced;// Since the last rewind
+
+		Counts encoded;// Known once the input has been encoded to the end
+		bool encodedKnown = false;
+
+		std::string inBuffer;
+		std::string outBuffer;
+		size_t outPosition = 0;
+
+		bool Refill();
+		void FindEncodedCounts();
+		Counts Measure();
+	};
+
+	// Name of the scan kernel in use ("sse2" or "scalar")
+	const char* GetKernelName();
+}
+
+#endif// QUOTED_PRINTABLE_H_
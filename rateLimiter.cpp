@@ -0,0 +1,343 @@
+// File:  rateLimiter.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Limits the rate at which messages are sent from an account, so
+//        provider quotas are not exceeded.
+
+// Local headers
+#include "rateLimiter.h"
+
+// Standard C++ headers
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+//==========================================================================
+// Class:			RateLimiter
+// Function:		RateLimiter
+//
+// Description:		Constructor for RateLimiter class.
+//
+// Input Arguments:
+//		limits	= const Limits&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+RateLimiter::RateLimiter(const Limits &limits) : limits(limits),
+	messages(limits.messagesPerSecond, limits.messageBurst),
+	recipients(limits.recipientsPerSecond, limits.recipientBurst),
+	dailyMessages(limits.dailyMessageLimit), dailyRecipients(limits.dailyRecipientLimit), blockedUntil(0)
+{
+}
+
+//==========================================================================
+// Class:			RateLimiter
+// Function:		TryAcquire
+//
+// Description:		Checks whether a message with the specified number of
+//					recipients may be sent now.  If so, it is counted against
+//					the limits.
+//
+// Input Arguments:
+//		recipientCount	= const unsigned int&
+//
+// Output Arguments:
+//		waitMs			= unsigned int&, time to wait before trying again
+//						  (if not permitted)
+//
+// Return Value:
+//		bool, true if the message may be sent, false otherwise
+//
+//==========================================================================
+bool RateLimiter::TryAcquire(const unsigned int &recipientCount, unsigned int &waitMs)
+{
+	const int64_t now(GetTime());
+	int64_t wait(blockedUntil.load(std::memory_order_relaxed) - now);
+	if (wait <= 0 && (wait = dailyMessages.TryTake(1)) == 0)
+	{
+		if ((wait = dailyRecipients.TryTake(recipientCount)) == 0)
+		{
+			if ((wait = messages.TryTake(1, now)) == 0)
+			{
+				if ((wait = recipients.TryTake(recipientCount, now)) == 0)
+					return true;
+				messages.Return(1);
+			}
+			dailyRecipients.Return(recipientCount);
+		}
+		dailyMessages.Return(1);
+	}
+
+	const int64_t nsPerMs(1000000);
+	waitMs = static_cast<unsigned int>(std::min<int64_t>((wait + nsPerMs - 1) / nsPerMs, 0xFFFFFFFF));
+	return false;
+}
+
+//==========================================================================
+// Class:			RateLimiter
+// Function:		Acquire
+//
+// Description:		Waits until a message with the specified number of
+//					recipients may be sent, and counts it against the limits.
+//					Gives up if the wait would exceed maxWaitMs (i.e. when the
+//					daily budget is used up).
+//
+// Input Arguments:
+//		recipientCount	= const unsigned int&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true if the message may be sent, false otherwise
+//
+//==========================================================================
+bool RateLimiter::Acquire(const unsigned int &recipientCount)
+{
+	const auto deadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(limits.maxWaitMs));
+	unsigned int waitMs;
+	while (!TryAcquire(recipientCount, waitMs))
+	{
+		const auto retryTime(std::chrono::steady_clock::now() + std::chrono::milliseconds(waitMs));
+		if (retryTime > deadline)
+			return false;
+		std::this_thread::sleep_until(retryTime);
+	}
+
+	return true;
+}
+
+//==========================================================================
+// Class:			RateLimiter
+// Function:		Release
+//
+// Description:		Returns the message and recipients counted by a
+//					successful TryAcquire() or Acquire(), so the limits only
+//					count messages which were sent.
+//
+// Input Arguments:
+//		recipientCount	= const unsigned int&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void RateLimiter::Release(const unsigned int &recipientCount)
+{
+	recipients.Return(recipientCount);
+	messages.Return(1);
+	dailyRecipients.Return(recipientCount);
+	dailyMessages.Return(1);
+}
+
+//==========================================================================
+// Class:			RateLimiter
+// Function:		ReportThrottled
+//
+// Description:		Blocks all sending for the backoff period.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void RateLimiter::ReportThrottled()
+{
+	const int64_t until(GetTime() + static_cast<int64_t>(limits.throttleBackoffMs) * 1000000);
+	int64_t current(blockedUntil.load(std::memory_order_relaxed));
+	while (current < until && !blockedUntil.compare_exchange_weak(current, until, std::memory_order_relaxed))
+	{
+	}
+}
+
+//==========================================================================
+// Class:			RateLimiter
+// Function:		GetTime (static)
+//
+// Description:		Returns a monotonic time stamp.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		int64_t [ns]
+//
+//==========================================================================
+int64_t RateLimiter::GetTime()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//==========================================================================
+// Class:			RateLimiter::Bucket
+// Function:		Bucket
+//
+// Description:		Constructor for Bucket class.  The bucket is implemented
+//					as a generic cell rate algorithm, which needs only a
+//					single atomic time stamp.
+//
+// Input Arguments:
+//		rate	= const double& [tokens/sec], zero for unlimited
+//		burst	= const double&, number of tokens the bucket holds
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+RateLimiter::Bucket::Bucket(const double &rate, const double &burst)
+	: interval(rate > 0.0 ? static_cast<int64_t>(1.0e9 / rate) : 0),
+	tolerance(static_cast<int64_t>(std::max(burst, 1.0) * interval)), theoreticalArrival(0)
+{
+}
+
+//==========================================================================
+// Class:			RateLimiter::Bucket
+// Function:		TryTake
+//
+// Description:		Takes the specified number of tokens if they are
+//					available.  Requests larger than the bucket are permitted
+//					once the bucket is full.
+//
+// Input Arguments:
+//		count	= const unsigned int&
+//		now		= const int64_t& [ns]
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		int64_t, zero if the tokens were taken, otherwise the time until they
+//		will be available [ns]
+//
+//==========================================================================
+int64_t RateLimiter::Bucket::TryTake(const unsigned int &count, const int64_t &now)
+{
+	if (interval == 0)
+		return 0;
+
+	const int64_t cost(count * interval);
+	int64_t arrival(theoreticalArrival.load(std::memory_order_relaxed));
+	while (true)
+	{
+		const int64_t newArrival(std::max(arrival, now) + cost);
+		const int64_t allowedAt(newArrival - std::max(tolerance, cost));
+		if (allowedAt > now)
+			return allowedAt - now;
+
+		if (theoreticalArrival.compare_exchange_weak(arrival, newArrival, std::memory_order_relaxed))
+			return 0;
+	}
+}
+
+//==========================================================================
+// Class:			RateLimiter::Bucket
+// Function:		Return
+//
+// Description:		Returns tokens which were taken but not used.
+//
+// Input Arguments:
+//		count	= const unsigned int&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void RateLimiter::Bucket::Return(const unsigned int &count)
+{
+	if (interval > 0)
+		theoreticalArrival.fetch_sub(count * interval, std::memory_order_relaxed);
+}
+
+//==========================================================================
+// Class:			RateLimiter::DailyBudget
+// Function:		TryTake
+//
+// Description:		Counts the specified number against today's budget, if
+//					it fits.
+//
+// Input Arguments:
+//		count	= const unsigned int&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		int64_t, zero if the count fit, otherwise the time until the budget
+//		is reset [ns]
+//
+//==========================================================================
+int64_t RateLimiter::DailyBudget::TryTake(const unsigned int &count)
+{
+	if (limit == 0)
+		return 0;
+
+	const int64_t secondsPerDay(86400);
+	const int64_t seconds(std::chrono::duration_cast<std::chrono::seconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count());
+	const uint64_t today(static_cast<uint64_t>(seconds / secondsPerDay));
+
+	uint64_t current(state.load(std::memory_order_relaxed));
+	while (true)
+	{
+		const uint64_t used((current >> 32) == today ? current & 0xFFFFFFFF : 0);
+		if (used + count > limit)
+			return (secondsPerDay - seconds % secondsPerDay) * 1000000000;
+
+		if (state.compare_exchange_weak(current, (today << 32) | (used + count), std::memory_order_relaxed))
+			return 0;
+	}
+}
+
+//==========================================================================
+// Class:			RateLimiter::DailyBudget
+// Function:		Return
+//
+// Description:		Returns a count which was taken but not used.
+//
+// Input Arguments:
+//		count	= const unsigned int&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void RateLimiter::DailyBudget::Return(const unsigned int &count)
+{
+	if (limit == 0)
+		return;
+
+	uint64_t current(state.load(std::memory_order_relaxed));
+	while (true)
+	{
+		const uint64_t used(current & 0xFFFFFFFF);
+		const uint64_t updated((current & ~static_cast<uint64_t>(0xFFFFFFFF)) | (used > count ? used - count : 0));
+		if (state.compare_exchange_weak(current, updated, std::memory_order_relaxed))
+			return;
+	}
+}
@@ -0,0 +1,86 @@
+// File:  rateLimiter.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Limits the rate at which messages are sent from an account, so
+//        provider quotas are not exceeded.
+
+#ifndef RATE_LIMITER_H_
+#define RATE_LIMITER_H_
+
+// Standard C++ headers
+#include <atomic>
+#include <cstdint>
+
+// Token buckets for messages and recipients per second plus budgets per
+// (UTC) day.  All methods are thread-safe and lock-free.  The daily counts
+// are not persisted, so they restart from zero with the process.
+class RateLimiter
+{
+public:
+	// Zero means unlimited
+	struct Limits
+	{
+		double messagesPerSecond = 0.0;
+		double messageBurst = 1.0;// Messages which may be sent at once after a quiet period
+		double recipientsPerSecond = 0.0;
+		double recipientBurst = 1.0;
+		unsigned int dailyMessageLimit = 0;
+		unsigned int dailyRecipientLimit = 0;
+
+		unsigned int maxWaitMs = 60000;// Longest Acquire() will block
+		unsigned int throttleBackoffMs = 30000;// Pause after the server reports throttling
+	};
+
+	explicit RateLimiter(const Limits &limits);
+
+	bool TryAcquire(const unsigned int &recipientCount, unsigned int &waitMs);
+	bool Acquire(const unsigned int &recipientCount);// Waits up to maxWaitMs
+
+	// Gives back what was acquired for a message which was not sent after all
+	// (i.e. rejected before anything reached the server)
+	void Release(const unsigned int &recipientCount);
+
+	// Stops all sending until the backoff period has passed (i.e. after SMTP 421/454 or HTTP 429)
+	void ReportThrottled();
+
+private:
+	const Limits limits;
+
+	class Bucket
+	{
+	public:
+		Bucket(const double &rate, const double &burst);
+
+		// Returns zero if the tokens were taken, otherwise the time until they are available
+		int64_t TryTake(const unsigned int &count, const int64_t &now);
+		void Return(const unsigned int &count);
+
+	private:
+		const int64_t interval;// [ns] per token
+		const int64_t tolerance;// [ns]
+		std::atomic<int64_t> theoreticalArrival;// [ns]
+	};
+
+	class DailyBudget
+	{
+	public:
+		explicit DailyBudget(const unsigned int &limit) : limit(limit), state(0) {}
+
+		int64_t TryTake(const unsigned int &count);
+		void Return(const unsigned int &count);
+
+	private:
+		const unsigned int limit;
+		std::atomic<uint64_t> state;// Day number in the upper 32 bits, count in the lower 32 bits
+	};
+
+	Bucket messages;
+	Bucket recipients;
+	DailyBudget dailyMessages;
+	DailyBudget dailyRecipients;
+	std::atomic<int64_t> blockedUntil;// [ns]
+
+	static int64_t GetTime();
+};
+
+#endif// RATE_LIMITER_H_
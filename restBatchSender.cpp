@@ -0,0 +1,449 @@
+// File:  restBatchSender.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Sends many messages through Google's REST API with one HTTP request
+//        per batch (multipart/mixed batch format).
+
+// Local headers
+#include "restBatchSender.h"
+#include "oAuth2Interface.h"
+#include "rateLimiter.h"
+#include "base64.h"
+#include "messageBuilder.h"
+#include "dkimSigner.h"
+#include "lineScanner.h"
+
+// Standard C++ headers
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+const size_t RESTBatchSender::maxRequestsPerBatch(100);
+
+//==========================================================================
+// Class:			RESTBatchSender
+// Function:		RESTBatchSender
+//
+// Description:		Constructor for RESTBatchSender class.
+//
+// Input Arguments:
+//		loginInfo	= const EmailSender::LoginInfo&, smtpUrl must be the URL
+//					  of the send method (the path is used within the batch)
+//		testMode	= const bool&
+//		outStream	= UString::OStream&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+RESTBatchSender::RESTBatchSender(const EmailSender::LoginInfo &loginInfo, const bool &testMode,
+	UString::OStream &outStream) : loginInfo(loginInfo), testMode(testMode), outStream(outStream),
+	batchURL("https://www.googleapis.com/batch/gmail/v1")
+{
+}
+
+//==========================================================================
+// Class:			RESTBatchSender
+// Function:		Send
+//
+// Description:		Sends the messages, up to maxRequestsPerBatch per HTTP
+//					request.
+//
+// Input Arguments:
+//		messages	= const std::vector<EmailSender::Message>&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::vector<SendResult>, one for each message
+//
+//==========================================================================
+std::vector<SendResult> RESTBatchSender::Send(const std::vector<EmailSender::Message> &messages)
+{
+	std::vector<SendResult> results(messages.size());
+	size_t first;
+	for (first = 0; first < messages.size(); first += maxRequestsPerBatch)
+		SendBatch(messages, first, std::min(maxRequestsPerBatch, messages.size() - first), results);
+
+	return results;
+}
+
+//==========================================================================
+// Class:			RESTBatchSender
+// Function:		SendBatch
+//
+// Description:		Sends the specified range of messages in a single batch
+//					request.  Messages which would exceed the account's
+//					sending limits are left out of the batch.
+//
+// Input Arguments:
+//		messages	= const std::vector<EmailSender::Message>&
+//		first		= const size_t&
+//		count		= const size_t&
+//
+// Output Arguments:
+//		results		= std::vector<SendResult>&, elements first through
+//					  first + count - 1 are assigned
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void RESTBatchSender::SendBatch(const std::vector<EmailSender::Message> &messages, const size_t &first,
+	const size_t &count, std::vector<SendResult> &results)
+{
+	size_t i, requestCount(0);
+	for (i = first; i < first + count; ++i)
+	{
+		if (loginInfo.rateLimiter && !loginInfo.rateLimiter->Acquire(static_cast<unsigned int>(messages[i].recipients.size())))
+			results[i] = SendResult::Deferred("Sending limit reached");
+		else
+			++requestCount;
+	}
+
+	if (requestCount == 0)
+	{
+		outStream << "Failed sending e-mail batch:  Sending limit reached" << std::endl;
+		return;
+	}
+
+	const std::string boundary(MessageBuilder::GenerateBoundryID());
+	const std::string request(BuildRequest(messages, first, count, results, boundary));
+
+	EmailSender::EmailPOSTer poster;
+	poster.SetVerboseOutput(testMode);
+
+	EmailSender::EmailPOSTer::AdditionalPostData postData;
+	postData.headerList = curl_slist_append(postData.headerList, (std::string("Authorization: Bearer ") + UString::ToNarrowString(OAuth2Interface::Get().GetAccessToken())).c_str());
+	postData.headerList = curl_slist_append(postData.headerList, ("Content-Type: multipart/mixed; boundary=" + boundary).c_str());
+
+	std::string response;
+	EmailSender::EmailPOSTer::TransferStatus status;
+	poster.POST(UString::ToStringType(batchURL), request, postData, response, &status);
+	curl_slist_free_all(postData.headerList);
+
+	SendResult batchResult(SendResult::Make(SendResult::Protocol::HTTP, static_cast<CURLcode>(status.curlCode),
+		status.responseCode, static_cast<unsigned int>(status.retryAfter * 1000)));
+
+	std::vector<SendResult> batchResults(results.begin() + first, results.begin() + first + count);
+	std::vector<std::string> bodies(count);
+	if (batchResult.success && !ParseResponse(response, batchResults, bodies))
+	{
+		batchResult.success = false;
+		batchResult.description = "Failed to parse batch response";
+	}
+
+	if (!batchResult.success || testMode)
+		outStream << "Response to batch POST:\n" << UString::ToStringType(response) << std::endl;
+
+	bool throttled(batchResult.responseCode == 429);
+	for (i = 0; i < count; ++i)
+	{
+		if (results[first + i].deferred)
+			continue;
+		else if (!batchResult.success)
+		{
+			results[first + i] = batchResult;
+			continue;
+		}
+
+		results[first + i] = batchResults[i];
+		if (batchResults[i].responseCode == 429)
+			throttled = true;
+
+		if (!batchResults[i].success && !testMode)
+			outStream << "Response to send request " << i + 1 << " in batch:\n" << UString::ToStringType(bodies[i]) << std::endl;
+	}
+
+	if (loginInfo.rateLimiter && throttled)
+		loginInfo.rateLimiter->ReportThrottled();
+}
+
+//==========================================================================
+// Class:			RESTBatchSender
+// Function:		BuildRequest
+//
+// Description:		Generates the body of the batch request.  Each part is
+//					identified by its position within the batch.
+//
+// Input Arguments:
+//		messages	= const std::vector<EmailSender::Message>&
+//		first		= const size_t&
+//		count		= const size_t&
+//		results		= const std::vector<SendResult>&, deferred messages are
+//					  skipped
+//		boundary	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string
+//
+//==========================================================================
+std::string RESTBatchSender::BuildRequest(const std::vector<EmailSender::Message> &messages, const size_t &first,
+	const size_t &count, const std::vector<SendResult> &results, const std::string &boundary)
+{
+	const std::string path(ExtractPath(loginInfo.smtpUrl));
+
+	std::string request;
+	size_t i;
+	for (i = 0; i < count; ++i)
+	{
+		if (results[first + i].deferred)
+			continue;
+
+		PayloadReader payload;
+		MessageBuilder::Build(messages[first + i], loginInfo.localEmail, payload, true);
+		if (loginInfo.dkimSigner && !loginInfo.dkimSigner->Sign(payload))
+			outStream << "Failed to add DKIM signature" << std::endl;
+
+		const std::string json("{\"raw\":\"" + Base64::Encode(payload.ReadAll(), false, Base64::Alphabet::URLSafe) + "\"}");
+
+		request.append("--" + boundary + "\r\n");
+		request.append("Content-Type: application/http\r\n");
+		request.append("Content-ID: <item" + std::to_string(i + 1) + ">\r\n");
+		request.append("\r\n");
+		request.append("POST " + path + "\r\n");
+		request.append("Content-Type: application/json\r\n");
+		request.append("Content-Length: " + std::to_string(json.size()) + "\r\n");
+		request.append("\r\n");
+		request.append(json + "\r\n");
+	}
+
+	request.append("--" + boundary + "--\r\n");
+	return request;
+}
+
+//==========================================================================
+// Class:			RESTBatchSender
+// Function:		ExtractPath (static)
+//
+// Description:		Returns the path (and query) portion of the URL.
+//
+// Input Arguments:
+//		url	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string
+//
+//==========================================================================
+std::string RESTBatchSender::ExtractPath(const std::string &url)
+{
+	const std::string::size_type schemeEnd(url.find("://"));
+	const std::string::size_type pathStart(url.find('/', schemeEnd == std::string::npos ? 0 : schemeEnd + 3));
+	if (pathStart == std::string::npos)
+		return "/";
+
+	return url.substr(pathStart);
+}
+
+//==========================================================================
+// Class:			RESTBatchSender
+// Function:		ParseResponse (static)
+//
+// Description:		Splits the multipart batch response into the responses to
+//					the individual send requests.  The boundary is taken from
+//					the first delimiter line of the response.  Parts are
+//					matched to requests by Content-ID, or by order if they have
+//					none.  Requests without a response are left as failures.
+//
+// Input Arguments:
+//		response	= const std::string&
+//		results		= std::vector<SendResult>&, sized to the number of messages
+//					  in the batch; deferred elements were left out of the
+//					  request and are not modified
+//
+// Output Arguments:
+//		results		= std::vector<SendResult>&
+//		bodies		= std::vector<std::string>&, sized like results
+//
+// Return Value:
+//		bool, true if the response could be parsed, false otherwise
+//
+//==========================================================================
+bool RESTBatchSender::ParseResponse(const std::string &response, std::vector<SendResult> &results,
+	std::vector<std::string> &bodies)
+{
+	for (auto& r : results)
+	{
+		if (r.deferred)
+			continue;
+
+		r = SendResult();
+		r.protocol = SendResult::Protocol::HTTP;
+		r.description = "No response to request in batch";
+	}
+
+	enum class State
+	{
+		Preamble,
+		PartHeaders,
+		StatusLine,
+		HTTPHeaders,
+		Body
+	};
+
+	State state(State::Preamble);
+	std::string delimiter;
+	size_t partCount(0), index(0), nextInOrder(0);
+	long statusCode(0);
+	unsigned int retryAfterMs(0);
+	std::string body;
+
+	auto finishPart([&]()
+	{
+		if (state == State::Preamble || index >= results.size() || results[index].deferred)
+			return;
+
+		results[index] = SendResult::Make(SendResult::Protocol::HTTP, CURLE_OK, statusCode, retryAfterMs);
+		if (!body.empty() && body.back() == '\n')
+			body.pop_back();
+		bodies[index] = std::move(body);
+	});
+
+	LineScanner scanner(response);
+	std::string_view line;
+	while (scanner.Next(line))
+	{
+		if (delimiter.empty() && line.size() > 2 && line.compare(0, 2, "--") == 0)
+			delimiter = std::string(line);
+
+		if (!delimiter.empty() && line.compare(0, delimiter.size(), delimiter) == 0)
+		{
+			finishPart();
+			if (line.compare(delimiter.size(), std::string::npos, "--") == 0)
+				return true;
+
+			// Deferred messages have no part in the request, so they are skipped when matching by order
+			while (nextInOrder < results.size() && results[nextInOrder].deferred)
+				++nextInOrder;
+
+			state = State::PartHeaders;
+			index = nextInOrder++;
+			++partCount;
+			statusCode = 0;
+			retryAfterMs = 0;
+			body.clear();
+			continue;
+		}
+
+		std::string value;
+		switch (state)
+		{
+		case State::Preamble:
+			break;
+
+		case State::PartHeaders:
+			if (line.empty())
+				state = State::StatusLine;
+			else if (ReadHeader(line, "Content-ID", value) && ReadItemIndex(value) > 0)
+				index = ReadItemIndex(value) - 1;
+			break;
+
+		case State::StatusLine:
+			if (line.compare(0, 5, "HTTP/") == 0)
+			{
+				const std::string_view::size_type space(line.find(' '));
+				if (space != std::string_view::npos)
+					statusCode = std::strtol(line.data() + space + 1, nullptr, 10);
+				state = State::HTTPHeaders;
+			}
+			break;
+
+		case State::HTTPHeaders:
+			if (line.empty())
+				state = State::Body;
+			else if (ReadHeader(line, "Retry-After", value))
+				retryAfterMs = static_cast<unsigned int>(std::strtoul(value.c_str(), nullptr, 10) * 1000);
+			break;
+
+		case State::Body:
+			body.append(line).append("\n");
+			break;
+		}
+	}
+
+	// Missing final delimiter; accept what was received
+	finishPart();
+	return partCount > 0;
+}
+
+//==========================================================================
+// Class:			RESTBatchSender
+// Function:		ReadHeader (static)
+//
+// Description:		Checks for the specified header field (case-insensitive)
+//					and reads its value.
+//
+// Input Arguments:
+//		line	= const std::string_view&
+//		name	= const std::string&
+//
+// Output Arguments:
+//		value	= std::string&
+//
+// Return Value:
+//		bool, true if the line contains the specified field
+//
+//==========================================================================
+bool RESTBatchSender::ReadHeader(const std::string_view &line, const std::string &name, std::string &value)
+{
+	if (line.size() <= name.size() || line[name.size()] != ':')
+		return false;
+
+	size_t i;
+	for (i = 0; i < name.size(); ++i)
+	{
+		if (std::tolower(static_cast<unsigned char>(line[i])) != std::tolower(static_cast<unsigned char>(name[i])))
+			return false;
+	}
+
+	const std::string_view::size_type start(line.find_first_not_of(" \t", name.size() + 1));
+	if (start == std::string_view::npos)
+		value.clear();
+	else
+		value = std::string(line.substr(start, line.find_last_not_of(" \t") - start + 1));
+
+	return true;
+}
+
+//==========================================================================
+// Class:			RESTBatchSender
+// Function:		ReadItemIndex (static)
+//
+// Description:		Reads the item number from a response Content-ID (i.e.
+//					"<response-item12>").
+//
+// Input Arguments:
+//		contentID	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		size_t, one-based item number, or zero if none was found
+//
+//==========================================================================
+size_t RESTBatchSender::ReadItemIndex(const std::string &contentID)
+{
+	const std::string::size_type end(contentID.find_last_of("0123456789"));
+	if (end == std::string::npos)
+		return 0;
+
+	std::string::size_type start(end);
+	while (start > 0 && std::isdigit(static_cast<unsigned char>(contentID[start - 1])))
+		--start;
+
+	if (contentID.compare(0, start, "<response-item") != 0 && contentID.compare(0, start, "response-item") != 0)
+		return 0;
+
+	return static_cast<size_t>(std::strtoul(contentID.c_str() + start, nullptr, 10));
+}
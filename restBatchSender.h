@@ -0,0 +1,54 @@
+// File:  restBatchSender.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Sends many messages through Google's REST API with one HTTP request
+//        per batch (multipart/mixed batch format).
+
+#ifndef REST_BATCH_SENDER_H_
+#define REST_BATCH_SENDER_H_
+
+// Local headers
+#include "emailSender.h"
+#include "sendResult.h"
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+#include <string_view>
+
+// Each message becomes one send request within the batch; the batch response
+// is split back into a result per message.  Batches only support the JSON
+// ("raw") form of the send request, so messages are base64-encoded.
+class RESTBatchSender
+{
+public:
+	RESTBatchSender(const EmailSender::LoginInfo &loginInfo, const bool &testMode,
+		UString::OStream &outStream = Cout);
+
+	static const size_t maxRequestsPerBatch;
+
+	// Defaults to "https://www.googleapis.com/batch/gmail/v1"
+	void SetBatchURL(const std::string &url) { batchURL = url; }
+
+	// Messages are split into as many batches as required; results are in the same order as messages
+	std::vector<SendResult> Send(const std::vector<EmailSender::Message> &messages);
+
+private:
+	const EmailSender::LoginInfo loginInfo;
+	const bool testMode;
+	UString::OStream &outStream;
+	std::string batchURL;
+
+	void SendBatch(const std::vector<EmailSender::Message> &messages, const size_t &first,
+		const size_t &count, std::vector<SendResult> &results);
+	std::string BuildRequest(const std::vector<EmailSender::Message> &messages, const size_t &first,
+		const size_t &count, const std::vector<SendResult> &results, const std::string &boundary);
+
+	static std::string ExtractPath(const std::string &url);
+	static bool ParseResponse(const std::string &response, std::vector<SendResult> &results,
+		std::vector<std::string> &bodies);
+	static bool ReadHeader(const std::string_view &line, const std::string &name, std::string &value);
+	static size_t ReadItemIndex(const std::string &contentID);
+};
+
+#endif// REST_BATCH_SENDER_H_
@@ -0,0 +1,69 @@
+// File:  retryPolicy.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Decides whether (and when) a failed send should be attempted again.
+
+// Local headers
+#include "retryPolicy.h"
+
+// Standard C++ headers
+#include <random>
+#include <algorithm>
+#include <cassert>
+
+//==========================================================================
+// Class:			RetryPolicy
+// Function:		RetryPolicy
+//
+// Description:		Constructor for RetryPolicy class.
+//
+// Input Arguments:
+//		maxAttempts	= const unsigned int&, including the first attempt
+//		baseDelayMs	= const unsigned int&
+//		maxDelayMs	= const unsigned int&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+RetryPolicy::RetryPolicy(const unsigned int &maxAttempts, const unsigned int &baseDelayMs,
+	const unsigned int &maxDelayMs) : maxAttempts(maxAttempts), baseDelayMs(baseDelayMs), maxDelayMs(maxDelayMs)
+{
+	assert(baseDelayMs <= maxDelayMs);
+}
+
+//==========================================================================
+// Class:			RetryPolicy
+// Function:		ShouldRetry
+//
+// Description:		Determines whether the message should be sent again, and
+//					if so, how long to wait first.
+//
+// Input Arguments:
+//		result		= const SendResult&
+//		attempts	= const unsigned int&, number of attempts made so far
+//		delayMs		= unsigned int&, previous delay (zero if this was the
+//					  first attempt)
+//
+// Output Arguments:
+//		delayMs		= unsigned int&, delay before the next attempt
+//
+// Return Value:
+//		bool, true if the message should be sent again, false otherwise
+//
+//==========================================================================
+bool RetryPolicy::ShouldRetry(const SendResult &result, const unsigned int &attempts, unsigned int &delayMs) const
+{
+	if (attempts >= maxAttempts || !result.IsTransient())
+		return false;
+
+	thread_local std::mt19937 generator(std::random_device{}());
+	const unsigned int upper(static_cast<unsigned int>(std::min<unsigned long long>(
+		std::max(static_cast<unsigned long long>(delayMs) * 3, static_cast<unsigned long long>(baseDelayMs)), maxDelayMs)));
+	delayMs = std::uniform_int_distribution<unsigned int>(baseDelayMs, upper)(generator);
+	delayMs = std::max(delayMs, result.retryAfterMs);
+	return true;
+}
@@ -0,0 +1,31 @@
+// File:  retryPolicy.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Decides whether (and when) a failed send should be attempted again.
+
+#ifndef RETRY_POLICY_H_
+#define RETRY_POLICY_H_
+
+// Local headers
+#include "sendResult.h"
+
+// Only transient failures are retried.  Delays grow exponentially with
+// decorrelated jitter (each delay is chosen at random between the base
+// delay and three times the previous delay), and are never shorter than a
+// server's Retry-After.
+class RetryPolicy
+{
+public:
+	explicit RetryPolicy(const unsigned int &maxAttempts = 5, const unsigned int &baseDelayMs = 1000,
+		const unsigned int &maxDelayMs = 300000);
+
+	// attempts is the number of attempts made so far; delayMs is the previous delay (zero before the first retry)
+	bool ShouldRetry(const SendResult &result, const unsigned int &attempts, unsigned int &delayMs) const;
+
+private:
+	const unsigned int maxAttempts;
+	const unsigned int baseDelayMs;
+	const unsigned int maxDelayMs;
+};
+
+#endif// RETRY_POLICY_H_
@@ -0,0 +1,450 @@
+// File:  sendEngine.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Sends many messages concurrently from a single thread using the
+//        cURL multi interface.
+
+// Local headers
+#include "sendEngine.h"
+#include "smtpSession.h"
+#include "rateLimiter.h"
+
+// Standard C++ headers
+#include <cassert>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <climits>
+
+//==========================================================================
+// Class:			SendEngine
+// Function:		SendEngine
+//
+// Description:		Constructor for SendEngine class.
+//
+// Input Arguments:
+//		maxInFlight	= const unsigned int&, maximum number of simultaneous
+//					  transfers
+//		maxPerHost	= const unsigned int&, maximum number of simultaneous
+//					  transfers to any single host
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+SendEngine::SendEngine(const unsigned int &maxInFlight, const unsigned int &maxPerHost)
+	: maxInFlight(maxInFlight), maxPerHost(maxPerHost), multi(curl_multi_init())
+{
+	assert(maxInFlight > 0 && maxPerHost > 0);
+	assert(multi);
+
+	curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(maxInFlight));
+	curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(maxPerHost));
+}
+
+//==========================================================================
+// Class:			SendEngine
+// Function:		~SendEngine
+//
+// Description:		Destructor for SendEngine class.  Transfers which have not
+//					completed are abandoned without calling their callbacks.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+SendEngine::~SendEngine()
+{
+	for (auto& t : inFlight)
+	{
+		curl_multi_remove_handle(multi, t.first);
+		Cleanup(*t.second);
+	}
+
+	curl_multi_cleanup(multi);
+}
+
+//==========================================================================
+// Class:			SendEngine
+// Function:		AddSMTP
+//
+// Description:		Queues the message to be sent via SMTP.
+//
+// Input Arguments:
+//		sender		= std::unique_ptr<EmailSender>
+//		callback	= CompletionCallback
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SendEngine::AddSMTP(std::unique_ptr<EmailSender> sender, CompletionCallback callback)
+{
+	Add(std::move(sender), Protocol::SMTP, std::move(callback));
+}
+
+//==========================================================================
+// Class:			SendEngine
+// Function:		AddREST
+//
+// Description:		Queues the message to be sent via Google's REST API.
+//
+// Input Arguments:
+//		sender		= std::unique_ptr<EmailSender>
+//		callback	= CompletionCallback
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SendEngine::AddREST(std::unique_ptr<EmailSender> sender, CompletionCallback callback)
+{
+	Add(std::move(sender), Protocol::REST, std::move(callback));
+}
+
+//==========================================================================
+// Class:			SendEngine
+// Function:		Add
+//
+// Description:		Queues the message to be sent.
+//
+// Input Arguments:
+//		sender		= std::unique_ptr<EmailSender>
+//		protocol	= const Protocol&
+//		callback	= CompletionCallback
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SendEngine::Add(std::unique_ptr<EmailSender> sender, const Protocol &protocol, CompletionCallback callback)
+{
+	std::unique_ptr<Transfer> transfer(new Transfer);
+	transfer->host = ExtractHost(sender->loginInfo.smtpUrl);
+	transfer->sender = std::move(sender);
+	transfer->protocol = protocol;
+	transfer->callback = std::move(callback);
+	pending.push_back(std::move(transfer));
+}
+
+//==========================================================================
+// Class:			SendEngine
+// Function:		Run
+//
+// Description:		Processes transfers until all queued messages are complete.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SendEngine::Run()
+{
+	while (Perform())
+	{
+	}
+}
+
+//==========================================================================
+// Class:			SendEngine
+// Function:		Perform
+//
+// Description:		Starts queued transfers (up to the in-flight limits), makes
+//					progress on all active transfers, calls callbacks for any
+//					which finished, and then waits for socket activity (or
+//					until a transfer held back by a rate limiter may start).
+//
+// Input Arguments:
+//		timeoutMs	= const int&, maximum time to wait for activity
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true if work remains, false otherwise
+//
+//==========================================================================
+bool SendEngine::Perform(const int &timeoutMs)
+{
+	StartTransfers();
+
+	int running;
+	curl_multi_perform(multi, &running);
+
+	CURLMsg *message;
+	int messagesInQueue;
+	while ((message = curl_multi_info_read(multi, &messagesInQueue)))
+	{
+		if (message->msg == CURLMSG_DONE)
+			Finish(message->easy_handle, message->data.result);
+	}
+
+	const int waitMs(static_cast<int>(std::min<unsigned int>(StartTransfers(), std::max(timeoutMs, 0))));
+	if (inFlight.empty())
+	{
+		if (pending.empty())
+			return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(waitMs));
+		return true;
+	}
+
+	curl_multi_poll(multi, nullptr, 0, waitMs, nullptr);
+	return true;
+}
+
+//==========================================================================
+// Class:			SendEngine
+// Function:		StartTransfers
+//
+// Description:		Starts as many queued transfers as the limits allow.
+//					Transfers to hosts which are already at their limit, from
+//					accounts which are at their rate limit, or waiting to be
+//					retried are skipped, so one slow host or busy account
+//					does not hold up the others.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		unsigned int, time until a transfer which was held back may start [ms]
+//		(UINT_MAX if none were held back)
+//
+//==========================================================================
+unsigned int SendEngine::StartTransfers()
+{
+	unsigned int holdWaitMs(UINT_MAX);
+	const auto now(std::chrono::steady_clock::now());
+	auto it(pending.begin());
+	while (it != pending.end() && inFlight.size() < maxInFlight)
+	{
+		if (hostInFlightCount[(*it)->host] >= maxPerHost)
+		{
+			++it;
+			continue;
+		}
+
+		if ((*it)->notBefore > now)
+		{
+			const auto wait(std::chrono::duration_cast<std::chrono::milliseconds>((*it)->notBefore - now).count() + 1);
+			holdWaitMs = std::min(holdWaitMs, static_cast<unsigned int>(wait));
+			++it;
+			continue;
+		}
+
+		const EmailSender &sender(*(*it)->sender);
+		unsigned int waitMs;
+		if (sender.loginInfo.rateLimiter &&
+			!sender.loginInfo.rateLimiter->TryAcquire(static_cast<unsigned int>(sender.content.recipients.size()), waitMs))
+		{
+			holdWaitMs = std::min(holdWaitMs, waitMs);
+			++it;
+			continue;
+		}
+
+		std::unique_ptr<Transfer> transfer(std::move(*it));
+		it = pending.erase(it);
+
+		if (!Start(*transfer))
+		{
+			if (sender.loginInfo.rateLimiter)
+				sender.loginInfo.rateLimiter->Release(static_cast<unsigned int>(sender.content.recipients.size()));
+			Cleanup(*transfer);
+			if (transfer->callback)
+				transfer->callback(SendResult::Make(transfer->protocol == Protocol::SMTP ?
+					SendResult::Protocol::SMTP : SendResult::Protocol::HTTP, CURLE_FAILED_INIT, 0), std::string());
+			continue;
+		}
+
+		++hostInFlightCount[transfer->host];
+		CURL *curl(transfer->curl);
+		inFlight[curl] = std::move(transfer);
+		curl_multi_add_handle(multi, curl);
+	}
+
+	return holdWaitMs;
+}
+
+//==========================================================================
+// Class:			SendEngine
+// Function:		Start
+//
+// Description:		Creates and configures the easy handle for the transfer.
+//
+// Input Arguments:
+//		transfer	= Transfer&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool SendEngine::Start(Transfer &transfer)
+{
+	transfer.curl = curl_easy_init();
+	if (!transfer.curl)
+		return false;
+
+	EmailSender &sender(*transfer.sender);
+	if (transfer.protocol == Protocol::SMTP)
+	{
+		sender.PreparePayload();
+		SMTPSession::SetConnectionOptions(transfer.curl, sender.loginInfo, sender.testMode, sender.disableSignaling);
+		transfer.recipientList = SMTPSession::SetMessageOptions(transfer.curl, sender.loginInfo, sender.content.recipients,
+			&PayloadReader::CURLReadCallback, &PayloadReader::CURLSeekCallback, &sender.payload);
+		return true;
+	}
+
+	transfer.poster.SetVerboseOutput(sender.testMode);
+	std::string url;
+	sender.BuildRESTRequest(url, transfer.body, transfer.postData);
+	return transfer.poster.Prepare(transfer.curl, UString::ToStringType(url),
+		transfer.body, transfer.postData, transfer.response);
+}
+
+//==========================================================================
+// Class:			SendEngine
+// Function:		Finish
+//
+// Description:		Removes the completed transfer and either queues it to be
+//					retried or calls its callback.
+//
+// Input Arguments:
+//		curl	= CURL*
+//		result	= const CURLcode&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SendEngine::Finish(CURL *curl, const CURLcode &result)
+{
+	auto it(inFlight.find(curl));
+	assert(it != inFlight.end());
+
+	std::unique_ptr<Transfer> transfer(std::move(it->second));
+	inFlight.erase(it);
+	curl_multi_remove_handle(multi, curl);
+	--hostInFlightCount[transfer->host];
+
+	const SendResult sendResult(SendResult::FromCURL(curl, result, transfer->protocol == Protocol::SMTP ?
+		SendResult::Protocol::SMTP : SendResult::Protocol::HTTP));
+	const auto& rateLimiter(transfer->sender->loginInfo.rateLimiter);
+	if (rateLimiter && !sendResult.success &&
+		((transfer->protocol == Protocol::SMTP && SMTPSession::IsThrottled(curl)) ||
+		(transfer->protocol == Protocol::REST && sendResult.responseCode == 429)))
+		rateLimiter->ReportThrottled();
+
+	if (!sendResult.success)
+		transfer->sender->outStream << "Failed sending e-mail:  " << sendResult.description << std::endl;
+	if (transfer->protocol == Protocol::REST && (!sendResult.success || transfer->sender->testMode))
+		transfer->sender->outStream << "Response to send POST:\n" << UString::ToStringType(transfer->response) << std::endl;
+
+	Cleanup(*transfer);
+	++transfer->attempts;
+	if (!sendResult.success && retryPolicy &&
+		retryPolicy->ShouldRetry(sendResult, transfer->attempts, transfer->retryDelayMs))
+	{
+		transfer->notBefore = std::chrono::steady_clock::now() + std::chrono::milliseconds(transfer->retryDelayMs);
+		transfer->response.clear();
+		transfer->body.clear();
+		pending.push_back(std::move(transfer));
+		return;
+	}
+
+	if (transfer->callback)
+		transfer->callback(sendResult, transfer->response);
+}
+
+//==========================================================================
+// Class:			SendEngine
+// Function:		Cleanup (static)
+//
+// Description:		Frees the cURL resources associated with the transfer.
+//
+// Input Arguments:
+//		transfer	= Transfer&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SendEngine::Cleanup(Transfer &transfer)
+{
+	curl_slist_free_all(transfer.recipientList);
+	transfer.recipientList = nullptr;
+	curl_slist_free_all(transfer.postData.headerList);
+	transfer.postData.headerList = nullptr;
+
+	if (transfer.curl)
+		curl_easy_cleanup(transfer.curl);
+	transfer.curl = nullptr;
+}
+
+//==========================================================================
+// Class:			SendEngine
+// Function:		ExtractHost (static)
+//
+// Description:		Extracts the host name from the specified URL.
+//
+// Input Arguments:
+//		url	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string, empty if the URL could not be parsed
+//
+//==========================================================================
+std::string SendEngine::ExtractHost(const std::string &url)
+{
+	CURLU *handle(curl_url());
+	if (!handle)
+		return std::string();
+
+	std::string host;
+	char *part;
+	if (curl_url_set(handle, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK &&
+		curl_url_get(handle, CURLUPART_HOST, &part, 0) == CURLUE_OK)
+	{
+		host = part;
+		curl_free(part);
+	}
+
+	curl_url_cleanup(handle);
+	return host;
+}
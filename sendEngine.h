@@ -0,0 +1,96 @@
+// File:  sendEngine.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Sends many messages concurrently from a single thread using the
+//        cURL multi interface.
+
+#ifndef SEND_ENGINE_H_
+#define SEND_ENGINE_H_
+
+// Local headers
+#include "emailSender.h"
+#include "sendResult.h"
+#include "retryPolicy.h"
+
+// cURL headers
+#include <curl/curl.h>
+
+// Standard C++ headers
+#include <string>
+#include <memory>
+#include <functional>
+#include <deque>
+#include <map>
+#include <chrono>
+
+// Not thread-safe; all methods (including Add*()) must be called from the
+// thread which calls Perform()/Run().  Completion callbacks are also called
+// from that thread.  With a retry policy, transfers which fail transiently
+// are queued again with a start time after their retry delay.
+class SendEngine
+{
+public:
+	typedef std::function<void(const SendResult &result, const std::string &response)> CompletionCallback;
+
+	explicit SendEngine(const unsigned int &maxInFlight = 16, const unsigned int &maxPerHost = 4);
+	~SendEngine();
+
+	SendEngine(const SendEngine&) = delete;
+	SendEngine& operator=(const SendEngine&) = delete;
+
+	void AddSMTP(std::unique_ptr<EmailSender> sender, CompletionCallback callback = CompletionCallback());
+	void AddREST(std::unique_ptr<EmailSender> sender, CompletionCallback callback = CompletionCallback());
+
+	void SetRetryPolicy(std::shared_ptr<const RetryPolicy> policy) { retryPolicy = std::move(policy); }
+
+	bool Perform(const int &timeoutMs = 1000);
+	void Run();
+
+	size_t GetPendingCount() const { return pending.size(); }
+	size_t GetInFlightCount() const { return inFlight.size(); }
+
+private:
+	const unsigned int maxInFlight;
+	const unsigned int maxPerHost;
+	CURLM *multi;
+	std::shared_ptr<const RetryPolicy> retryPolicy;
+
+	enum class Protocol
+	{
+		SMTP,
+		REST
+	};
+
+	struct Transfer
+	{
+		std::unique_ptr<EmailSender> sender;
+		Protocol protocol;
+		CompletionCallback callback;
+		std::string host;
+
+		unsigned int attempts = 0;
+		unsigned int retryDelayMs = 0;
+		std::chrono::steady_clock::time_point notBefore;
+
+		CURL *curl = nullptr;
+		curl_slist *recipientList = nullptr;
+		EmailSender::EmailPOSTer poster;
+		EmailSender::EmailPOSTer::AdditionalPostData postData;
+		std::string body;
+		std::string response;
+	};
+
+	std::deque<std::unique_ptr<Transfer>> pending;
+	std::map<CURL*, std::unique_ptr<Transfer>> inFlight;
+	std::map<std::string, unsigned int> hostInFlightCount;
+
+	void Add(std::unique_ptr<EmailSender> sender, const Protocol &protocol, CompletionCallback callback);
+	unsigned int StartTransfers();
+	bool Start(Transfer &transfer);
+	void Finish(CURL *curl, const CURLcode &result);
+	static void Cleanup(Transfer &transfer);
+
+	static std::string ExtractHost(const std::string &url);
+};
+
+#endif// SEND_ENGINE_H_
@@ -0,0 +1,160 @@
+// File:  sendResult.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Detailed outcome of an attempt to send a message.
+
+// Local headers
+#include "sendResult.h"
+
+//==========================================================================
+// Class:			SendResult
+// Function:		IsTransient
+//
+// Description:		Determines whether the failure is temporary, so that
+//					sending the same message again later may succeed.  Server
+//					replies take precedence over the cURL error code.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool
+//
+//==========================================================================
+bool SendResult::IsTransient() const
+{
+	if (success)
+		return false;
+	else if (deferred)
+		return true;
+
+	if (protocol == Protocol::SMTP && responseCode >= 400 && responseCode < 600)
+		return responseCode < 500;
+	else if (protocol == Protocol::HTTP && responseCode >= 400)
+		return responseCode == 408 || responseCode == 425 || responseCode == 429 ||
+			responseCode == 500 || responseCode == 502 || responseCode == 503 || responseCode == 504;
+
+	switch (curlCode)
+	{
+	case CURLE_COULDNT_RESOLVE_HOST:
+	case CURLE_COULDNT_CONNECT:
+	case CURLE_OPERATION_TIMEDOUT:
+	case CURLE_SSL_CONNECT_ERROR:
+	case CURLE_SEND_ERROR:
+	case CURLE_RECV_ERROR:
+	case CURLE_GOT_NOTHING:
+	case CURLE_PARTIAL_FILE:
+	case CURLE_HTTP2:
+	case CURLE_HTTP2_STREAM:
+	case CURLE_AGAIN:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+//==========================================================================
+// Class:			SendResult
+// Function:		Make (static)
+//
+// Description:		Creates a result from the outcome of a transfer.  HTTP
+//					transfers only succeed if the status code is 2xx.
+//
+// Input Arguments:
+//		protocol		= const Protocol&
+//		curlCode		= const CURLcode&
+//		responseCode	= const long&
+//		retryAfterMs	= const unsigned int&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		SendResult
+//
+//==========================================================================
+SendResult SendResult::Make(const Protocol &protocol, const CURLcode &curlCode, const long &responseCode,
+	const unsigned int &retryAfterMs)
+{
+	SendResult result;
+	result.protocol = protocol;
+	result.curlCode = curlCode;
+	result.responseCode = responseCode;
+	result.retryAfterMs = retryAfterMs;
+
+	if (curlCode != CURLE_OK)
+		result.description = curl_easy_strerror(curlCode);
+	else if (protocol == Protocol::HTTP && (responseCode < 200 || responseCode >= 300))
+		result.description = "HTTP status " + std::to_string(responseCode);
+	else
+		result.success = true;
+
+	if (!result.success && protocol == Protocol::SMTP && responseCode >= 400)
+		result.description.append(" (SMTP reply " + std::to_string(responseCode) + ")");
+
+	return result;
+}
+
+//==========================================================================
+// Class:			SendResult
+// Function:		FromCURL (static)
+//
+// Description:		Creates a result from a completed transfer.
+//
+// Input Arguments:
+//		curl		= CURL*
+//		curlCode	= const CURLcode&
+//		protocol	= const Protocol&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		SendResult
+//
+//==========================================================================
+SendResult SendResult::FromCURL(CURL *curl, const CURLcode &curlCode, const Protocol &protocol)
+{
+	long responseCode(0);
+	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
+
+	unsigned int retryAfterMs(0);
+#if LIBCURL_VERSION_NUM >= 0x074200
+	if (protocol == Protocol::HTTP)
+	{
+		curl_off_t retryAfter(0);
+		if (curl_easy_getinfo(curl, CURLINFO_RETRY_AFTER, &retryAfter) == CURLE_OK && retryAfter > 0)
+			retryAfterMs = static_cast<unsigned int>(retryAfter * 1000);
+	}
+#endif
+
+	return Make(protocol, curlCode, responseCode, retryAfterMs);
+}
+
+//==========================================================================
+// Class:			SendResult
+// Function:		Deferred (static)
+//
+// Description:		Creates a result for a message which was not attempted.
+//
+// Input Arguments:
+//		description	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		SendResult
+//
+//==========================================================================
+SendResult SendResult::Deferred(const std::string &description)
+{
+	SendResult result;
+	result.deferred = true;
+	result.description = description;
+	return result;
+}
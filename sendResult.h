@@ -0,0 +1,40 @@
+// File:  sendResult.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Detailed outcome of an attempt to send a message.
+
+#ifndef SEND_RESULT_H_
+#define SEND_RESULT_H_
+
+// cURL headers
+#include <curl/curl.h>
+
+// Standard C++ headers
+#include <string>
+
+struct SendResult
+{
+	enum class Protocol
+	{
+		SMTP,
+		HTTP
+	};
+
+	bool success = false;
+	bool deferred = false;// Not attempted (i.e. held back by the rate limiter)
+	Protocol protocol = Protocol::SMTP;
+	CURLcode curlCode = CURLE_OK;
+	long responseCode = 0;// Last SMTP reply or HTTP status code (zero if none was received)
+	unsigned int retryAfterMs = 0;// From the Retry-After header (HTTP only)
+	std::string description;// Empty on success
+
+	// True if the same message might be accepted later (4xx SMTP replies, dropped connections, etc.)
+	bool IsTransient() const;
+
+	static SendResult Make(const Protocol &protocol, const CURLcode &curlCode, const long &responseCode,
+		const unsigned int &retryAfterMs = 0);
+	static SendResult FromCURL(CURL *curl, const CURLcode &curlCode, const Protocol &protocol);
+	static SendResult Deferred(const std::string &description);
+};
+
+#endif// SEND_RESULT_H_
@@ -0,0 +1,801 @@
+// File:  smtpClient.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Long-lived SMTP connection driven by SMTPProtocol instead of libcurl's
+//        SMTP implementation, so envelopes are pipelined and bodies are chunked
+//        when the server supports it.
+
+// Local headers
+#include "smtpClient.h"
+#include "oAuth2Interface.h"
+#include "rateLimiter.h"
+
+// Standard C++ headers
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#define poll WSAPoll
+#else
+#include <poll.h>
+#endif
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		SMTPClient
+//
+// Description:		Constructor for SMTPClient class.  The connection is not
+//					opened until the first message is sent.
+//
+// Input Arguments:
+//		loginInfo	= const EmailSender::LoginInfo&
+//		testMode	= const bool&
+//		outStream	= UString::OStream&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+SMTPClient::SMTPClient(const EmailSender::LoginInfo &loginInfo, const bool &testMode,
+	UString::OStream &outStream) : loginInfo(loginInfo), testMode(testMode), outStream(outStream)
+{
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		~SMTPClient
+//
+// Description:		Destructor for SMTPClient class.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+SMTPClient::~SMTPClient()
+{
+	Close();
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		Close
+//
+// Description:		Closes the connection (sending QUIT if the session is
+//					idle).  The next message opens a new connection.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPClient::Close()
+{
+	if (curl && protocol && protocol->GetState() == SMTPProtocol::State::Ready)
+	{
+		protocol->Quit();
+		Run();
+	}
+
+	protocol.reset();
+	tls.reset();
+	if (curl)
+		curl_easy_cleanup(curl);
+	curl = nullptr;
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		Open
+//
+// Description:		Opens the connection, if it is not already open, so the
+//					server's extensions are known before the first message.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool SMTPClient::Open()
+{
+	if (curl || Connect())
+		return true;
+
+	outStream << "Failed to connect to SMTP server:  " << lastResult.description << std::endl;
+	return false;
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		Send
+//
+// Description:		Sends a single message, opening the connection first if
+//					necessary.  If the server dropped the connection since
+//					the last message, the payload is rewound and the message
+//					is sent again over a new connection.  If the account has
+//					a rate limiter, waits for it first.
+//
+// Input Arguments:
+//		recipients	= const std::vector<EmailSender::AddressInfo>&
+//		payload		= PayloadReader&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise (see GetLastResult() and
+//		GetRecipientResults() for details)
+//
+//==========================================================================
+bool SMTPClient::Send(const std::vector<EmailSender::AddressInfo> &recipients, PayloadReader &payload)
+{
+	recipientResults.clear();
+	if (loginInfo.rateLimiter && !loginInfo.rateLimiter->Acquire(static_cast<unsigned int>(recipients.size())))
+	{
+		lastResult = SendResult::Deferred("Sending limit reached");
+		outStream << "Failed sending e-mail:  " << lastResult.description << std::endl;
+		return false;
+	}
+
+	std::vector<std::string> addresses(recipients.size());
+	std::transform(recipients.begin(), recipients.end(), addresses.begin(), [](const EmailSender::AddressInfo &a)
+	{
+		return a.address;
+	});
+
+	bool success(false);
+	const bool reused(curl != nullptr);
+	if (curl || Connect())
+	{
+		success = Transact(addresses, payload);
+		if (!success && reused && WasDropped() && payload.Rewind())
+		{
+			if (testMode)
+				outStream << "SMTP connection was dropped by the server; reconnecting" << std::endl;
+
+			Close();
+			if (Connect())
+				success = Transact(addresses, payload);
+		}
+	}
+
+	if (!success)
+	{
+		outStream << "Failed sending e-mail:  " << lastResult.description << std::endl;
+		if (loginInfo.rateLimiter && (lastResult.responseCode == 421 || lastResult.responseCode == 454))
+			loginInfo.rateLimiter->ReportThrottled();
+	}
+
+	return success;
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		Connect
+//
+// Description:		Opens the connection and runs the protocol engine through
+//					the greeting, EHLO, STARTTLS (if required) and
+//					authentication.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool SMTPClient::Connect()
+{
+	curl = curl_easy_init();
+	if (!curl)
+	{
+		outStream << "Failed to initialize CURL" << std::endl;
+		lastResult = SendResult::Make(SendResult::Protocol::SMTP, CURLE_FAILED_INIT, 0);
+		return false;
+	}
+
+	std::string domain, startTLSHost;
+	if (!SetConnectionOptions(curl, loginInfo, testMode, disableSignaling, timeoutSeconds, domain, startTLSHost))
+	{
+		outStream << "SMTPClient requires an smtp:// or smtps:// URL" << std::endl;
+		lastResult = SendResult::Make(SendResult::Protocol::SMTP, CURLE_UNSUPPORTED_PROTOCOL, 0);
+		Close();
+		return false;
+	}
+
+	CURLcode result(curl_easy_perform(curl));
+	if (result != CURLE_OK)
+	{
+		lastResult = SendResult::Make(SendResult::Protocol::SMTP, result, 0);
+		Close();
+		return false;
+	}
+
+	protocol = std::make_unique<SMTPProtocol>(GetProtocolSettings(loginInfo, domain, !startTLSHost.empty(), chunkSize));
+	result = Run();
+	if (result == CURLE_OK && protocol->GetState() == SMTPProtocol::State::StartingTLS)
+	{
+		result = StartTLS(startTLSHost);
+		if (result == CURLE_OK)
+			result = Run();
+	}
+
+	if (result != CURLE_OK || protocol->GetState() != SMTPProtocol::State::Ready)
+	{
+		lastResult = MakeHandshakeResult(result, *protocol);
+		Close();
+		return false;
+	}
+
+	extensions = protocol->GetExtensions();
+	if (testMode)
+		outStream << "SMTP server supports PIPELINING:  " << extensions.pipelining
+			<< ", CHUNKING:  " << extensions.chunking << ", SIZE:  " << extensions.maxSize
+			<< ", RCPTMAX:  " << extensions.maxRecipients << std::endl;
+
+	return true;
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		Transact
+//
+// Description:		Sends one message over the open connection.  The
+//					connection is closed if the session can not continue.
+//
+// Input Arguments:
+//		recipients	= const std::vector<std::string>&
+//		payload		= PayloadReader&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool SMTPClient::Transact(const std::vector<std::string> &recipients, PayloadReader &payload)
+{
+	if (!protocol->BeginTransaction(loginInfo.localEmail, recipients, payload))
+	{
+		recipientResults = protocol->GetRecipientResults();
+		lastResult = MakeRejectedResult(*protocol);
+		return false;
+	}
+
+	const CURLcode result(Run());
+	recipientResults = protocol->GetRecipientResults();
+	lastResult = MakeTransactionResult(result, *protocol);
+
+	if (result != CURLE_OK || protocol->GetState() != SMTPProtocol::State::Ready)
+		Close();
+
+	return lastResult.success;
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		Run
+//
+// Description:		Moves data between the connection and the protocol engine
+//					until the engine is idle.  Reading continues while there
+//					is output waiting, so replies to pipelined commands never
+//					stall the writes.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		CURLcode
+//
+//==========================================================================
+CURLcode SMTPClient::Run()
+{
+	char buffer[16384];
+	while (protocol->IsBusy())
+	{
+		bool progress(false);
+		const std::string_view output(protocol->GetOutput());
+		if (!output.empty())
+		{
+			size_t sent(0);
+			const CURLcode result(Write(output.data(), output.size(), sent));
+			if (result == CURLE_OK)
+			{
+				protocol->Consume(sent);
+				progress = true;
+			}
+			else if (result != CURLE_AGAIN)
+				return result;
+		}
+
+		size_t received(0);
+		const CURLcode result(Read(buffer, sizeof(buffer), received));
+		if (result == CURLE_OK)
+		{
+			if (received == 0)// Closed by the server
+				return protocol->GetState() == SMTPProtocol::State::Quitting ? CURLE_OK : CURLE_GOT_NOTHING;
+
+			if (testMode)
+				outStream << UString::ToStringType(std::string(buffer, received));
+
+			protocol->Receive(buffer, received);
+			progress = true;
+		}
+		else if (result != CURLE_AGAIN)
+			return result;
+
+		if (!progress)
+		{
+			const CURLcode waitResult(WaitForSocket(!protocol->GetOutput().empty() || (tls && tls->WantsWrite())));
+			if (waitResult != CURLE_OK)
+				return waitResult;
+		}
+	}
+
+	return CURLE_OK;
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		StartTLS
+//
+// Description:		Performs the TLS handshake after the server has accepted
+//					STARTTLS, and lets the protocol engine continue.  All
+//					further data passes through the TLS connection.
+//
+// Input Arguments:
+//		hostName	= const std::string&, name expected in the server's
+//					  certificate
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		CURLcode
+//
+//==========================================================================
+CURLcode SMTPClient::StartTLS(const std::string &hostName)
+{
+	if (!tlsContext)
+		tlsContext = TLSConnection::CreateContext(loginInfo.caCertificatePath);
+
+	tls = std::make_unique<TLSConnection>(tlsContext, curl, hostName);
+	CURLcode result;
+	while ((result = tls->Handshake()) == CURLE_AGAIN)
+	{
+		const CURLcode waitResult(WaitForSocket(tls->WantsWrite()));
+		if (waitResult != CURLE_OK)
+			return waitResult;
+	}
+
+	if (result == CURLE_OK)
+		protocol->TLSStarted();
+
+	return result;
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		Write
+//
+// Description:		Writes as much of the data as the connection will accept
+//					without blocking.
+//
+// Input Arguments:
+//		data	= const char*
+//		size	= const size_t&
+//
+// Output Arguments:
+//		sent	= size_t&
+//
+// Return Value:
+//		CURLcode
+//
+//==========================================================================
+CURLcode SMTPClient::Write(const char *data, const size_t &size, size_t &sent)
+{
+	if (tls)
+		return tls->Send(data, size, sent);
+	return curl_easy_send(curl, data, size, &sent);
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		Read
+//
+// Description:		Reads whatever data is available without blocking.
+//
+// Input Arguments:
+//		size		= const size_t&, size of the buffer
+//
+// Output Arguments:
+//		buffer		= char*
+//		received	= size_t&, zero if the server closed the connection
+//
+// Return Value:
+//		CURLcode
+//
+//==========================================================================
+CURLcode SMTPClient::Read(char *buffer, const size_t &size, size_t &received)
+{
+	if (tls)
+		return tls->Receive(buffer, size, received);
+	return curl_easy_recv(curl, buffer, size, &received);
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		WaitForSocket
+//
+// Description:		Waits until the connection is readable (or writable, if
+//					requested), or until the timeout expires.
+//
+// Input Arguments:
+//		forWrite	= const bool&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		CURLcode
+//
+//==========================================================================
+CURLcode SMTPClient::WaitForSocket(const bool &forWrite)
+{
+	curl_socket_t socket(CURL_SOCKET_BAD);
+	if (curl_easy_getinfo(curl, CURLINFO_ACTIVESOCKET, &socket) != CURLE_OK || socket == CURL_SOCKET_BAD)
+		return CURLE_RECV_ERROR;
+
+	pollfd descriptor;
+	descriptor.fd = socket;
+	descriptor.events = POLLIN;
+	if (forWrite)
+		descriptor.events |= POLLOUT;
+	descriptor.revents = 0;
+
+	const int result(poll(&descriptor, 1, static_cast<int>(timeoutSeconds * 1000)));
+	if (result == 0)
+		return CURLE_OPERATION_TIMEDOUT;
+	else if (result < 0 && errno != EINTR)
+		return CURLE_RECV_ERROR;
+
+	return CURLE_OK;
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		WasDropped
+//
+// Description:		Checks to see if the last message failed because the
+//					server closed the connection (i.e. idle timeout) before
+//					replying to any part of the transaction.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool
+//
+//==========================================================================
+bool SMTPClient::WasDropped() const
+{
+	const bool noReplies(std::none_of(recipientResults.begin(), recipientResults.end(),
+		[](const SMTPProtocol::RecipientResult &r)
+	{
+		return r.reply.code != 0;
+	}));
+
+	return noReplies && (lastResult.responseCode == 421 ||
+		lastResult.curlCode == CURLE_SEND_ERROR ||
+		lastResult.curlCode == CURLE_RECV_ERROR ||
+		lastResult.curlCode == CURLE_GOT_NOTHING);
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		SetConnectionOptions (static)
+//
+// Description:		Sets the options which open the connection used by
+//					SMTPProtocol on the specified handle.  Using an http(s)://
+//					URL with CURLOPT_CONNECT_ONLY means libcurl stops after
+//					the TCP and TLS handshakes instead of starting its own
+//					SMTP conversation.  For smtp:// URLs, TLS (if required)
+//					is started later, with STARTTLS.
+//
+// Input Arguments:
+//		curl				= CURL*
+//		loginInfo			= const EmailSender::LoginInfo&
+//		testMode			= const bool&
+//		disableSignaling	= const bool&
+//		timeoutSeconds		= const unsigned int&
+//
+// Output Arguments:
+//		domain				= std::string&, to be sent with EHLO
+//		startTLSHost		= std::string&, name expected in the server's
+//							  certificate after STARTTLS; empty if STARTTLS
+//							  is not used
+//
+// Return Value:
+//		bool, true for success, false if the URL is not supported
+//
+//==========================================================================
+bool SMTPClient::SetConnectionOptions(CURL *curl, const EmailSender::LoginInfo &loginInfo, const bool &testMode,
+	const bool &disableSignaling, const unsigned int &timeoutSeconds, std::string &domain,
+	std::string &startTLSHost)
+{
+	std::string transportUrl;
+	const bool requireTLS(loginInfo.useSSL || !loginInfo.oAuth2Token.empty());
+	if (!GetTransportURL(loginInfo.smtpUrl, requireTLS, transportUrl, domain, startTLSHost))
+		return false;
+
+	curl_easy_setopt(curl, CURLOPT_URL, transportUrl.c_str());
+	curl_easy_setopt(curl, CURLOPT_CONNECT_ONLY, 1L);
+	curl_easy_setopt(curl, CURLOPT_SSL_ENABLE_ALPN, 0L);
+	curl_easy_setopt(curl, CURLOPT_PROXY, "");
+	curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+	curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, static_cast<long>(timeoutSeconds));
+
+	if (disableSignaling)
+		curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+
+	if (!loginInfo.caCertificatePath.empty())
+		curl_easy_setopt(curl, CURLOPT_CAPATH, loginInfo.caCertificatePath.c_str());
+
+	if (testMode)
+		curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
+
+	return true;
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		GetProtocolSettings (static)
+//
+// Description:		Creates the protocol engine settings for the specified
+//					login.  Access tokens expire, so this should be called
+//					for each new connection.
+//
+// Input Arguments:
+//		loginInfo	= const EmailSender::LoginInfo&
+//		domain		= const std::string&
+//		startTLS	= const bool&
+//		chunkSize	= const size_t&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		SMTPProtocol::Settings
+//
+//==========================================================================
+SMTPProtocol::Settings SMTPClient::GetProtocolSettings(const EmailSender::LoginInfo &loginInfo,
+	const std::string &domain, const bool &startTLS, const size_t &chunkSize)
+{
+	SMTPProtocol::Settings settings;
+	settings.domain = domain;
+	settings.startTLS = startTLS;
+	settings.userName = loginInfo.localEmail;
+	settings.chunkSize = chunkSize;
+	if (!loginInfo.oAuth2Token.empty())
+	{
+		settings.authentication = SMTPProtocol::Authentication::XOAuth2;
+		settings.secret = UString::ToNarrowString(OAuth2Interface::Get().GetAccessToken());
+	}
+	else if (!loginInfo.password.empty())
+	{
+		settings.authentication = SMTPProtocol::Authentication::Plain;
+		settings.secret = loginInfo.password;
+	}
+
+	return settings;
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		MakeHandshakeResult (static)
+//
+// Description:		Creates a result for a connection which did not reach the
+//					Ready state.
+//
+// Input Arguments:
+//		curlCode	= const CURLcode&, transport error (if any)
+//		protocol	= const SMTPProtocol&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		SendResult
+//
+//==========================================================================
+SendResult SMTPClient::MakeHandshakeResult(const CURLcode &curlCode, const SMTPProtocol &protocol)
+{
+	const SMTPProtocol::Reply &reply(protocol.GetLastReply());
+	if (curlCode != CURLE_OK && protocol.GetState() == SMTPProtocol::State::StartingTLS)
+		return SendResult::Make(SendResult::Protocol::SMTP, curlCode, 0);// TLS handshake failed
+	else if (curlCode != CURLE_OK)
+		return MakeResult(curlCode, reply);
+	else if (protocol.TLSRefused())
+		return MakeResult(CURLE_USE_SSL_FAILED, reply);
+	else if (reply.code == 530 || reply.code == 534 || reply.code == 535)
+		return MakeResult(CURLE_LOGIN_DENIED, reply);
+	return MakeResult(CURLE_WEIRD_SERVER_REPLY, reply);
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		MakeTransactionResult (static)
+//
+// Description:		Creates a result for the protocol engine's last
+//					transaction.
+//
+// Input Arguments:
+//		curlCode	= const CURLcode&, transport error (if any)
+//		protocol	= const SMTPProtocol&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		SendResult
+//
+//==========================================================================
+SendResult SMTPClient::MakeTransactionResult(const CURLcode &curlCode, const SMTPProtocol &protocol)
+{
+	if (curlCode != CURLE_OK)
+		return MakeResult(curlCode, protocol.GetTransactionReply());
+	else if (!protocol.TransactionSucceeded())
+		return MakeResult(CURLE_SEND_ERROR, protocol.GetTransactionReply());
+	return MakeResult(CURLE_OK, protocol.GetTransactionReply());
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		MakeRejectedResult (static)
+//
+// Description:		Creates a result for a message which the protocol engine
+//					rejected without contacting the server:  either it
+//					exceeds the server's SIZE limit (reported with 552) or
+//					the payload could not be read.
+//
+// Input Arguments:
+//		protocol	= const SMTPProtocol&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		SendResult
+//
+//==========================================================================
+SendResult SMTPClient::MakeRejectedResult(const SMTPProtocol &protocol)
+{
+	return MakeResult(protocol.GetTransactionReply().code == 552 ? CURLE_FILESIZE_EXCEEDED : CURLE_READ_ERROR,
+		protocol.GetTransactionReply());
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		MakeResult (static)
+//
+// Description:		Creates a result which includes the server's reply text.
+//
+// Input Arguments:
+//		curlCode	= const CURLcode&
+//		reply		= const SMTPProtocol::Reply&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		SendResult
+//
+//==========================================================================
+SendResult SMTPClient::MakeResult(const CURLcode &curlCode, const SMTPProtocol::Reply &reply)
+{
+	SendResult result(SendResult::Make(SendResult::Protocol::SMTP, curlCode, reply.code));
+	if (!result.success && !reply.text.empty())
+		result.description.append(":  " + reply.text);
+	return result;
+}
+
+//==========================================================================
+// Class:			SMTPClient
+// Function:		GetTransportURL (static)
+//
+// Description:		Converts an SMTP URL into the URL used to open the
+//					connection.  As with libcurl, the EHLO domain is taken
+//					from the URL's path, defaulting to "localhost".  If TLS
+//					is required for an smtp:// URL, the connection will be
+//					upgraded with STARTTLS.
+//
+// Input Arguments:
+//		smtpUrl			= const std::string&
+//		requireTLS		= const bool&
+//
+// Output Arguments:
+//		transportUrl	= std::string&
+//		domain			= std::string&
+//		startTLSHost	= std::string&, empty if STARTTLS is not used
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool SMTPClient::GetTransportURL(const std::string &smtpUrl, const bool &requireTLS,
+	std::string &transportUrl, std::string &domain, std::string &startTLSHost)
+{
+	CURLU *url(curl_url());
+	if (!url)
+		return false;
+
+	char *scheme(nullptr), *host(nullptr), *port(nullptr), *path(nullptr);
+	bool success(curl_url_set(url, CURLUPART_URL, smtpUrl.c_str(), 0) == CURLUE_OK &&
+		curl_url_get(url, CURLUPART_SCHEME, &scheme, 0) == CURLUE_OK &&
+		curl_url_get(url, CURLUPART_HOST, &host, 0) == CURLUE_OK &&
+		curl_url_get(url, CURLUPART_PORT, &port, CURLU_DEFAULT_PORT) == CURLUE_OK &&
+		curl_url_get(url, CURLUPART_PATH, &path, 0) == CURLUE_OK);
+
+	if (success)
+	{
+		const std::string s(scheme);
+		if (s == "smtps")
+			transportUrl = "https://";
+		else if (s == "smtp")
+			transportUrl = "http://";
+		else
+			success = false;
+
+		transportUrl.append(std::string(host) + ":" + port);
+
+		startTLSHost.clear();
+		if (s == "smtp" && requireTLS)
+		{
+			// IPv6 addresses are bracketed in URLs
+			startTLSHost = host;
+			if (startTLSHost.size() > 2 && startTLSHost.front() == '[' && startTLSHost.back() == ']')
+				startTLSHost = startTLSHost.substr(1, startTLSHost.size() - 2);
+		}
+		domain = std::string(path).substr(std::min<size_t>(1, strlen(path)));
+		if (domain.empty())
+			domain = "localhost";
+	}
+
+	curl_free(scheme);
+	curl_free(host);
+	curl_free(port);
+	curl_free(path);
+	curl_url_cleanup(url);
+
+	return success;
+}
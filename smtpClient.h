@@ -0,0 +1,98 @@
+// File:  smtpClient.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Long-lived SMTP connection driven by SMTPProtocol instead of libcurl's
+//        SMTP implementation, so envelopes are pipelined and bodies are chunked
+//        when the server supports it.
+
+#ifndef SMTP_CLIENT_H_
+#define SMTP_CLIENT_H_
+
+// Local headers
+#include "emailSender.h"
+#include "sendResult.h"
+#include "smtpProtocol.h"
+#include "tlsConnection.h"
+
+// cURL headers
+#include <curl/curl.h>
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+#include <memory>
+
+// libcurl only provides the connection (TCP, and TLS for smtps:// URLs).
+// If the login requires TLS (useSSL or OAuth2) and the URL is smtp://, the
+// connection is upgraded with STARTTLS before authenticating.
+class SMTPClient
+{
+public:
+	SMTPClient(const EmailSender::LoginInfo &loginInfo, const bool &testMode,
+		UString::OStream &outStream = Cout);
+	~SMTPClient();
+
+	SMTPClient(const SMTPClient&) = delete;
+	SMTPClient& operator=(const SMTPClient&) = delete;
+
+	void DisableSignaling(const bool& disable = true) { disableSignaling = disable; }
+	void SetTimeout(const unsigned int &seconds) { timeoutSeconds = seconds; }// Maximum time to wait for the server
+	void SetChunkSize(const size_t &size) { chunkSize = size; }// Maximum BDAT chunk size
+
+	bool Open();// Optional; Send() connects as needed
+	bool Send(const std::vector<EmailSender::AddressInfo> &recipients, PayloadReader &payload);
+
+	void Close();
+
+	const EmailSender::LoginInfo& GetLoginInfo() const { return loginInfo; }
+	const SendResult& GetLastResult() const { return lastResult; }
+
+	// Server's reply to each recipient of the last message (reply codes are
+	// zero for recipients which were not attempted)
+	const std::vector<SMTPProtocol::RecipientResult>& GetRecipientResults() const { return recipientResults; }
+
+	// Extensions advertised by the server (valid while connected)
+	const SMTPProtocol::Extensions& GetExtensions() const { return extensions; }
+
+	// For other users of SMTPProtocol (i.e. SMTPEventEngine)
+	static bool SetConnectionOptions(CURL *curl, const EmailSender::LoginInfo &loginInfo, const bool &testMode,
+		const bool &disableSignaling, const unsigned int &timeoutSeconds, std::string &domain,
+		std::string &startTLSHost);
+	static SMTPProtocol::Settings GetProtocolSettings(const EmailSender::LoginInfo &loginInfo,
+		const std::string &domain, const bool &startTLS, const size_t &chunkSize);
+	static SendResult MakeHandshakeResult(const CURLcode &curlCode, const SMTPProtocol &protocol);
+	static SendResult MakeTransactionResult(const CURLcode &curlCode, const SMTPProtocol &protocol);
+	static SendResult MakeRejectedResult(const SMTPProtocol &protocol);// When BeginTransaction() fails
+	static SendResult MakeResult(const CURLcode &curlCode, const SMTPProtocol::Reply &reply);
+
+private:
+	const EmailSender::LoginInfo loginInfo;
+	const bool testMode;
+	bool disableSignaling = false;
+	unsigned int timeoutSeconds = 300;
+	size_t chunkSize = 65536;
+	UString::OStream &outStream;
+
+	CURL *curl = nullptr;
+	std::unique_ptr<SMTPProtocol> protocol;
+	SMTPProtocol::Extensions extensions;
+	std::shared_ptr<SSL_CTX> tlsContext;
+	std::unique_ptr<TLSConnection> tls;// Set once STARTTLS has been accepted
+
+	SendResult lastResult;
+	std::vector<SMTPProtocol::RecipientResult> recipientResults;
+
+	bool Connect();
+	bool Transact(const std::vector<std::string> &recipients, PayloadReader &payload);
+	CURLcode Run();
+	CURLcode StartTLS(const std::string &hostName);
+	CURLcode Write(const char *data, const size_t &size, size_t &sent);
+	CURLcode Read(char *buffer, const size_t &size, size_t &received);
+	CURLcode WaitForSocket(const bool &forWrite);
+	bool WasDropped() const;
+
+	static bool GetTransportURL(const std::string &smtpUrl, const bool &requireTLS,
+		std::string &transportUrl, std::string &domain, std::string &startTLSHost);
+};
+
+#endif// SMTP_CLIENT_H_
@@ -0,0 +1,1348 @@
+// File:  smtpEventEngine.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Sends many messages over many concurrent SMTP connections, with each
+//        thread servicing hundreds of connections through epoll (Linux only).
+
+#ifdef __linux__
+
+// Local headers
+#include "smtpEventEngine.h"
+#include "smtpClient.h"
+#include "rateLimiter.h"
+
+// Standard C++ headers
+#include <algorithm>
+#include <numeric>
+#include <cerrno>
+#include <cstdint>
+
+// Linux headers
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+
+//==========================================================================
+// Class:			SMTPEventEngine
+// Function:		SMTPEventEngine
+//
+// Description:		Constructor for SMTPEventEngine class.  Starts the event
+//					loops.
+//
+// Input Arguments:
+//		loginInfo	= const EmailSender::LoginInfo&
+//		testMode	= const bool&
+//		options		= const Options&
+//		outStream	= UString::OStream&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+SMTPEventEngine::SMTPEventEngine(const EmailSender::LoginInfo &loginInfo, const bool &testMode,
+	const Options &options, UString::OStream &outStream) : loginInfo(loginInfo), testMode(testMode),
+	options(options), outStream(outStream), nextLoop(0)
+{
+	unsigned int loopCount(options.loopCount);
+	if (loopCount == 0)
+		loopCount = std::max(std::thread::hardware_concurrency(), 1U);
+
+	for (unsigned int i = 0; i < loopCount; ++i)
+		loops.push_back(std::make_unique<Loop>(*this, i));
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine
+// Function:		~SMTPEventEngine
+//
+// Description:		Destructor for SMTPEventEngine class.  Waits for all
+//					messages to be sent and stops the event loops.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+SMTPEventEngine::~SMTPEventEngine()
+{
+	Wait();
+	loops.clear();
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine
+// Function:		Add
+//
+// Description:		Queues a message to be sent.  Messages are distributed
+//					between the loops in turn.
+//
+// Input Arguments:
+//		sender		= std::unique_ptr<EmailSender>
+//		callback	= CompletionCallback, called from the loop's thread
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Add(std::unique_ptr<EmailSender> sender, CompletionCallback callback)
+{
+	{
+		std::lock_guard<std::mutex> lock(outstandingMutex);
+		++outstanding;
+	}
+
+	std::unique_ptr<Job> job(std::make_unique<Job>());
+	job->sender = std::move(sender);
+	job->callback = std::move(callback);
+	job->sender->ResetRecipientResults();
+	job->sender->ResetSharedContent();
+	job->remaining.resize(job->sender->content.recipients.size());
+	std::iota(job->remaining.begin(), job->remaining.end(), 0);
+	job->limit = job->sender->maxRecipientsPerTransaction;
+	loops[nextLoop++ % loops.size()]->Add(std::move(job));
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine
+// Function:		Wait
+//
+// Description:		Blocks until every message which has been added is
+//					complete.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Wait()
+{
+	std::unique_lock<std::mutex> lock(outstandingMutex);
+	outstandingCondition.wait(lock, [this]()
+	{
+		return outstanding == 0;
+	});
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine
+// Function:		JobComplete
+//
+// Description:		Records the completion of a message.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::JobComplete()
+{
+	{
+		std::lock_guard<std::mutex> lock(outstandingMutex);
+		--outstanding;
+	}
+
+	outstandingCondition.notify_all();
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		Loop
+//
+// Description:		Constructor for Loop class.  Creates the epoll instance
+//					and the multi handle which shares it, and starts the
+//					loop's thread on its own core.
+//
+// Input Arguments:
+//		engine	= SMTPEventEngine&
+//		index	= const unsigned int&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+SMTPEventEngine::Loop::Loop(SMTPEventEngine &engine, const unsigned int &index) : engine(engine),
+	epollFd(epoll_create1(EPOLL_CLOEXEC)), wakeupFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), multi(curl_multi_init())
+{
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.fd = wakeupFd;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeupFd, &event);
+
+	curl_multi_setopt(multi, CURLMOPT_SOCKETFUNCTION, &Loop::SocketCallback);
+	curl_multi_setopt(multi, CURLMOPT_SOCKETDATA, this);
+	curl_multi_setopt(multi, CURLMOPT_TIMERFUNCTION, &Loop::TimerCallback);
+	curl_multi_setopt(multi, CURLMOPT_TIMERDATA, this);
+
+	thread = std::thread(&Loop::Run, this);
+
+	const unsigned int coreCount(std::max(std::thread::hardware_concurrency(), 1U));
+	cpu_set_t cores;
+	CPU_ZERO(&cores);
+	CPU_SET(index % coreCount, &cores);
+	pthread_setaffinity_np(thread.native_handle(), sizeof(cores), &cores);
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		~Loop
+//
+// Description:		Destructor for Loop class.  Waits for the loop to finish
+//					its queued messages.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+SMTPEventEngine::Loop::~Loop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+
+	const uint64_t one(1);
+	if (write(wakeupFd, &one, sizeof(one)) < 0)
+	{
+		// Counter is already non-zero
+	}
+
+	if (thread.joinable())
+		thread.join();
+
+	curl_multi_cleanup(multi);
+	close(wakeupFd);
+	close(epollFd);
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		Add
+//
+// Description:		Passes a message to the loop's thread.
+//
+// Input Arguments:
+//		job	= std::unique_ptr<Job>
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Loop::Add(std::unique_ptr<Job> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		incoming.push_back(std::move(job));
+	}
+
+	const uint64_t one(1);
+	if (write(wakeupFd, &one, sizeof(one)) < 0)
+	{
+		// Counter is already non-zero
+	}
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		Run
+//
+// Description:		Thread entry point.  Dispatches socket events to their
+//					sessions (or to libcurl, for connections which are still
+//					being opened) and fires expired timers.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Loop::Run()
+{
+	const int maxEvents(64);
+	epoll_event events[maxEvents];
+	while (TakeIncoming())
+	{
+		OpenSessions();
+
+		const int count(epoll_wait(epollFd, events, maxEvents, GetWaitTime()));
+		for (int i = 0; i < count; ++i)
+		{
+			const int fd(events[i].data.fd);
+			if (fd == wakeupFd)
+			{
+				uint64_t value;
+				if (read(wakeupFd, &value, sizeof(value)) < 0)
+				{
+					// Already reset
+				}
+				continue;
+			}
+
+			const auto it(sessionsBySocket.find(fd));
+			if (it != sessionsBySocket.end())
+			{
+				Service(*it->second);
+				continue;
+			}
+
+			int flags(0);
+			if (events[i].events & EPOLLIN)
+				flags |= CURL_CSELECT_IN;
+			if (events[i].events & EPOLLOUT)
+				flags |= CURL_CSELECT_OUT;
+			if (events[i].events & (EPOLLERR | EPOLLHUP))
+				flags |= CURL_CSELECT_ERR;
+			ProcessCurl(fd, flags);
+		}
+
+		if (hasCurlTimer && Clock::now() >= curlDeadline)
+		{
+			hasCurlTimer = false;
+			ProcessCurl(CURL_SOCKET_TIMEOUT, 0);
+		}
+
+		ProcessTimers();
+	}
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		TakeIncoming
+//
+// Description:		Moves messages passed to Add() into the loop's queue.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, false once the loop has been stopped and has no work left
+//
+//==========================================================================
+bool SMTPEventEngine::Loop::TakeIncoming()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto& job : incoming)
+		queue.push_back(std::move(job));
+	incoming.clear();
+
+	return !stopping || !queue.empty() || !sessions.empty();
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		GetWaitTime
+//
+// Description:		Returns the time until the next session timer or libcurl
+//					timer expires.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		int, time to wait [ms], or -1 if there are no timers
+//
+//==========================================================================
+int SMTPEventEngine::Loop::GetWaitTime() const
+{
+	if (timers.empty() && !hasCurlTimer)
+		return -1;
+
+	Clock::time_point next(Clock::time_point::max());
+	if (!timers.empty())
+		next = timers.begin()->first;
+	if (hasCurlTimer)
+		next = std::min(next, curlDeadline);
+
+	const Clock::time_point now(Clock::now());
+	if (next <= now)
+		return 0;
+
+	return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count() + 1);
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		ProcessCurl
+//
+// Description:		Lets libcurl act on a socket (or timeout) and handles any
+//					connections which have finished opening.
+//
+// Input Arguments:
+//		socket	= const curl_socket_t&
+//		flags	= const int&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Loop::ProcessCurl(const curl_socket_t &socket, const int &flags)
+{
+	int running;
+	curl_multi_socket_action(multi, socket, flags, &running);
+
+	CURLMsg *message;
+	int messagesInQueue;
+	while ((message = curl_multi_info_read(multi, &messagesInQueue)))
+	{
+		if (message->msg == CURLMSG_DONE)
+			Connected(message->easy_handle, message->data.result);
+	}
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		ProcessTimers
+//
+// Description:		Handles expired session timers.  Sessions held back by
+//					the rate limiter try again; others have waited too long
+//					for the server.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Loop::ProcessTimers()
+{
+	const Clock::time_point now(Clock::now());
+	while (!timers.empty() && timers.begin()->first <= now)
+	{
+		Session &session(*timers.begin()->second);
+		ClearTimer(session);
+		if (session.held)
+		{
+			session.held = false;
+			Advance(session);
+		}
+		else
+			Fail(session, CURLE_OPERATION_TIMEDOUT);
+	}
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		OpenSessions
+//
+// Description:		Opens a connection for each queued message, up to the
+//					session limit.  Once open, sessions take further messages
+//					from the queue as they finish each one.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Loop::OpenSessions()
+{
+	while (!queue.empty() && sessions.size() < engine.options.sessionsPerLoop)
+	{
+		std::unique_ptr<Job> job(std::move(queue.front()));
+		queue.pop_front();
+		OpenSession(std::move(job));
+	}
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		OpenSession
+//
+// Description:		Starts opening a connection for the specified message.
+//
+// Input Arguments:
+//		job	= std::unique_ptr<Job>
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise (the message is complete)
+//
+//==========================================================================
+bool SMTPEventEngine::Loop::OpenSession(std::unique_ptr<Job> job)
+{
+	std::unique_ptr<Session> session(std::make_unique<Session>());
+	session->job = std::move(job);
+	session->curl = curl_easy_init();
+	if (!session->curl)
+	{
+		Finish(*session, SendResult::Make(SendResult::Protocol::SMTP, CURLE_FAILED_INIT, 0));
+		return false;
+	}
+
+	if (!SMTPClient::SetConnectionOptions(session->curl, engine.loginInfo, engine.testMode, true,
+		engine.options.timeoutSeconds, session->domain, session->startTLSHost))
+	{
+		curl_easy_cleanup(session->curl);
+		Finish(*session, SendResult::Make(SendResult::Protocol::SMTP, CURLE_UNSUPPORTED_PROTOCOL, 0));
+		return false;
+	}
+
+	CURL *curl(session->curl);
+	sessions[curl] = std::move(session);
+	curl_multi_add_handle(multi, curl);
+	return true;
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		Connected
+//
+// Description:		Takes over a connection which libcurl has finished
+//					opening.  The handle stays in the multi handle (removing
+//					it would close the connection), but its socket is watched
+//					by the loop from now on.
+//
+// Input Arguments:
+//		curl	= CURL*
+//		result	= const CURLcode&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Loop::Connected(CURL *curl, const CURLcode &result)
+{
+	const auto it(sessions.find(curl));
+	if (it == sessions.end())
+		return;
+
+	Session &session(*it->second);
+	if (result != CURLE_OK)
+	{
+		Fail(session, result);
+		return;
+	}
+
+	if (curl_easy_getinfo(curl, CURLINFO_ACTIVESOCKET, &session.socket) != CURLE_OK ||
+		session.socket == CURL_SOCKET_BAD)
+	{
+		session.socket = CURL_SOCKET_BAD;
+		Fail(session, CURLE_COULDNT_CONNECT);
+		return;
+	}
+
+	session.protocol = std::make_unique<SMTPProtocol>(SMTPClient::GetProtocolSettings(
+		engine.loginInfo, session.domain, !session.startTLSHost.empty(), engine.options.chunkSize));
+	sessionsBySocket[session.socket] = &session;
+	Watch(session);
+	SetTimer(session, std::chrono::seconds(engine.options.timeoutSeconds));
+	Service(session);
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		Service
+//
+// Description:		Writes as much pending output and reads as much input as
+//					the connection allows without blocking.  Output is
+//					written directly from the protocol engine's buffers.
+//					While the TLS handshake is in progress, only the
+//					handshake is continued.  A session held back by the
+//					rate limiter only checks whether the server is closing
+//					the connection.
+//
+// Input Arguments:
+//		session	= Session&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Loop::Service(Session &session)
+{
+	if (session.handshaking && !ContinueTLS(session))
+		return;
+	else if (session.protocol->GetState() == SMTPProtocol::State::Ready && !CheckIdle(session))
+		return;
+
+	SMTPProtocol &protocol(*session.protocol);
+	char buffer[16384];
+	bool activity(false);
+	bool progress(true);
+	while (progress && protocol.IsBusy())
+	{
+		progress = false;
+		const std::string_view output(protocol.GetOutput());
+		if (!output.empty())
+		{
+			size_t sent(0);
+			const CURLcode result(Write(session, output.data(), output.size(), sent));
+			if (result == CURLE_OK)
+			{
+				protocol.Consume(sent);
+				progress = true;
+			}
+			else if (result != CURLE_AGAIN)
+			{
+				Fail(session, result);
+				return;
+			}
+		}
+
+		size_t received(0);
+		const CURLcode result(Read(session, buffer, sizeof(buffer), received));
+		if (result == CURLE_OK)
+		{
+			if (received == 0)// Closed by the server
+			{
+				if (protocol.GetState() == SMTPProtocol::State::Quitting)
+					CloseSession(session);
+				else
+					Fail(session, CURLE_GOT_NOTHING);
+				return;
+			}
+
+			protocol.Receive(buffer, received);
+			progress = true;
+		}
+		else if (result != CURLE_AGAIN)
+		{
+			Fail(session, result);
+			return;
+		}
+
+		activity = activity || progress;
+	}
+
+	if (activity)
+		SetTimer(session, std::chrono::seconds(engine.options.timeoutSeconds));
+
+	Advance(session);
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		CheckIdle
+//
+// Description:		Reads from a session which is not expecting anything
+//					from the server (i.e. one held by the rate limiter).
+//					The socket is watched for input regardless, so anything
+//					arriving must be read; it can only be the server closing
+//					the connection (i.e. 421 after its idle timeout), so the
+//					session is closed.  The held message was never offered
+//					to the server, so it goes back to the front of the queue.
+//
+// Input Arguments:
+//		session	= Session&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true if the session is still open, false if it was closed
+//
+//==========================================================================
+bool SMTPEventEngine::Loop::CheckIdle(Session &session)
+{
+	char buffer[512];
+	size_t received(0);
+	const CURLcode result(Read(session, buffer, sizeof(buffer), received));
+	if (result == CURLE_AGAIN)
+		return true;
+
+	if (engine.testMode && result == CURLE_OK && received > 0)
+		engine.outStream << "SMTP server closed an idle connection:  "
+			<< UString::ToStringType(std::string(buffer, received)) << std::flush;
+
+	if (session.job)
+		queue.push_front(std::move(session.job));
+	CloseSession(session);
+	return false;
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		Advance
+//
+// Description:		Moves an idle session on to its next step:  starting
+//					TLS, completing its message, starting the next queued
+//					message, or closing.
+//
+// Input Arguments:
+//		session	= Session&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Loop::Advance(Session &session)
+{
+	SMTPProtocol &protocol(*session.protocol);
+	while (!protocol.IsBusy() && !session.held)
+	{
+		const SMTPProtocol::State state(protocol.GetState());
+		if (state == SMTPProtocol::State::Failed || state == SMTPProtocol::State::Closed)
+		{
+			if (session.job)
+				Finish(session, session.transactionStarted ? SMTPClient::MakeTransactionResult(CURLE_OK, protocol) :
+					SMTPClient::MakeHandshakeResult(CURLE_OK, protocol));
+			CloseSession(session);
+			return;
+		}
+		else if (state == SMTPProtocol::State::StartingTLS)
+		{
+			StartTLS(session);
+			return;
+		}
+
+		if (session.job && session.transactionStarted)
+		{
+			++session.completedCount;
+			Finish(session, SMTPClient::MakeTransactionResult(CURLE_OK, protocol));
+		}
+
+		if (!session.job)
+		{
+			if (queue.empty())
+			{
+				protocol.Quit();
+				continue;
+			}
+
+			session.job = std::move(queue.front());
+			queue.pop_front();
+		}
+
+		StartTransaction(session);
+	}
+
+	Watch(session);
+	if (protocol.IsBusy() && !session.hasTimer)
+		SetTimer(session, std::chrono::seconds(engine.options.timeoutSeconds));
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		StartTLS
+//
+// Description:		Begins the TLS handshake once the server has accepted
+//					STARTTLS.  All further data passes through the TLS
+//					connection.
+//
+// Input Arguments:
+//		session	= Session&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Loop::StartTLS(Session &session)
+{
+	if (!tlsContext)
+		tlsContext = TLSConnection::CreateContext(engine.loginInfo.caCertificatePath);
+
+	session.tls = std::make_unique<TLSConnection>(tlsContext, session.curl, session.startTLSHost);
+	session.handshaking = true;
+	SetTimer(session, std::chrono::seconds(engine.options.timeoutSeconds));
+	Service(session);
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		ContinueTLS
+//
+// Description:		Continues the session's TLS handshake.  Once it is
+//					complete, the protocol engine continues the session.
+//
+// Input Arguments:
+//		session	= Session&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true if the handshake is complete, false if it is still in
+//		progress or has failed (in which case the session is closed)
+//
+//==========================================================================
+bool SMTPEventEngine::Loop::ContinueTLS(Session &session)
+{
+	const CURLcode result(session.tls->Handshake());
+	if (result == CURLE_AGAIN)
+	{
+		Watch(session);
+		return false;
+	}
+	else if (result != CURLE_OK)
+	{
+		Fail(session, result);
+		return false;
+	}
+
+	session.handshaking = false;
+	session.protocol->TLSStarted();
+	return true;
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		StartTransaction
+//
+// Description:		Starts sending the session's message to the next group
+//					of recipients, no larger than the server's limit if it
+//					declares one.  If the account's rate limiter does not
+//					allow it yet, the session is held until it does.  If the
+//					message is rejected before it is sent (i.e. over the
+//					server's SIZE limit), the rate limiter is given back
+//					what it counted.
+//
+// Input Arguments:
+//		session	= Session&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true if the transaction was started, false otherwise
+//
+//==========================================================================
+bool SMTPEventEngine::Loop::StartTransaction(Session &session)
+{
+	Job &job(*session.job);
+	EmailSender &sender(*job.sender);
+	const size_t serverLimit(session.protocol->GetExtensions().maxRecipients);
+	if (serverLimit > 0 && (job.limit == 0 || serverLimit < job.limit))
+		job.limit = serverLimit;
+	job.count = job.limit > 0 ? std::min(job.limit, job.remaining.size()) : job.remaining.size();
+
+	unsigned int waitMs;
+	if (engine.loginInfo.rateLimiter && !engine.loginInfo.rateLimiter->TryAcquire(
+		static_cast<unsigned int>(job.count), waitMs))
+	{
+		session.held = true;
+		SetTimer(session, std::chrono::milliseconds(waitMs));
+		return false;
+	}
+
+	const std::vector<EmailSender::AddressInfo> chunk(sender.GetChunk(job.remaining, job.count));
+	sender.PreparePayload(chunk);
+	std::vector<std::string> addresses(chunk.size());
+	std::transform(chunk.begin(), chunk.end(), addresses.begin(), [](const EmailSender::AddressInfo &a)
+	{
+		return a.address;
+	});
+
+	session.transactionStarted = true;
+	if (!session.protocol->BeginTransaction(engine.loginInfo.localEmail, addresses, sender.payload))
+	{
+		if (engine.loginInfo.rateLimiter)
+			engine.loginInfo.rateLimiter->Release(static_cast<unsigned int>(job.count));
+		Finish(session, SMTPClient::MakeRejectedResult(*session.protocol));
+		return false;
+	}
+
+	return true;
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		Fail
+//
+// Description:		Completes the session's message (if any) with the
+//					specified error and closes the session.
+//
+// Input Arguments:
+//		session	= Session&
+//		result	= const CURLcode&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Loop::Fail(Session &session, const CURLcode &result)
+{
+	if (session.job)
+	{
+		if (!session.protocol)
+			Finish(session, SendResult::Make(SendResult::Protocol::SMTP, result, 0));
+		else if (session.transactionStarted)
+			Finish(session, SMTPClient::MakeTransactionResult(result, *session.protocol));
+		else
+			Finish(session, SMTPClient::MakeHandshakeResult(result, *session.protocol));
+	}
+
+	CloseSession(session);
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		Finish
+//
+// Description:		Completes the session's transaction.  Recipients which
+//					have not been sent to yet are queued for another
+//					transaction, and a message which failed because the
+//					server dropped a reused connection is queued again
+//					(once).  Otherwise the message is complete.
+//
+// Input Arguments:
+//		session	= Session&
+//		result	= const SendResult&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Loop::Finish(Session &session, const SendResult &result)
+{
+	std::vector<SMTPProtocol::RecipientResult> recipientResults;
+	if (session.transactionStarted)
+		recipientResults = session.protocol->GetRecipientResults();
+
+	std::unique_ptr<Job> job(std::move(session.job));
+	session.transactionStarted = false;
+
+	if (!result.success && job->attempts++ == 0 && WasDropped(session, result, recipientResults))
+	{
+		queue.push_front(std::move(job));
+		return;
+	}
+
+	if (!result.success)
+	{
+		if (!job->failed)
+		{
+			job->failed = true;
+			job->failure = result;
+		}
+
+		if (engine.loginInfo.rateLimiter && (result.responseCode == 421 || result.responseCode == 454))
+			engine.loginInfo.rateLimiter->ReportThrottled();
+	}
+
+	if (RecordRecipientResults(*job, result, recipientResults))
+	{
+		queue.push_front(std::move(job));
+		return;
+	}
+
+	EmailSender &sender(*job->sender);
+	sender.lastResult = job->failed ? job->failure : result;
+	if (!sender.lastResult.success)
+		sender.outStream << "Failed sending e-mail:  " << sender.lastResult.description << std::endl;
+
+	if (job->callback)
+		job->callback(sender.lastResult, sender.recipientResults);
+	engine.JobComplete();
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		CloseSession
+//
+// Description:		Closes the connection and destroys the session.
+//
+// Input Arguments:
+//		session	= Session&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Loop::CloseSession(Session &session)
+{
+	ClearTimer(session);
+	if (session.socket != CURL_SOCKET_BAD)
+	{
+		epoll_ctl(epollFd, EPOLL_CTL_DEL, session.socket, nullptr);
+		sessionsBySocket.erase(session.socket);
+	}
+
+	session.tls.reset();
+	CURL *curl(session.curl);
+	curl_multi_remove_handle(multi, curl);
+	curl_easy_cleanup(curl);
+	sessions.erase(curl);
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		Watch
+//
+// Description:		Updates the events watched for the session's socket.
+//					Writability is only watched while there is output (or
+//					while TLS needs to write).
+//
+// Input Arguments:
+//		session	= Session&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Loop::Watch(Session &session)
+{
+	const bool watchWrite(!session.protocol->GetOutput().empty() || (session.tls && session.tls->WantsWrite()));
+	if (session.registered && watchWrite == session.watchingWrite)
+		return;
+
+	epoll_event event{};
+	event.events = watchWrite ? EPOLLIN | EPOLLOUT : EPOLLIN;
+	event.data.fd = session.socket;
+
+	// libcurl may still have the socket registered from opening the connection
+	if (epoll_ctl(epollFd, EPOLL_CTL_MOD, session.socket, &event) != 0 && errno == ENOENT)
+		epoll_ctl(epollFd, EPOLL_CTL_ADD, session.socket, &event);
+
+	session.registered = true;
+	session.watchingWrite = watchWrite;
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		SetTimer
+//
+// Description:		Sets (or resets) the session's timer.
+//
+// Input Arguments:
+//		session	= Session&
+//		delay	= const Clock::duration&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Loop::SetTimer(Session &session, const Clock::duration &delay)
+{
+	ClearTimer(session);
+	session.timer = timers.emplace(Clock::now() + delay, &session);
+	session.hasTimer = true;
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		ClearTimer
+//
+// Description:		Cancels the session's timer, if set.
+//
+// Input Arguments:
+//		session	= Session&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPEventEngine::Loop::ClearTimer(Session &session)
+{
+	if (!session.hasTimer)
+		return;
+
+	timers.erase(session.timer);
+	session.hasTimer = false;
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		Write (static)
+//
+// Description:		Writes as much of the data as the session's connection
+//					will accept without blocking.
+//
+// Input Arguments:
+//		session	= Session&
+//		data	= const char*
+//		size	= const size_t&
+//
+// Output Arguments:
+//		sent	= size_t&
+//
+// Return Value:
+//		CURLcode
+//
+//==========================================================================
+CURLcode SMTPEventEngine::Loop::Write(Session &session, const char *data, const size_t &size, size_t &sent)
+{
+	if (session.tls)
+		return session.tls->Send(data, size, sent);
+	return curl_easy_send(session.curl, data, size, &sent);
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		Read (static)
+//
+// Description:		Reads whatever data is available on the session's
+//					connection without blocking.
+//
+// Input Arguments:
+//		session		= Session&
+//		size		= const size_t&, size of the buffer
+//
+// Output Arguments:
+//		buffer		= char*
+//		received	= size_t&, zero if the server closed the connection
+//
+// Return Value:
+//		CURLcode
+//
+//==========================================================================
+CURLcode SMTPEventEngine::Loop::Read(Session &session, char *buffer, const size_t &size, size_t &received)
+{
+	if (session.tls)
+		return session.tls->Receive(buffer, size, received);
+	return curl_easy_recv(session.curl, buffer, size, &received);
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		SocketCallback (static)
+//
+// Description:		Called by libcurl to change the events watched for the
+//					sockets of connections which are being opened.  Sockets
+//					which have been taken over by a session are left alone.
+//
+// Input Arguments:
+//		curl	= CURL* (unused)
+//		socket	= curl_socket_t
+//		what	= int
+//		userp	= void*, pointer to the Loop
+//		socketp	= void* (unused)
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		int, zero for success
+//
+//==========================================================================
+int SMTPEventEngine::Loop::SocketCallback(CURL* /*curl*/, curl_socket_t socket, int what, void *userp, void* /*socketp*/)
+{
+	Loop &loop(*static_cast<Loop*>(userp));
+	if (loop.sessionsBySocket.find(socket) != loop.sessionsBySocket.end())
+		return 0;
+
+	if (what == CURL_POLL_REMOVE)
+	{
+		epoll_ctl(loop.epollFd, EPOLL_CTL_DEL, socket, nullptr);
+		return 0;
+	}
+
+	epoll_event event{};
+	event.data.fd = socket;
+	if (what & CURL_POLL_IN)
+		event.events |= EPOLLIN;
+	if (what & CURL_POLL_OUT)
+		event.events |= EPOLLOUT;
+
+	if (epoll_ctl(loop.epollFd, EPOLL_CTL_MOD, socket, &event) != 0 && errno == ENOENT)
+		epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, socket, &event);
+
+	return 0;
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		TimerCallback (static)
+//
+// Description:		Called by libcurl to set the time at which it next needs
+//					to act on its own (i.e. connection timeouts).
+//
+// Input Arguments:
+//		multi		= CURLM* (unused)
+//		timeoutMs	= long, -1 to cancel the timer
+//		userp		= void*, pointer to the Loop
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		int, zero for success
+//
+//==========================================================================
+int SMTPEventEngine::Loop::TimerCallback(CURLM* /*multi*/, long timeoutMs, void *userp)
+{
+	Loop &loop(*static_cast<Loop*>(userp));
+	loop.hasCurlTimer = timeoutMs >= 0;
+	if (loop.hasCurlTimer)
+		loop.curlDeadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+	return 0;
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		WasDropped (static)
+//
+// Description:		Checks to see if a message failed because the server
+//					closed a connection which had already been used (i.e.
+//					idle timeout) before replying to any part of the
+//					transaction.
+//
+// Input Arguments:
+//		session				= const Session&
+//		result				= const SendResult&
+//		recipientResults	= const std::vector<SMTPProtocol::RecipientResult>&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool
+//
+//==========================================================================
+bool SMTPEventEngine::Loop::WasDropped(const Session &session, const SendResult &result,
+	const std::vector<SMTPProtocol::RecipientResult> &recipientResults)
+{
+	const bool noReplies(std::none_of(recipientResults.begin(), recipientResults.end(),
+		[](const SMTPProtocol::RecipientResult &r)
+	{
+		return r.reply.code != 0;
+	}));
+
+	return session.completedCount > 0 && noReplies && (result.responseCode == 421 ||
+		result.curlCode == CURLE_SEND_ERROR ||
+		result.curlCode == CURLE_RECV_ERROR ||
+		result.curlCode == CURLE_GOT_NOTHING);
+}
+
+//==========================================================================
+// Class:			SMTPEventEngine::Loop
+// Function:		RecordRecipientResults (static)
+//
+// Description:		Records the reply to each recipient of the job's last
+//					transaction and removes them from the recipients still
+//					to be sent to.  Recipients refused because the
+//					transaction had too many are kept, and the next
+//					transaction is limited to the number accepted.
+//
+// Input Arguments:
+//		job					= Job&
+//		result				= const SendResult&, result of the transaction
+//		recipientResults	= const std::vector<SMTPProtocol::RecipientResult>&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true if there are recipients left to send to, false if the
+//		message is complete (including when the failure was not specific to
+//		these recipients, i.e. the connection failed)
+//
+//==========================================================================
+bool SMTPEventEngine::Loop::RecordRecipientResults(Job &job, const SendResult &result,
+	const std::vector<SMTPProtocol::RecipientResult> &recipientResults)
+{
+	if (recipientResults.size() != job.count || std::none_of(recipientResults.begin(), recipientResults.end(),
+		[](const SMTPProtocol::RecipientResult &r)
+	{
+		return r.reply.code != 0;
+	}))
+		return false;
+
+	const bool anyAccepted(std::any_of(recipientResults.begin(), recipientResults.end(),
+		[](const SMTPProtocol::RecipientResult &r)
+	{
+		return r.reply.IsPositive();
+	}));
+
+	std::vector<SMTPProtocol::RecipientResult> &senderResults(job.sender->recipientResults);
+	std::vector<size_t> next;
+	size_t i;
+	for (i = 0; i < job.count; ++i)
+	{
+		const SMTPProtocol::Reply &reply(recipientResults[i].reply);
+		if (reply.code == 452 && anyAccepted)
+			next.push_back(job.remaining[i]);
+		else if (reply.IsPositive() && !result.success)// Recipient was accepted, but the message was not
+		{
+			senderResults[job.remaining[i]].reply.code = static_cast<int>(result.responseCode);
+			senderResults[job.remaining[i]].reply.text = result.description;
+		}
+		else
+			senderResults[job.remaining[i]].reply = reply;
+	}
+
+	if (!next.empty())
+		job.limit = job.count - next.size();
+
+	next.insert(next.end(), job.remaining.begin() + job.count, job.remaining.end());
+	job.remaining.swap(next);
+	return !job.remaining.empty();
+}
+
+#endif// __linux__
@@ -0,0 +1,194 @@
+// File:  smtpEventEngine.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Sends many messages over many concurrent SMTP connections, with each
+//        thread servicing hundreds of connections through epoll (Linux only).
+
+#ifndef SMTP_EVENT_ENGINE_H_
+#define SMTP_EVENT_ENGINE_H_
+
+#ifdef __linux__
+
+// Local headers
+#include "emailSender.h"
+#include "sendResult.h"
+#include "smtpProtocol.h"
+#include "tlsConnection.h"
+
+// cURL headers
+#include <curl/curl.h>
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <deque>
+#include <map>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// Messages are spread over a number of event loops (by default one per
+// core, each on its own thread and pinned to its core).  Each loop opens up
+// to sessionsPerLoop connections to the login's server and sends queued
+// messages over them one after the other, driving each connection with its
+// own SMTPProtocol and non-blocking reads and writes.  libcurl's multi
+// interface is used (through the same epoll instance) only to open the
+// connections.  Body data is written to the socket directly from the
+// protocol engine's buffer.  Connections which need STARTTLS perform the
+// TLS handshake through the same loop, without blocking.  Long recipient
+// lists are split over several transactions (on the same connection, when
+// it stays open) in the same way as EmailSender::Send(SMTPClient&), and
+// the completion callback receives the reply for each recipient.
+//
+// Add() and Wait() may be called from any thread.  Completion callbacks are
+// called from the loop's thread.  The destructor waits for all messages to
+// be sent.
+class SMTPEventEngine
+{
+public:
+	typedef std::function<void(const SendResult &result,
+		const std::vector<SMTPProtocol::RecipientResult> &recipientResults)> CompletionCallback;
+
+	struct Options
+	{
+		unsigned int loopCount = 0;// Zero for one per core
+		unsigned int sessionsPerLoop = 256;
+		unsigned int timeoutSeconds = 300;// Maximum time to wait for the server
+		size_t chunkSize = 65536;// Maximum BDAT chunk size
+	};
+
+	SMTPEventEngine(const EmailSender::LoginInfo &loginInfo, const bool &testMode,
+		UString::OStream &outStream = Cout) : SMTPEventEngine(loginInfo, testMode, Options(), outStream) {}
+	SMTPEventEngine(const EmailSender::LoginInfo &loginInfo, const bool &testMode,
+		const Options &options, UString::OStream &outStream = Cout);
+	~SMTPEventEngine();
+
+	SMTPEventEngine(const SMTPEventEngine&) = delete;
+	SMTPEventEngine& operator=(const SMTPEventEngine&) = delete;
+
+	void Add(std::unique_ptr<EmailSender> sender, CompletionCallback callback = CompletionCallback());
+	void Wait();
+
+	size_t GetLoopCount() const { return loops.size(); }
+
+private:
+	struct Job
+	{
+		std::unique_ptr<EmailSender> sender;
+		CompletionCallback callback;
+		unsigned int attempts = 0;
+
+		std::vector<size_t> remaining;// Recipients not yet sent to
+		size_t limit = 0;// Recipients per transaction (zero for no limit)
+		size_t count = 0;// Recipients in the current transaction
+		bool failed = false;// Set when any transaction fails
+		SendResult failure;// Result of the first failed transaction
+	};
+
+	typedef std::chrono::steady_clock Clock;
+
+	struct Session
+	{
+		CURL *curl = nullptr;
+		curl_socket_t socket = CURL_SOCKET_BAD;
+		std::unique_ptr<SMTPProtocol> protocol;
+		std::string domain;
+		std::string startTLSHost;// Empty if STARTTLS is not used
+		std::unique_ptr<TLSConnection> tls;
+		bool handshaking = false;
+
+		std::unique_ptr<Job> job;
+		bool transactionStarted = false;
+		unsigned int completedCount = 0;
+
+		bool registered = false;// Socket has been taken over from libcurl
+		bool watchingWrite = false;
+		bool held = false;// Waiting for the rate limiter (rather than for the server)
+		bool hasTimer = false;
+		std::multimap<Clock::time_point, Session*>::iterator timer;
+	};
+
+	class Loop
+	{
+	public:
+		Loop(SMTPEventEngine &engine, const unsigned int &index);
+		~Loop();
+
+		void Add(std::unique_ptr<Job> job);
+
+	private:
+		SMTPEventEngine &engine;
+		int epollFd;
+		int wakeupFd;
+		CURLM *multi;
+
+		std::mutex mutex;
+		std::deque<std::unique_ptr<Job>> incoming;
+		bool stopping = false;
+
+		// Only accessed from the loop's thread
+		std::deque<std::unique_ptr<Job>> queue;
+		std::map<CURL*, std::unique_ptr<Session>> sessions;
+		std::map<curl_socket_t, Session*> sessionsBySocket;
+		std::multimap<Clock::time_point, Session*> timers;
+		bool hasCurlTimer = false;
+		Clock::time_point curlDeadline;
+		std::shared_ptr<SSL_CTX> tlsContext;
+
+		std::thread thread;
+
+		void Run();
+		bool TakeIncoming();
+		int GetWaitTime() const;
+		void ProcessCurl(const curl_socket_t &socket, const int &flags);
+		void ProcessTimers();
+
+		void OpenSessions();
+		bool OpenSession(std::unique_ptr<Job> job);
+		void Connected(CURL *curl, const CURLcode &result);
+		void Service(Session &session);
+		bool CheckIdle(Session &session);
+		void Advance(Session &session);
+		void StartTLS(Session &session);
+		bool ContinueTLS(Session &session);
+		bool StartTransaction(Session &session);
+		void Fail(Session &session, const CURLcode &result);
+		void Finish(Session &session, const SendResult &result);
+		void CloseSession(Session &session);
+
+		void Watch(Session &session);
+		void SetTimer(Session &session, const Clock::duration &delay);
+		void ClearTimer(Session &session);
+
+		static CURLcode Write(Session &session, const char *data, const size_t &size, size_t &sent);
+		static CURLcode Read(Session &session, char *buffer, const size_t &size, size_t &received);
+		static int SocketCallback(CURL *curl, curl_socket_t socket, int what, void *userp, void *socketp);
+		static int TimerCallback(CURLM *multi, long timeoutMs, void *userp);
+		static bool WasDropped(const Session &session, const SendResult &result,
+			const std::vector<SMTPProtocol::RecipientResult> &recipientResults);
+		static bool RecordRecipientResults(Job &job, const SendResult &result,
+			const std::vector<SMTPProtocol::RecipientResult> &recipientResults);
+	};
+
+	const EmailSender::LoginInfo loginInfo;
+	const bool testMode;
+	const Options options;
+	UString::OStream &outStream;
+
+	std::vector<std::unique_ptr<Loop>> loops;
+	std::atomic<size_t> nextLoop;
+
+	std::mutex outstandingMutex;
+	std::condition_variable outstandingCondition;
+	size_t outstanding = 0;
+
+	void JobComplete();
+};
+
+#endif// __linux__
+
+#endif// SMTP_EVENT_ENGINE_H_
@@ -0,0 +1,1029 @@
+// File:  smtpProtocol.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  SMTP client protocol engine (RFC 5321) with support for PIPELINING,
+//        CHUNKING (BDAT) and SIZE.  Performs no I/O of its own.
+
+// Local headers
+#include "smtpProtocol.h"
+#include "lineScanner.h"
+#include "base64.h"
+
+// Standard C++ headers
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+
+namespace
+{
+	bool IsDigit(const char &c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	std::string ToUpper(const std::string_view &s)
+	{
+		std::string upper(s);
+		std::transform(upper.begin(), upper.end(), upper.begin(), [](const unsigned char &c)
+		{
+			return static_cast<char>(toupper(c));
+		});
+		return upper;
+	}
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		SMTPProtocol
+//
+// Description:		Constructor for SMTPProtocol class.  The engine begins by
+//					waiting for the server's greeting.
+//
+// Input Arguments:
+//		settings	= const Settings&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+SMTPProtocol::SMTPProtocol(const Settings &settings) : settings(settings)
+{
+	awaiting.push_back(Command::Greeting);
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		Receive
+//
+// Description:		Processes data read from the server.  Data may be passed
+//					in pieces of any size; each complete reply is handled as
+//					soon as its last line arrives.
+//
+// Input Arguments:
+//		data	= const char*
+//		size	= const size_t&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::Receive(const char *data, const size_t &size)
+{
+	input.append(data, size);
+	const size_t end(input.rfind('\n'));
+	if (end == std::string::npos)
+		return;
+
+	LineScanner scanner(std::string_view(input.data(), end + 1));
+	std::string_view line;
+	while (state != State::Closed && state != State::Failed && state != State::StartingTLS && scanner.Next(line))
+	{
+		if (line.size() < 3 || !IsDigit(line[0]) || !IsDigit(line[1]) || !IsDigit(line[2]) ||
+			(line.size() > 3 && line[3] != ' ' && line[3] != '-'))
+		{
+			lastReply.code = 0;
+			lastReply.text.assign(line);
+			Fail();
+			break;
+		}
+
+		if (currentReply.code != 0)
+			currentReply.text.push_back('\n');
+		currentReply.code = (line[0] - '0') * 100 + (line[1] - '0') * 10 + line[2] - '0';
+		if (line.size() > 4)
+			currentReply.text.append(line.substr(4));
+
+		if (line.size() == 3 || line[3] == ' ')
+		{
+			const Reply reply(std::move(currentReply));
+			currentReply = Reply();
+			HandleReply(reply);
+		}
+	}
+
+	// Data which follows the reply to STARTTLS was not protected by TLS, so
+	// it must not be treated as part of the encrypted session
+	if (state == State::StartingTLS && (scanner.Next(line) || input.size() > end + 1))
+		FailUnprotectedInput();
+
+	input.erase(0, end + 1);
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		GetOutput
+//
+// Description:		Returns the data waiting to be written to the server.
+//					When the previous output has been consumed, the next
+//					portion of the message body is read from the payload.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string_view, empty if there is nothing to write
+//
+//==========================================================================
+std::string_view SMTPProtocol::GetOutput()
+{
+	if (outputPosition == output.size())
+	{
+		output.clear();
+		outputPosition = 0;
+	}
+
+	if (output.empty() && chunkPosition == chunk.size())
+	{
+		chunk.clear();
+		chunkPosition = 0;
+
+		// Without PIPELINING, each BDAT chunk waits for the previous reply
+		if (sendingBody && (extensions.pipelining || awaiting.empty()))
+			ProduceBody();
+	}
+
+	// Body data is returned directly from the chunk buffer, after any
+	// command which precedes it
+	if (!output.empty())
+		return std::string_view(output).substr(outputPosition);
+	return std::string_view(chunk).substr(chunkPosition);
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		Consume
+//
+// Description:		Removes data which has been written to the server from
+//					the output.
+//
+// Input Arguments:
+//		count	= const size_t&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::Consume(const size_t &count)
+{
+	if (!output.empty())
+		outputPosition = std::min(outputPosition + count, output.size());
+	else
+		chunkPosition = std::min(chunkPosition + count, chunk.size());
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		IsBusy
+//
+// Description:		Checks to see if the engine is in the middle of an
+//					exchange with the server.  The engine is not busy while
+//					it waits for the owner to start TLS.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool
+//
+//==========================================================================
+bool SMTPProtocol::IsBusy() const
+{
+	return state != State::Ready && state != State::StartingTLS && state != State::Closed && state != State::Failed;
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		BeginTransaction
+//
+// Description:		Queues the envelope for a new message.  If the server
+//					declared a SIZE limit and the message exceeds it, the
+//					message is rejected here (with a 552 transaction reply)
+//					instead of after it has been transferred.  When the
+//					server supports SIZE, the payload is read once to find
+//					the size of the message with canonical line endings
+//					(which excludes doubled periods, per RFC 1870).  The
+//					payload is rewound for sending; if it can not be, the
+//					transaction is not started (with no transaction reply
+//					code).
+//
+// Input Arguments:
+//		from		= const std::string&
+//		recipients	= const std::vector<std::string>&
+//		payload		= PayloadReader&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true if the transaction was started, false otherwise
+//
+//==========================================================================
+bool SMTPProtocol::BeginTransaction(const std::string &from, const std::vector<std::string> &recipients,
+	PayloadReader &payload)
+{
+	if (state != State::Ready)
+		return false;
+
+	failed = false;
+	transactionSucceeded = false;
+	transactionReply = Reply();
+	recipientResults.clear();
+	recipientResults.reserve(recipients.size());
+	for (const auto& r : recipients)
+		recipientResults.push_back({ r, Reply() });
+	recipientRepliesReceived = 0;
+
+	// The declared size must include the line endings added while sending
+	// (but not periods doubled for DATA, as defined for SIZE by RFC 1870)
+	size_t size(payload.GetSize());
+	if ((extensions.size && !payload.GetCanonicalSize(size)) || !payload.Rewind())
+	{
+		transactionReply.text = "Failed to rewind the message";
+		return false;
+	}
+
+	if (extensions.maxSize > 0 && size > extensions.maxSize)
+	{
+		transactionReply.code = 552;
+		transactionReply.text = "Message size (" + std::to_string(size) +
+			" bytes) exceeds the server's limit of " + std::to_string(extensions.maxSize) + " bytes";
+		return false;
+	}
+
+	this->payload = &payload;
+	state = State::Transaction;
+
+	std::string mailFrom("MAIL FROM:<" + from + ">");
+	if (extensions.size)
+		mailFrom.append(" SIZE=" + std::to_string(size));
+	Queue(Command::Mail, mailFrom + "\r\n");
+
+	for (const auto& r : recipients)
+		Queue(Command::Rcpt, "RCPT TO:<" + r + ">\r\n");
+
+	useChunking = extensions.chunking;
+	bodyPending = true;
+	if (!useChunking)
+		Queue(Command::Data, "DATA\r\n");
+	else if (extensions.pipelining && payload.GetSize() <= settings.chunkSize)
+	{
+		// The whole body fits in one chunk, so it is sent with the envelope
+		// instead of waiting for the RCPT replies
+		FlushCommands();
+		BeginBody();
+	}
+
+	FlushCommands();
+	return true;
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		Quit
+//
+// Description:		Ends the session.  If the engine is idle, QUIT is sent;
+//					otherwise the session is simply abandoned.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::Quit()
+{
+	if (state == State::Ready)
+	{
+		state = State::Quitting;
+		Queue(Command::Quit, "QUIT\r\n");
+		FlushCommands();
+	}
+	else if (state != State::Failed)
+		state = State::Closed;
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		TLSStarted
+//
+// Description:		Continues the session once the owner has completed the
+//					TLS handshake.  The server has forgotten everything it
+//					learned before the upgrade, so EHLO is sent again.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::TLSStarted()
+{
+	if (state != State::StartingTLS)
+		return;
+
+	if (!input.empty())
+	{
+		FailUnprotectedInput();
+		return;
+	}
+
+	tlsActive = true;
+	SendHello();
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		HandleReply
+//
+// Description:		Matches a reply to the command which produced it and
+//					advances the session.
+//
+// Input Arguments:
+//		reply	= const Reply&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::HandleReply(const Reply &reply)
+{
+	lastReply = reply;
+
+	// An unsolicited reply is always the server closing the connection
+	// (i.e. 421 after an idle timeout)
+	if (awaiting.empty())
+	{
+		Fail();
+		return;
+	}
+
+	const Command command(awaiting.front());
+	awaiting.pop_front();
+
+	if (reply.code == 421 && command != Command::Quit)
+	{
+		Fail();
+		return;
+	}
+
+	switch (command)
+	{
+	case Command::Greeting:
+		if (reply.code == 220)
+			SendHello();
+		else
+			Fail();
+		break;
+
+	case Command::Ehlo:
+		if (reply.IsPositive())
+		{
+			ParseExtensions(reply.text);
+			if (settings.startTLS && !tlsActive)
+				SendStartTLS();
+			else
+				SendAuthentication();
+		}
+		else if (reply.code == 500 || reply.code == 502)
+			Queue(Command::Helo, "HELO " + settings.domain + "\r\n");
+		else
+			Fail();
+		break;
+
+	case Command::Helo:
+		if (!reply.IsPositive())
+			Fail();
+		else if (settings.startTLS && !tlsActive)
+			SendStartTLS();// Fails, since there are no extensions without EHLO
+		else
+			SendAuthentication();
+		break;
+
+	case Command::StartTLS:
+		if (reply.code == 220)
+			state = State::StartingTLS;
+		else
+		{
+			tlsRefused = true;
+			Fail();
+		}
+		break;
+
+	case Command::Auth:
+		if (reply.code == 235)
+			state = State::Ready;
+		else if (reply.code == 334)// XOAUTH2 error details; the server replies 535 once the exchange is cancelled
+			Queue(Command::AuthCancel, "\r\n");
+		else
+			Fail();
+		break;
+
+	case Command::AuthCancel:
+		Fail();
+		break;
+
+	case Command::Mail:
+		if (!reply.IsPositive())
+		{
+			RejectTransaction(reply);
+			pending.clear();
+		}
+		break;
+
+	case Command::Rcpt:
+		recipientResults[recipientRepliesReceived++].reply = reply;
+		if (recipientRepliesReceived == recipientResults.size() && !HasAcceptedRecipient())
+		{
+			RejectTransaction(reply);
+			pending.clear();
+		}
+		break;
+
+	case Command::Data:
+		bodyPending = false;
+		if (reply.code != 354)
+			RejectTransaction(reply);
+		else if (failed)
+		{
+			// Should not happen, but the server is waiting for the body
+			output.append(".\r\n");
+			awaiting.push_back(Command::EndOfData);
+		}
+		else
+			BeginBody();
+		break;
+
+	case Command::BodyChunk:
+		if (!reply.IsPositive())
+		{
+			RejectTransaction(reply);
+			sendingBody = false;
+		}
+		break;
+
+	case Command::EndOfData:
+		if (reply.IsPositive())
+		{
+			if (!failed)
+				transactionReply = reply;
+		}
+		else
+			RejectTransaction(reply);
+		break;
+
+	case Command::Rset:
+		if (reply.IsPositive())
+			state = State::Ready;
+		else
+			Fail();
+		break;
+
+	case Command::Quit:
+		state = State::Closed;
+		break;
+	}
+
+	FlushCommands();
+
+	if (state == State::Transaction && awaiting.empty() && pending.empty() && !sendingBody)
+	{
+		// With CHUNKING, the body is sent once the envelope is accepted
+		if (!failed && bodyPending && useChunking)
+			BeginBody();
+		else
+			FinishTransaction();
+	}
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		Fail
+//
+// Description:		Abandons the session.  The owner should close the
+//					connection.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::Fail()
+{
+	if (state == State::Transaction)
+		RejectTransaction(lastReply);
+
+	state = State::Failed;
+	pending.clear();
+	awaiting.clear();
+	output.clear();
+	outputPosition = 0;
+	chunk.clear();
+	chunkPosition = 0;
+	sendingBody = false;
+	payload = nullptr;
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		FailUnprotectedInput
+//
+// Description:		Abandons the session because the server sent data
+//					between agreeing to STARTTLS and the TLS handshake.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::FailUnprotectedInput()
+{
+	lastReply.code = 0;
+	lastReply.text = "Unexpected data after the reply to STARTTLS";
+	Fail();
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		RejectTransaction
+//
+// Description:		Marks the current transaction as failed.  Only the first
+//					negative reply is kept, since later replies in the same
+//					pipeline are usually consequences of it.
+//
+// Input Arguments:
+//		reply	= const Reply&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::RejectTransaction(const Reply &reply)
+{
+	if (failed)
+		return;
+
+	failed = true;
+	transactionReply = reply;
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		SendHello
+//
+// Description:		Queues EHLO.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::SendHello()
+{
+	state = State::Hello;
+	extensions = Extensions();
+	Queue(Command::Ehlo, "EHLO " + settings.domain + "\r\n");
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		SendStartTLS
+//
+// Description:		Queues STARTTLS, or fails if the server did not offer it.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::SendStartTLS()
+{
+	if (!extensions.startTLS)
+	{
+		tlsRefused = true;
+		lastReply.code = 0;
+		lastReply.text = "Server does not support STARTTLS";
+		Fail();
+		return;
+	}
+
+	Queue(Command::StartTLS, "STARTTLS\r\n");
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		SendAuthentication
+//
+// Description:		Queues AUTH with the configured mechanism, if any.  The
+//					initial response is included with the command, so
+//					authentication takes a single round trip.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::SendAuthentication()
+{
+	std::string command;
+	switch (settings.authentication)
+	{
+	case Authentication::None:
+		state = State::Ready;
+		return;
+
+	case Authentication::Plain:
+		command = "AUTH PLAIN " + Base64::Encode(std::string(1, '\0') + settings.userName +
+			std::string(1, '\0') + settings.secret, false);
+		break;
+
+	case Authentication::XOAuth2:
+		command = "AUTH XOAUTH2 " + Base64::Encode("user=" + settings.userName +
+			"\x01" "auth=Bearer " + settings.secret + "\x01\x01", false);
+		break;
+	}
+
+	state = State::Authenticating;
+	Queue(Command::Auth, command + "\r\n");
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		ParseExtensions
+//
+// Description:		Reads the extensions listed in the reply to EHLO.  The
+//					first line is the server's name and is skipped.
+//
+// Input Arguments:
+//		text	= const std::string&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::ParseExtensions(const std::string &text)
+{
+	LineScanner scanner(text);
+	std::string_view line;
+	scanner.Next(line);
+
+	while (scanner.Next(line))
+	{
+		const size_t space(line.find(' '));
+		const std::string keyword(ToUpper(line.substr(0, space)));
+		const std::string_view parameters(space == std::string_view::npos ? std::string_view() : line.substr(space + 1));
+
+		if (keyword == "PIPELINING")
+			extensions.pipelining = true;
+		else if (keyword == "CHUNKING")
+			extensions.chunking = true;
+		else if (keyword == "STARTTLS")
+			extensions.startTLS = true;
+		else if (keyword == "SIZE")
+		{
+			extensions.size = true;
+			extensions.maxSize = static_cast<size_t>(strtoull(std::string(parameters).c_str(), nullptr, 10));
+		}
+		else if (keyword == "AUTH")
+		{
+			size_t start(0);
+			while (start < parameters.size())
+			{
+				const size_t end(std::min(parameters.find(' ', start), parameters.size()));
+				if (end > start)
+					extensions.authMechanisms.push_back(ToUpper(parameters.substr(start, end - start)));
+				start = end + 1;
+			}
+		}
+		else if (keyword == "LIMITS")
+		{
+			// i.e. "LIMITS RCPTMAX=100 MAILMAX=1000"
+			size_t start(0);
+			while (start < parameters.size())
+			{
+				const size_t end(std::min(parameters.find(' ', start), parameters.size()));
+				const std::string limit(ToUpper(parameters.substr(start, end - start)));
+				if (limit.compare(0, 8, "RCPTMAX=") == 0)
+					extensions.maxRecipients = static_cast<size_t>(strtoull(limit.c_str() + 8, nullptr, 10));
+				start = end + 1;
+			}
+		}
+	}
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		Queue
+//
+// Description:		Adds a command to the queue and writes as much of the
+//					queue as the server's capabilities allow.
+//
+// Input Arguments:
+//		command	= const Command&
+//		text	= std::string, including the line terminator
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::Queue(const Command &command, std::string text)
+{
+	pending.push_back({ command, std::move(text) });
+	FlushCommands();
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		FlushCommands
+//
+// Description:		Moves queued commands to the output.  With PIPELINING,
+//					every queued command is written at once; otherwise each
+//					command waits for the reply to the previous one.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::FlushCommands()
+{
+	while (!pending.empty() && (extensions.pipelining || awaiting.empty()))
+	{
+		output.append(pending.front().text);
+		awaiting.push_back(pending.front().command);
+		pending.pop_front();
+	}
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		HasAcceptedRecipient
+//
+// Description:		Checks to see if the server accepted any of the current
+//					transaction's recipients.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool
+//
+//==========================================================================
+bool SMTPProtocol::HasAcceptedRecipient() const
+{
+	return std::any_of(recipientResults.begin(), recipientResults.end(), [](const RecipientResult &r)
+	{
+		return r.reply.IsPositive();
+	});
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		BeginBody
+//
+// Description:		Prepares to send the message body.  The payload was
+//					rewound by BeginTransaction().
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::BeginBody()
+{
+	bodyPending = false;
+	sendingBody = true;
+	bodyRemaining = payload->GetSize();
+	atLineStart = true;
+	previousCR = false;
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		ProduceBody
+//
+// Description:		Writes the next portion of the body to the output.  With
+//					CHUNKING this is one BDAT command and its data; otherwise
+//					it is dot-stuffed DATA content, followed by the
+//					terminating "." after the last portion.  The data is
+//					left in the chunk buffer, which GetOutput() returns
+//					directly.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::ProduceBody()
+{
+	ReadBody(chunk, !useChunking);
+	const bool last(bodyRemaining == 0);
+	if (last && !atLineStart)
+		chunk.append("\r\n");
+
+	if (useChunking)
+	{
+		output.append("BDAT " + std::to_string(chunk.size()) + (last ? " LAST\r\n" : "\r\n"));
+		awaiting.push_back(last ? Command::EndOfData : Command::BodyChunk);
+	}
+	else if (last)
+	{
+		chunk.append(".\r\n");
+		awaiting.push_back(Command::EndOfData);
+	}
+
+	if (last)
+		sendingBody = false;
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		ReadBody
+//
+// Description:		Reads up to one chunk of the payload and appends it with
+//					canonical line endings.
+//
+// Input Arguments:
+//		dotStuff	= const bool&
+//
+// Output Arguments:
+//		out			= std::string&
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::ReadBody(std::string &out, const bool &dotStuff)
+{
+	const size_t length(std::min(bodyRemaining, settings.chunkSize));
+	bodyBuffer.resize(length);
+	const size_t read(length > 0 ? payload->Read(&bodyBuffer[0], length) : 0);
+	if (read == 0)
+		bodyRemaining = 0;// Source was shorter than its reported size
+	else
+		bodyRemaining -= read;
+
+	AppendCanonical(bodyBuffer.data(), read, out, dotStuff);
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		AppendCanonical
+//
+// Description:		Appends text, writing bare "\n" line endings as "\r\n"
+//					and (if required) doubling periods at the start of lines.
+//					Line ends are found with memchr() and the text between
+//					them is copied in bulk.  State is kept between calls, so
+//					the body may be processed in pieces.
+//
+// Input Arguments:
+//		data		= const char*
+//		size		= const size_t&
+//		dotStuff	= const bool&
+//
+// Output Arguments:
+//		out			= std::string&
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::AppendCanonical(const char *data, const size_t &size, std::string &out, const bool &dotStuff)
+{
+	out.reserve(out.size() + size + size / 32);
+
+	size_t i(0);
+	while (i < size)
+	{
+		if (atLineStart && dotStuff && data[i] == '.')
+			out.push_back('.');
+
+		const char *newLine(static_cast<const char*>(memchr(data + i, '\n', size - i)));
+		const size_t end(newLine ? static_cast<size_t>(newLine - data) : size);
+		if (end > i)
+		{
+			out.append(data + i, end - i);
+			previousCR = data[end - 1] == '\r';
+			atLineStart = false;
+		}
+
+		if (!newLine)
+			break;
+
+		if (!previousCR)
+			out.push_back('\r');
+		out.push_back('\n');
+		previousCR = false;
+		atLineStart = true;
+		i = end + 1;
+	}
+}
+
+//==========================================================================
+// Class:			SMTPProtocol
+// Function:		FinishTransaction
+//
+// Description:		Records the outcome of the transaction.  After a failure,
+//					RSET is sent so the next transaction starts cleanly.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPProtocol::FinishTransaction()
+{
+	transactionSucceeded = !failed && transactionReply.IsPositive();
+	payload = nullptr;
+
+	if (transactionSucceeded)
+		state = State::Ready;
+	else
+	{
+		state = State::Resetting;
+		Queue(Command::Rset, "RSET\r\n");
+	}
+}
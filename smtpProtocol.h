@@ -0,0 +1,210 @@
+// File:  smtpProtocol.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  SMTP client protocol engine (RFC 5321) with support for PIPELINING,
+//        CHUNKING (BDAT) and SIZE.  Performs no I/O of its own.
+
+#ifndef SMTP_PROTOCOL_H_
+#define SMTP_PROTOCOL_H_
+
+// Local headers
+#include "payloadReader.h"
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+#include <deque>
+#include <string_view>
+#include <cstddef>
+
+// The owner moves bytes between the connection and the engine:  everything
+// read from the server is passed to Receive(), and whatever GetOutput()
+// returns is written to the server (followed by a call to Consume() with
+// the number of bytes actually written).  The engine is idle (IsBusy()
+// returns false) once it is waiting for the owner to start a transaction,
+// or when the connection is finished.
+//
+// If the settings require STARTTLS (RFC 3207), the engine sends it after
+// EHLO and stops in the StartingTLS state once the server agrees.  The
+// owner then performs the TLS handshake, passes all further data through
+// the TLS connection and calls TLSStarted(), which sends EHLO again.  The
+// session fails if the server does not offer STARTTLS.
+//
+// With PIPELINING, MAIL FROM, every RCPT TO and DATA are written together.
+// With CHUNKING, bodies which fit in one chunk are also written with the
+// envelope (as "BDAT <size> LAST"), so the complete transaction costs a
+// single round trip; larger bodies are sent in chunks once at least one
+// recipient has been accepted.  Without CHUNKING the body is dot-stuffed
+// and sent with DATA.  In both cases bare "\n" line endings in the payload
+// are written as "\r\n".
+class SMTPProtocol
+{
+public:
+	enum class Authentication
+	{
+		None,
+		Plain,
+		XOAuth2
+	};
+
+	struct Settings
+	{
+		std::string domain;// Sent with EHLO
+		std::string userName;
+		std::string secret;// Password or access token, according to authentication
+		Authentication authentication = Authentication::None;
+		bool startTLS = false;// Upgrade the connection with STARTTLS before authenticating
+		size_t chunkSize = 65536;// Maximum BDAT chunk size
+	};
+
+	struct Extensions
+	{
+		bool pipelining = false;
+		bool chunking = false;
+		bool size = false;
+		bool startTLS = false;
+		size_t maxSize = 0;// Zero if the server declared no limit
+		size_t maxRecipients = 0;// From LIMITS RCPTMAX (RFC 9422); zero if the server declared no limit
+		std::vector<std::string> authMechanisms;
+	};
+
+	struct Reply
+	{
+		int code = 0;// Zero if no reply was received
+		std::string text;// One line per line of the reply, without the codes
+
+		bool IsPositive() const { return code >= 200 && code < 300; }
+	};
+
+	struct RecipientResult
+	{
+		std::string address;
+		Reply reply;
+	};
+
+	enum class State
+	{
+		Greeting,
+		Hello,
+		StartingTLS,// Waiting for the owner to perform the TLS handshake
+		Authenticating,
+		Ready,
+		Transaction,
+		Resetting,
+		Quitting,
+		Closed,
+		Failed
+	};
+
+	explicit SMTPProtocol(const Settings &settings);
+
+	void Receive(const char *data, const size_t &size);
+	std::string_view GetOutput();
+	void Consume(const size_t &count);
+
+	State GetState() const { return state; }
+	bool IsBusy() const;
+
+	// Only valid when the state is Ready.  The payload must remain valid
+	// until the engine is no longer busy.  Returns false if the message was
+	// rejected without contacting the server (i.e. it exceeds the server's
+	// SIZE limit, or the payload could not be rewound).
+	bool BeginTransaction(const std::string &from, const std::vector<std::string> &recipients, PayloadReader &payload);
+	void Quit();
+
+	// Only valid when the state is StartingTLS
+	void TLSStarted();
+
+	const Extensions& GetExtensions() const { return extensions; }
+
+	// Outcome of the last transaction; per-recipient replies are in the same
+	// order as the recipients passed to BeginTransaction()
+	bool TransactionSucceeded() const { return transactionSucceeded; }
+	const Reply& GetTransactionReply() const { return transactionReply; }
+	const std::vector<RecipientResult>& GetRecipientResults() const { return recipientResults; }
+
+	// Last reply received (i.e. the reason for entering the Failed state)
+	const Reply& GetLastReply() const { return lastReply; }
+
+	// True if the session failed because STARTTLS was required but the
+	// server did not offer it (or refused it)
+	bool TLSRefused() const { return tlsRefused; }
+
+private:
+	enum class Command
+	{
+		Greeting,
+		Ehlo,
+		Helo,
+		StartTLS,
+		Auth,
+		AuthCancel,
+		Mail,
+		Rcpt,
+		Data,
+		BodyChunk,
+		EndOfData,
+		Rset,
+		Quit
+	};
+
+	struct PendingCommand
+	{
+		Command command;
+		std::string text;
+	};
+
+	const Settings settings;
+	State state = State::Greeting;
+	Extensions extensions;
+	bool tlsActive = false;
+	bool tlsRefused = false;
+
+	std::string input;
+	Reply currentReply;
+	Reply lastReply;
+
+	std::string output;
+	size_t outputPosition = 0;
+
+	std::deque<PendingCommand> pending;
+	std::deque<Command> awaiting;// Commands which have been written and not yet answered
+	size_t recipientRepliesReceived = 0;
+
+	// Current transaction
+	PayloadReader *payload = nullptr;
+	bool useChunking = false;
+	bool bodyPending = false;// Body has not been started
+	bool sendingBody = false;
+	bool failed = false;
+	bool transactionSucceeded = false;
+	Reply transactionReply;
+	std::vector<RecipientResult> recipientResults;
+	size_t bodyRemaining = 0;
+	bool atLineStart = true;
+	bool previousCR = false;
+	std::string bodyBuffer;// Raw payload data
+	std::string chunk;// Body data with canonical line endings, written after output
+	size_t chunkPosition = 0;
+
+	void HandleReply(const Reply &reply);
+	void Fail();
+	void FailUnprotectedInput();
+	void RejectTransaction(const Reply &reply);
+
+	void SendHello();
+	void SendStartTLS();
+	void SendAuthentication();
+	void ParseExtensions(const std::string &text);
+
+	void Queue(const Command &command, std::string text);
+	void FlushCommands();
+	bool HasAcceptedRecipient() const;
+	void BeginBody();
+	void ProduceBody();
+	void ReadBody(std::string &out, const bool &dotStuff);
+	void AppendCanonical(const char *data, const size_t &size, std::string &out, const bool &dotStuff);
+	void FinishTransaction();
+};
+
+#endif// SMTP_PROTOCOL_H_
@@ -0,0 +1,367 @@
+// File:  smtpSession.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Long-lived SMTP connection which allows many messages to be sent
+//        without repeating the connect/STARTTLS/AUTH handshake for each one.
+
+// Local headers
+#include "smtpSession.h"
+#include "oAuth2Interface.h"
+#include "rateLimiter.h"
+
+// Standard C++ headers
+#include <cstdio>
+
+//==========================================================================
+// Class:			SMTPSession
+// Function:		SMTPSession
+//
+// Description:		Constructor for SMTPSession class.  The connection is not
+//					opened until the first message is sent.
+//
+// Input Arguments:
+//		loginInfo	= const EmailSender::LoginInfo&
+//		testMode	= const bool&
+//		outStream	= UString::OStream&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+SMTPSession::SMTPSession(const EmailSender::LoginInfo &loginInfo, const bool &testMode,
+	UString::OStream &outStream) : loginInfo(loginInfo), testMode(testMode), outStream(outStream)
+{
+}
+
+//==========================================================================
+// Class:			SMTPSession
+// Function:		~SMTPSession
+//
+// Description:		Destructor for SMTPSession class.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+SMTPSession::~SMTPSession()
+{
+	Close();
+}
+
+//==========================================================================
+// Class:			SMTPSession
+// Function:		Close
+//
+// Description:		Closes the connection (if open).  The next call to Send()
+//					will open a new connection.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPSession::Close()
+{
+	if (curl)
+		curl_easy_cleanup(curl);// Sends QUIT if the connection is still alive
+	curl = nullptr;
+}
+
+//==========================================================================
+// Class:			SMTPSession
+// Function:		Initialize
+//
+// Description:		Creates the easy handle and sets the options which remain
+//					constant for the life of the session.  libcurl keeps the
+//					connection in this handle's connection cache between
+//					transfers, so as long as these options do not change,
+//					subsequent messages reuse the authenticated connection.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool SMTPSession::Initialize()
+{
+	curl = curl_easy_init();
+	if (!curl)
+	{
+		outStream << "Failed to initialize CURL" << std::endl;
+		return false;
+	}
+
+	SetConnectionOptions(curl, loginInfo, testMode, disableSignaling);
+	return true;
+}
+
+//==========================================================================
+// Class:			SMTPSession
+// Function:		Send
+//
+// Description:		Sends a single message over the session's connection,
+//					opening it first if necessary.  If the server dropped the
+//					cached connection since the last message (before replying
+//					to anything), the payload is rewound and the message is
+//					sent again over a new connection.  If
+//					the account has a rate limiter, waits for it first.
+//
+// Input Arguments:
+//		recipients		= const std::vector<EmailSender::AddressInfo>&
+//		readFunction	= curl_read_callback
+//		seekFunction	= curl_seek_callback (may be nullptr, in which case
+//						  no reconnect attempt is made)
+//		payloadData		= void*, passed to readFunction and seekFunction
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise (see GetLastResult() for
+//		details)
+//
+//==========================================================================
+bool SMTPSession::Send(const std::vector<EmailSender::AddressInfo> &recipients,
+	curl_read_callback readFunction, curl_seek_callback seekFunction, void *payloadData)
+{
+	if (!curl && !Initialize())
+	{
+		lastResult = SendResult::Make(SendResult::Protocol::SMTP, CURLE_FAILED_INIT, 0);
+		return false;
+	}
+
+	if (loginInfo.rateLimiter && !loginInfo.rateLimiter->Acquire(static_cast<unsigned int>(recipients.size())))
+	{
+		lastResult = SendResult::Deferred("Sending limit reached");
+		outStream << "Failed sending e-mail:  " << lastResult.description << std::endl;
+		return false;
+	}
+
+	CURLcode result(Perform(recipients, readFunction, seekFunction, payloadData));
+	if (IsDroppedConnection(curl, result) && seekFunction &&
+		seekFunction(payloadData, 0, SEEK_SET) == CURL_SEEKFUNC_OK)
+	{
+		if (testMode)
+			outStream << "SMTP connection was dropped by the server; reconnecting" << std::endl;
+
+		curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1L);
+		result = Perform(recipients, readFunction, seekFunction, payloadData);
+		curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 0L);
+	}
+
+	lastResult = SendResult::FromCURL(curl, result, SendResult::Protocol::SMTP);
+	if (!lastResult.success)
+	{
+		outStream << "Failed sending e-mail:  " << lastResult.description << std::endl;
+		if (loginInfo.rateLimiter && IsThrottled(curl))
+			loginInfo.rateLimiter->ReportThrottled();
+	}
+
+	return lastResult.success;
+}
+
+//==========================================================================
+// Class:			SMTPSession
+// Function:		Perform
+//
+// Description:		Sets the per-message options and performs the transfer.
+//
+// Input Arguments:
+//		recipients		= const std::vector<EmailSender::AddressInfo>&
+//		readFunction	= curl_read_callback
+//		seekFunction	= curl_seek_callback
+//		payloadData		= void*
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		CURLcode
+//
+//==========================================================================
+CURLcode SMTPSession::Perform(const std::vector<EmailSender::AddressInfo> &recipients,
+	curl_read_callback readFunction, curl_seek_callback seekFunction, void *payloadData)
+{
+	curl_slist *recipientList(SetMessageOptions(curl, loginInfo, recipients, readFunction, seekFunction, payloadData));
+	const CURLcode result(curl_easy_perform(curl));
+
+	curl_easy_setopt(curl, CURLOPT_MAIL_RCPT, static_cast<curl_slist*>(nullptr));
+	curl_slist_free_all(recipientList);
+
+	return result;
+}
+
+//==========================================================================
+// Class:			SMTPSession
+// Function:		SetConnectionOptions (static)
+//
+// Description:		Sets the options which describe the connection (server,
+//					security and login) on the specified handle.
+//
+// Input Arguments:
+//		curl				= CURL*
+//		loginInfo			= const EmailSender::LoginInfo&
+//		testMode			= const bool&
+//		disableSignaling	= const bool&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void SMTPSession::SetConnectionOptions(CURL *curl, const EmailSender::LoginInfo &loginInfo,
+	const bool &testMode, const bool &disableSignaling)
+{
+	curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+	curl_easy_setopt(curl, CURLOPT_URL, loginInfo.smtpUrl.c_str());
+	curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+
+	if (disableSignaling)
+		curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+
+	if (!loginInfo.caCertificatePath.empty())
+		curl_easy_setopt(curl, CURLOPT_CAPATH, loginInfo.caCertificatePath.c_str());
+
+	if (loginInfo.oAuth2Token.empty())
+	{
+		if (loginInfo.useSSL)
+			curl_easy_setopt(curl, CURLOPT_USE_SSL, CURLUSESSL_ALL);
+		curl_easy_setopt(curl, CURLOPT_PASSWORD, loginInfo.password.c_str());
+	}
+	else
+		curl_easy_setopt(curl, CURLOPT_USE_SSL, CURLUSESSL_ALL);
+
+	if (testMode)
+		curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
+
+	curl_easy_setopt(curl, CURLOPT_USERNAME, loginInfo.localEmail.c_str());
+	curl_easy_setopt(curl, CURLOPT_MAIL_FROM, ("<" + loginInfo.localEmail + ">").c_str());
+}
+
+//==========================================================================
+// Class:			SMTPSession
+// Function:		SetMessageOptions (static)
+//
+// Description:		Sets the options which change with each message on the
+//					specified handle.
+//
+// Input Arguments:
+//		curl			= CURL*
+//		loginInfo		= const EmailSender::LoginInfo&
+//		recipients		= const std::vector<EmailSender::AddressInfo>&
+//		readFunction	= curl_read_callback
+//		seekFunction	= curl_seek_callback
+//		payloadData		= void*
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		curl_slist*, recipient list which must be freed by the caller after
+//		the transfer is complete
+//
+//==========================================================================
+curl_slist* SMTPSession::SetMessageOptions(CURL *curl, const EmailSender::LoginInfo &loginInfo,
+	const std::vector<EmailSender::AddressInfo> &recipients, curl_read_callback readFunction,
+	curl_seek_callback seekFunction, void *payloadData)
+{
+	// Access tokens expire, so this is refreshed for every message.  As long as
+	// the token is unchanged, libcurl will continue to reuse the connection.
+	if (!loginInfo.oAuth2Token.empty())
+		curl_easy_setopt(curl, CURLOPT_XOAUTH2_BEARER, UString::ToNarrowString(OAuth2Interface::Get().GetAccessToken()).c_str());
+
+	struct curl_slist *recipientList = nullptr;
+	for (const auto& r : recipients)
+		recipientList = curl_slist_append(recipientList, ("<" + r.address + ">").c_str());
+	curl_easy_setopt(curl, CURLOPT_MAIL_RCPT, recipientList);
+
+	curl_easy_setopt(curl, CURLOPT_READFUNCTION, readFunction);
+	curl_easy_setopt(curl, CURLOPT_READDATA, payloadData);
+	curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, seekFunction);
+	curl_easy_setopt(curl, CURLOPT_SEEKDATA, payloadData);
+
+	return recipientList;
+}
+
+//==========================================================================
+// Class:			SMTPSession
+// Function:		IsDroppedConnection
+//
+// Description:		Checks to see if the error indicates that the server closed
+//					the cached connection (i.e. idle timeout) before the
+//					attempt got anywhere.  Only a reused connection which
+//					failed before any reply was received qualifies; otherwise
+//					the server may already have accepted the message, and
+//					sending it again could deliver it twice.
+//
+// Input Arguments:
+//		curl	= CURL*
+//		result	= const CURLcode&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool
+//
+//==========================================================================
+bool SMTPSession::IsDroppedConnection(CURL *curl, const CURLcode &result)
+{
+	if (result != CURLE_SEND_ERROR &&
+		result != CURLE_RECV_ERROR &&
+		result != CURLE_GOT_NOTHING)
+		return false;
+
+	long newConnections(0);
+	long responseCode(0);
+	if (curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &newConnections) != CURLE_OK ||
+		curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode) != CURLE_OK)
+		return false;
+
+	return newConnections == 0 && responseCode == 0;
+}
+
+//==========================================================================
+// Class:			SMTPSession
+// Function:		IsThrottled (static)
+//
+// Description:		Checks to see if the server's last response indicates that
+//					it is limiting the rate at which we send (421 or 454).
+//
+// Input Arguments:
+//		curl	= CURL*
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool
+//
+//==========================================================================
+bool SMTPSession::IsThrottled(CURL *curl)
+{
+	long responseCode(0);
+	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
+	return responseCode == 421 || responseCode == 454;
+}
@@ -0,0 +1,64 @@
+// File:  smtpSession.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Long-lived SMTP connection which allows many messages to be sent
+//        without repeating the connect/STARTTLS/AUTH handshake for each one.
+
+#ifndef SMTP_SESSION_H_
+#define SMTP_SESSION_H_
+
+// Local headers
+#include "emailSender.h"
+#include "sendResult.h"
+
+// cURL headers
+#include <curl/curl.h>
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+
+class SMTPSession
+{
+public:
+	SMTPSession(const EmailSender::LoginInfo &loginInfo, const bool &testMode,
+		UString::OStream &outStream = Cout);
+	~SMTPSession();
+
+	SMTPSession(const SMTPSession&) = delete;
+	SMTPSession& operator=(const SMTPSession&) = delete;
+
+	void DisableSignaling(const bool& disable = true) { disableSignaling = disable; }
+
+	bool Send(const std::vector<EmailSender::AddressInfo> &recipients,
+		curl_read_callback readFunction, curl_seek_callback seekFunction, void *payloadData);
+
+	void Close();
+
+	const EmailSender::LoginInfo& GetLoginInfo() const { return loginInfo; }
+	const SendResult& GetLastResult() const { return lastResult; }
+
+	static void SetConnectionOptions(CURL *curl, const EmailSender::LoginInfo &loginInfo,
+		const bool &testMode, const bool &disableSignaling);
+	static curl_slist* SetMessageOptions(CURL *curl, const EmailSender::LoginInfo &loginInfo,
+		const std::vector<EmailSender::AddressInfo> &recipients, curl_read_callback readFunction,
+		curl_seek_callback seekFunction, void *payloadData);
+	static bool IsThrottled(CURL *curl);
+
+private:
+	const EmailSender::LoginInfo loginInfo;
+	const bool testMode;
+	bool disableSignaling = false;
+	UString::OStream &outStream;
+
+	CURL *curl = nullptr;
+	SendResult lastResult;
+
+	bool Initialize();
+	CURLcode Perform(const std::vector<EmailSender::AddressInfo> &recipients,
+		curl_read_callback readFunction, curl_seek_callback seekFunction, void *payloadData);
+
+	static bool IsDroppedConnection(CURL *curl, const CURLcode &result);
+};
+
+#endif// SMTP_SESSION_H_
@@ -0,0 +1,100 @@
+// File:  base64Benchmark.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Measures base64 encode and decode throughput for each kernel this
+//        CPU supports.
+
+// Local headers
+#include "base64.h"
+
+// Standard C++ headers
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+
+namespace
+{
+	const size_t bufferSize(64 << 20);
+	const unsigned int repetitions(5);
+
+	// Best of several runs, in GB/s of unencoded data
+	double Measure(const std::function<void()> &operation)
+	{
+		double best(0.0);
+		unsigned int i;
+		for (i = 0; i < repetitions; ++i)
+		{
+			const auto start(std::chrono::steady_clock::now());
+			operation();
+			const double seconds(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+			best = std::max(best, bufferSize / seconds * 1.0e-9);
+		}
+
+		return best;
+	}
+}
+
+int main()
+{
+	std::vector<char> data(bufferSize);
+	std::mt19937 generator(1);
+	for (auto& c : data)
+		c = static_cast<char>(generator());
+
+	std::vector<char> encoded(Base64::GetEncodedSize(bufferSize, true));
+	std::vector<char> decoded(bufferSize);
+	size_t unwrappedSize(Base64::Encode(data.data(), data.size(), encoded.data(), false));
+	std::vector<char> unwrapped(encoded.begin(), encoded.begin() + unwrappedSize);
+	size_t wrappedSize(Base64::Encode(data.data(), data.size(), encoded.data(), true));
+	std::vector<char> wrapped(encoded.begin(), encoded.begin() + wrappedSize);
+
+	std::cout << "Throughput on a " << (bufferSize >> 20) << " MB buffer, best of "
+		<< repetitions << " runs [GB/s]" << std::endl;
+	std::cout << std::left << std::setw(8) << "Kernel" << std::right << std::setw(10) << "encode"
+		<< std::setw(10) << "wrapped" << std::setw(10) << "decode" << std::setw(10) << "wrapped" << std::endl;
+
+	for (const auto& kernel : Base64::GetSupportedKernels())
+	{
+		Base64::SelectKernel(kernel);
+
+		const double encode(Measure([&]()
+		{
+			Base64::Encode(data.data(), data.size(), encoded.data(), false);
+		}));
+
+		const double encodeWrapped(Measure([&]()
+		{
+			Base64::Encode(data.data(), data.size(), encoded.data(), true);
+		}));
+
+		bool success(true);
+		const double decode(Measure([&]()
+		{
+			size_t size(decoded.size());
+			success = Base64::Decode(unwrapped.data(), unwrapped.size(), decoded.data(), size) && success;
+		}));
+
+		const double decodeWrapped(Measure([&]()
+		{
+			size_t size(decoded.size());
+			success = Base64::Decode(wrapped.data(), wrapped.size(), decoded.data(), size) && success;
+		}));
+
+		if (!success || decoded != data)
+		{
+			std::cerr << "Decoding failed with the " << kernel << " kernel" << std::endl;
+			return 1;
+		}
+
+		std::cout << std::left << std::setw(8) << kernel << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(10) << encode << std::setw(10) << encodeWrapped
+			<< std::setw(10) << decode << std::setw(10) << decodeWrapped << std::endl;
+	}
+
+	return 0;
+}
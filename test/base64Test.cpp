@@ -0,0 +1,158 @@
+// File:  base64Test.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Checks each base64 kernel this CPU supports against a reference
+//        encoder, for all tail lengths, both alphabets and wrapped output.
+
+// Local headers
+#include "base64.h"
+#include "testUtilities.h"
+
+// Standard C++ headers
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	std::string ReferenceEncode(const std::string &data, const bool &wrapLines, const Base64::Alphabet &alphabet)
+	{
+		const std::string charset(std::string("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789")
+			+ (alphabet == Base64::Alphabet::URLSafe ? "-_" : "+/"));
+
+		std::string encoded;
+		size_t i;
+		for (i = 0; i < data.size(); i += 3)
+		{
+			uint32_t triple(static_cast<unsigned char>(data[i]) << 16);
+			if (i + 1 < data.size())
+				triple |= static_cast<unsigned char>(data[i + 1]) << 8;
+			if (i + 2 < data.size())
+				triple |= static_cast<unsigned char>(data[i + 2]);
+
+			encoded.push_back(charset[(triple >> 18) & 0x3f]);
+			encoded.push_back(charset[(triple >> 12) & 0x3f]);
+			encoded.push_back(i + 1 < data.size() ? charset[(triple >> 6) & 0x3f] : '=');
+			encoded.push_back(i + 2 < data.size() ? charset[triple & 0x3f] : '=');
+		}
+
+		if (!wrapLines)
+			return encoded;
+
+		std::string wrapped;
+		for (i = 0; i < encoded.size(); i += Base64::CharsPerLine)
+			wrapped.append(encoded, i, Base64::CharsPerLine).append("\n");
+		return wrapped;
+	}
+
+	std::string Describe(const std::string &kernel, const size_t &size, const bool &wrapLines,
+		const Base64::Alphabet &alphabet)
+	{
+		return kernel + ", " + std::to_string(size) + " bytes" + (wrapLines ? ", wrapped" : "")
+			+ (alphabet == Base64::Alphabet::URLSafe ? ", URL-safe" : "");
+	}
+
+	void CheckKnownValues()
+	{
+		const std::vector<std::pair<std::string, std::string>> vectors({
+			{ "", "" }, { "f", "Zg==" }, { "fo", "Zm8=" }, { "foo", "Zm9v" },
+			{ "foob", "Zm9vYg==" }, { "fooba", "Zm9vYmE=" }, { "foobar", "Zm9vYmFy" } });
+
+		for (const auto& v : vectors)
+		{
+			Test::Check(ReferenceEncode(v.first, false, Base64::Alphabet::Standard) == v.second,
+				"Reference encoding of \"" + v.first + "\"");
+			Test::Check(Base64::Encode(v.first, false) == v.second, "Encoding of \"" + v.first + "\"");
+		}
+
+		Test::Check(Base64::Encode(std::string("\xfb\xff\xbf", 3), false, Base64::Alphabet::URLSafe) == "-_-_",
+			"URL-safe characters");
+	}
+
+	void CheckKernel(const std::string &kernel, const std::vector<size_t> &sizes, std::mt19937 &generator)
+	{
+		for (const auto& size : sizes)
+		{
+			std::string data(size, '\0');
+			for (auto& c : data)
+				c = static_cast<char>(generator());
+
+			for (const auto& alphabet : { Base64::Alphabet::Standard, Base64::Alphabet::URLSafe })
+			{
+				for (const bool wrapLines : { false, true })
+				{
+					const std::string description(Describe(kernel, size, wrapLines, alphabet));
+					const std::string encoded(Base64::Encode(data, wrapLines, alphabet));
+					if (!Test::Check(encoded == ReferenceEncode(data, wrapLines, alphabet), "Encode:  " + description))
+						continue;
+
+					std::string decoded;
+					Test::Check(Base64::Decode(encoded, decoded, alphabet) && decoded == data, "Decode:  " + description);
+				}
+			}
+
+			// CRLF line endings and unpadded input
+			std::string encoded(Base64::Encode(data, true));
+			std::string::size_type position(0);
+			while ((position = encoded.find('\n', position)) != std::string::npos)
+			{
+				encoded.insert(position, "\r");
+				position += 2;
+			}
+
+			while (!encoded.empty() && (encoded.back() == '=' || encoded.back() == '\n' || encoded.back() == '\r'))
+				encoded.pop_back();
+
+			std::string decoded;
+			Test::Check(Base64::Decode(encoded, decoded) && decoded == data,
+				"Decode with CRLF and no padding:  " + kernel + ", " + std::to_string(size) + " bytes");
+
+			if (size < 3)
+				continue;
+
+			// An invalid character anywhere must be rejected, including within SIMD blocks
+			const std::string unwrapped(Base64::Encode(data, false));
+			for (const auto& invalid : { '*', '-', '\x80' })
+			{
+				std::string corrupt(unwrapped);
+				corrupt[generator() % (corrupt.size() - 2)] = invalid;
+				Test::Check(!Base64::Decode(corrupt, decoded), "Reject '" + std::string(1, invalid)
+					+ "':  " + kernel + ", " + std::to_string(size) + " bytes");
+			}
+
+			std::string corrupt(Base64::Encode(data, false, Base64::Alphabet::URLSafe));
+			corrupt[generator() % (corrupt.size() - 2)] = '+';
+			Test::Check(!Base64::Decode(corrupt, decoded, Base64::Alphabet::URLSafe),
+				"Reject '+' in URL-safe:  " + kernel + ", " + std::to_string(size) + " bytes");
+		}
+	}
+}
+
+int main()
+{
+	CheckKnownValues();
+
+	// Every tail length for a few SIMD blocks and several wrapped lines, then some larger buffers
+	std::vector<size_t> sizes;
+	size_t size;
+	for (size = 0; size <= 4 * Base64::BytesPerLine; ++size)
+		sizes.push_back(size);
+	for (size = 4093; size <= 4099; ++size)
+		sizes.push_back(size);
+	sizes.push_back(1 << 20);
+
+	const std::vector<std::string> kernels(Base64::GetSupportedKernels());
+	Test::Check(kernels.front() == Base64::GetKernelName(), "Fastest kernel is selected by default");
+	for (const auto& kernel : kernels)
+	{
+		std::cout << "Checking " << kernel << " kernel" << std::endl;
+		Test::Check(Base64::SelectKernel(kernel) && kernel == Base64::GetKernelName(), "Select " + kernel);
+
+		std::mt19937 generator(1);
+		CheckKernel(kernel, sizes, generator);
+	}
+
+	Test::Check(!Base64::SelectKernel("none"), "Unknown kernel is refused");
+
+	return Test::Finish("base64Test");
+}
@@ -0,0 +1,376 @@
+// File:  dkimSignerTest.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Signs messages with freshly generated RSA and Ed25519 keys and
+//        verifies the signatures and body hashes with OpenSSL, against a
+//        separate (simple, unbuffered) relaxed canonicalization.
+
+// Local headers
+#include "dkimSigner.h"
+#include "base64.h"
+#include "testUtilities.h"
+
+// OpenSSL headers
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+#include <openssl/sha.h>
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+namespace
+{
+	std::shared_ptr<EVP_PKEY> GenerateKey(const int &type)
+	{
+		std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> context(EVP_PKEY_CTX_new_id(type, nullptr), EVP_PKEY_CTX_free);
+		EVP_PKEY *key(nullptr);
+		if (!context || EVP_PKEY_keygen_init(context.get()) <= 0 ||
+			(type == EVP_PKEY_RSA && EVP_PKEY_CTX_set_rsa_keygen_bits(context.get(), 2048) <= 0) ||
+			EVP_PKEY_keygen(context.get(), &key) <= 0)
+			return nullptr;
+		return std::shared_ptr<EVP_PKEY>(key, EVP_PKEY_free);
+	}
+
+	bool WriteKey(EVP_PKEY *key, const std::string &fileName)
+	{
+		FILE *file(fopen(fileName.c_str(), "w"));
+		if (!file)
+			return false;
+
+		const bool written(PEM_write_PrivateKey(file, key, nullptr, nullptr, 0, nullptr, nullptr) == 1);
+		fclose(file);
+		return written;
+	}
+
+	bool IsWhitespace(const char &c)
+	{
+		return c == ' ' || c == '\t';
+	}
+
+	// Splits text into lines, accepting "\n" or "\r\n"
+	std::vector<std::string> SplitLines(const std::string &text)
+	{
+		std::vector<std::string> lines;
+		size_t start(0);
+		while (start < text.size())
+		{
+			size_t end(text.find('\n', start));
+			if (end == std::string::npos)
+				end = text.size();
+
+			lines.push_back(text.substr(start, end - start));
+			if (!lines.back().empty() && lines.back().back() == '\r')
+				lines.back().pop_back();
+			start = end + 1;
+		}
+		return lines;
+	}
+
+	std::string CompressWhitespace(const std::string &text)
+	{
+		std::string out;
+		for (const char &c : text)
+		{
+			if (!IsWhitespace(c))
+				out.push_back(c);
+			else if (out.empty() || out.back() != ' ')
+				out.push_back(' ');
+		}
+
+		while (!out.empty() && out.back() == ' ')
+			out.pop_back();
+		return out;
+	}
+
+	// RFC 6376 section 3.4.4
+	std::string CanonicalizeBody(const std::string &body)
+	{
+		std::vector<std::string> lines(SplitLines(body));
+		for (auto& line : lines)
+			line = CompressWhitespace(line);
+		while (!lines.empty() && lines.back().empty())
+			lines.pop_back();
+
+		std::string out;
+		for (const auto& line : lines)
+			out.append(line + "\r\n");
+		return out;
+	}
+
+	// RFC 6376 section 3.4.2; field includes any continuation lines
+	std::string CanonicalizeField(const std::string &field)
+	{
+		const size_t colon(field.find(':'));
+		std::string name(field.substr(0, colon));
+		std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c)
+		{
+			return static_cast<char>(std::tolower(c));
+		});
+		name = CompressWhitespace(name);
+
+		std::string value;
+		for (const char &c : field.substr(colon + 1))
+		{
+			if (c != '\r' && c != '\n')
+				value.push_back(c);
+		}
+
+		value = CompressWhitespace(value);
+		if (!value.empty() && value.front() == ' ')
+			value.erase(0, 1);
+		return name + ":" + value + "\r\n";
+	}
+
+	std::string Sha256Base64(const std::string &data)
+	{
+		unsigned char digest[SHA256_DIGEST_LENGTH];
+		SHA256(reinterpret_cast<const unsigned char*>(data.data()), data.size(), digest);
+		return Base64::Encode(std::string(reinterpret_cast<const char*>(digest), sizeof(digest)), false);
+	}
+
+	struct SignedMessage
+	{
+		std::vector<std::string> fields;// Header fields, the signature first
+		std::string body;
+		std::map<std::string, std::string> tags;// Of the signature, whitespace removed
+	};
+
+	bool Parse(const std::string &message, SignedMessage &parsed)
+	{
+		size_t bodyStart(message.find("\n\n"));
+		const size_t crlfBodyStart(message.find("\r\n\r\n"));
+		if (crlfBodyStart < bodyStart)
+			bodyStart = crlfBodyStart + 4;
+		else if (bodyStart != std::string::npos)
+			bodyStart += 2;
+		else
+			return false;
+
+		parsed.body = message.substr(bodyStart);
+		for (const auto& line : SplitLines(message.substr(0, bodyStart)))
+		{
+			if (line.empty())
+				break;
+			else if (IsWhitespace(line.front()) && !parsed.fields.empty())
+				parsed.fields.back().append("\r\n" + line);
+			else
+				parsed.fields.push_back(line);
+		}
+
+		if (parsed.fields.empty() || parsed.fields.front().compare(0, 15, "DKIM-Signature:") != 0)
+			return false;
+
+		std::string tagList;
+		for (const char &c : parsed.fields.front().substr(15))
+		{
+			if (!IsWhitespace(c) && c != '\r' && c != '\n')
+				tagList.push_back(c);
+		}
+
+		size_t start(0);
+		while (start < tagList.size())
+		{
+			size_t end(tagList.find(';', start));
+			if (end == std::string::npos)
+				end = tagList.size();
+
+			const std::string tag(tagList.substr(start, end - start));
+			const size_t equals(tag.find('='));
+			if (equals != std::string::npos)
+				parsed.tags[tag.substr(0, equals)] = tag.substr(equals + 1);
+			start = end + 1;
+		}
+
+		return true;
+	}
+
+	// The signed header fields, then the signature field with an empty b=
+	std::string GetSignedData(const SignedMessage &message)
+	{
+		std::string data;
+		const std::string &names(message.tags.at("h"));
+		size_t start(0);
+		while (start <= names.size())
+		{
+			size_t end(names.find(':', start));
+			if (end == std::string::npos)
+				end = names.size();
+
+			const std::string name(names.substr(start, end - start));
+			const auto field(std::find_if(message.fields.rbegin(), message.fields.rend() - 1, [&name](const std::string &f)
+			{
+				return f.size() > name.size() && f[name.size()] == ':' &&
+					std::equal(name.begin(), name.end(), f.begin(), [](const char &a, const char &b)
+					{
+						return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+					});
+			}));
+
+			if (field != message.fields.rend() - 1)
+				data.append(CanonicalizeField(*field));
+			start = end + 1;
+		}
+
+		// The b= tag follows a ';' (other than whitespace)
+		std::string signature(message.fields.front());
+		size_t b(signature.find("b="));
+		while (b != std::string::npos)
+		{
+			size_t previous(b);
+			while (previous > 0 && (IsWhitespace(signature[previous - 1]) || signature[previous - 1] == '\r' || signature[previous - 1] == '\n'))
+				--previous;
+			if (previous > 0 && signature[previous - 1] == ';')
+				break;
+			b = signature.find("b=", b + 1);
+		}
+
+		if (b == std::string::npos)
+			return std::string();
+		const size_t end(signature.find(';', b));
+		signature.erase(b + 2, end == std::string::npos ? std::string::npos : end - b - 2);
+
+		data.append(CanonicalizeField(signature));
+		data.resize(data.size() - 2);
+		return data;
+	}
+
+	bool VerifySignature(EVP_PKEY *key, const SignedMessage &message)
+	{
+		std::string signature;
+		if (!Base64::Decode(message.tags.at("b"), signature))
+			return false;
+
+		std::string data(GetSignedData(message));
+		const EVP_MD *digest(EVP_sha256());
+		if (EVP_PKEY_id(key) == EVP_PKEY_ED25519)
+		{
+			// RFC 8463 signs the SHA-256 hash of the data
+			unsigned char hash[SHA256_DIGEST_LENGTH];
+			SHA256(reinterpret_cast<const unsigned char*>(data.data()), data.size(), hash);
+			data.assign(reinterpret_cast<const char*>(hash), sizeof(hash));
+			digest = nullptr;
+		}
+
+		std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> context(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+		return context && EVP_DigestVerifyInit(context.get(), nullptr, digest, nullptr, key) == 1 &&
+			EVP_DigestVerify(context.get(), reinterpret_cast<const unsigned char*>(signature.data()), signature.size(),
+			reinterpret_cast<const unsigned char*>(data.data()), data.size()) == 1;
+	}
+
+	const std::string header("From: Sender <sender@example.com>\n"
+		"To: r1@example.com,\n\tr2@example.com\n"
+		"Subject:   Signing  test \n"
+		"X-Unsigned: not in h=\n"
+		"Date: Fri, 16 Oct 2026 12:00:00 +0000\n");
+
+	const std::string mimeHeaderAndBody("MIME-Version: 1.0\n"
+		"Content-Type: text/plain; charset=utf-8\n"
+		"\n"
+		"First line  with \t spaces \n"
+		"\r\n"
+		"Second line\r\n"
+		"  indented\n"
+		"\n\n\n");
+
+	// Signs the payload, checks its signature and body hash and returns the
+	// signed message
+	std::string CheckSigned(const DKIMSigner &signer, PayloadReader &payload, EVP_PKEY *key,
+		const std::string &algorithm, const std::string &name)
+	{
+		if (!Test::Check(signer.Sign(payload), name + "signed"))
+			return std::string();
+
+		const std::string message(payload.ReadAll());
+		SignedMessage parsed;
+		if (!Test::Check(Parse(message, parsed), name + "signature field found"))
+			return message;
+
+		Test::Check(parsed.tags["a"] == algorithm, name + "algorithm");
+		Test::Check(parsed.tags["c"] == "relaxed/relaxed" && parsed.tags["d"] == "example.com", name + "canonicalization and domain");
+		Test::Check(parsed.tags["bh"] == Sha256Base64(CanonicalizeBody(parsed.body)), name + "body hash");
+		Test::Check(VerifySignature(key, parsed), name + "signature verified");
+
+		// Altering a signed field must invalidate the signature
+		for (auto& field : parsed.fields)
+		{
+			if (field.compare(0, 8, "Subject:") == 0)
+				field.append("!");
+		}
+		Test::Check(!VerifySignature(key, parsed), name + "altered message rejected");
+		return message;
+	}
+
+	void CheckKey(const int &type, const std::string &algorithm, const std::string &keyFileName)
+	{
+		const std::string name(algorithm + ":  ");
+		const std::shared_ptr<EVP_PKEY> key(GenerateKey(type));
+		if (!Test::Check(key && WriteKey(key.get(), keyFileName), name + "key generated"))
+			return;
+
+		DKIMSigner::Settings settings;
+		settings.domain = "example.com";
+		settings.selector = algorithm;
+		settings.privateKeyPath = keyFileName;
+		const DKIMSigner signer(settings);
+		if (!Test::Check(signer.IsValid(), name + "key loaded"))
+			return;
+
+		{
+			PayloadReader payload;
+			payload.AppendText(header + mimeHeaderAndBody);
+			CheckSigned(signer, payload, key.get(), algorithm, name + "text:  ");
+		}
+
+		// A shared body is hashed the first time and its hash reused after
+		const std::shared_ptr<const std::string> renderedBody(std::make_shared<std::string>(mimeHeaderAndBody));
+		std::string first;
+		unsigned int i;
+		for (i = 0; i < 3; ++i)
+		{
+			PayloadReader payload;
+			payload.AppendText(header + "Message-ID: <" + std::to_string(i) + "@example.com>\n");
+			payload.Append(std::make_unique<PayloadReader::SharedTextSource>(renderedBody));
+			const std::string message(CheckSigned(signer, payload, key.get(), algorithm,
+				name + "shared body " + std::to_string(i + 1) + ":  "));
+
+			if (i == 0)
+				first = message;
+			else
+				Test::Check(message.substr(message.find("\n\n")) == first.substr(first.find("\n\n")),
+					name + "shared body " + std::to_string(i + 1) + ":  same body sent");
+		}
+
+		// A shared body which does not end the payload is read as usual
+		{
+			PayloadReader payload;
+			payload.AppendText(header);
+			payload.Append(std::make_unique<PayloadReader::SharedTextSource>(renderedBody));
+			payload.AppendText("Appended line\n");
+			CheckSigned(signer, payload, key.get(), algorithm, name + "shared body, not last:  ");
+		}
+	}
+}
+
+int main()
+{
+	char keyFileName[] = "/tmp/dkimSignerTestXXXXXX";
+	const int file(mkstemp(keyFileName));
+	if (!Test::Check(file >= 0, "Temporary key file created"))
+		return Test::Finish("dkimSignerTest");
+	close(file);
+
+	CheckKey(EVP_PKEY_RSA, "rsa-sha256", keyFileName);
+	CheckKey(EVP_PKEY_ED25519, "ed25519-sha256", keyFileName);
+
+	unlink(keyFileName);
+	return Test::Finish("dkimSignerTest");
+}
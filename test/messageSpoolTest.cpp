@@ -0,0 +1,258 @@
+// File:  messageSpoolTest.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Writes messages to a MessageSpool, damages the files as a crash
+//        would, reopens the spool and compares what is recovered.
+
+// Local headers
+#include "messageSpool.h"
+#include "testUtilities.h"
+
+// Standard C++ headers
+#include <sstream>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <fstream>
+#include <cstdlib>
+#include <cstdint>
+
+namespace
+{
+	struct Message
+	{
+		std::vector<EmailSender::AddressInfo> recipients;
+		std::string payload;
+	};
+
+	std::vector<Message> MakeMessages(const unsigned int &count)
+	{
+		std::vector<Message> messages;
+		unsigned int i;
+		for (i = 0; i < count; ++i)
+		{
+			Message m;
+			m.recipients.push_back({ "r" + std::to_string(i + 1) + "@example.com", "Recipient " + std::to_string(i + 1) });
+			if (i % 2 == 1)
+				m.recipients.push_back({ "copy@example.com", "" });
+			m.payload = "Subject: Spool test " + std::to_string(i + 1) + "\n\n" + std::string(100 * (i + 1), 'x') + "\n";
+			messages.push_back(std::move(m));
+		}
+		return messages;
+	}
+
+	bool Matches(const MessageSpool::Entry &entry, const Message &message)
+	{
+		if (entry.payload != message.payload || entry.recipients.size() != message.recipients.size())
+			return false;
+
+		size_t i;
+		for (i = 0; i < message.recipients.size(); ++i)
+		{
+			if (entry.recipients[i].address != message.recipients[i].address ||
+				entry.recipients[i].displayName != message.recipients[i].displayName)
+				return false;
+		}
+		return true;
+	}
+
+	// Appends the messages to a new spool and closes it
+	std::vector<MessageSpool::EntryID> Write(const std::string &directory, const std::vector<Message> &messages, std::ostream &log)
+	{
+		std::vector<MessageSpool::EntryID> ids;
+		MessageSpool spool(directory, 64 * 1024 * 1024, 10, log);
+		if (!spool.Open())
+			return ids;
+
+		for (const auto& m : messages)
+			ids.push_back(spool.Append(m.recipients, m.payload));
+		if (!spool.Commit())
+			ids.clear();
+		return ids;
+	}
+
+	// Reads everything the spool hands out, marking each as delivered
+	std::vector<MessageSpool::Entry> ReadAll(MessageSpool &spool)
+	{
+		std::vector<MessageSpool::Entry> entries;
+		MessageSpool::Entry entry;
+		while (spool.Next(entry, 50))
+		{
+			spool.MarkDelivered(entry.id);
+			entries.push_back(entry);
+		}
+		return entries;
+	}
+
+	std::string GetOnlyFile(const std::string &directory, const std::string &extension)
+	{
+		std::string name;
+		for (const auto& file : std::filesystem::directory_iterator(directory))
+		{
+			if (file.path().extension() == extension)
+				name = file.path().string();
+		}
+		return name;
+	}
+
+	void CheckRoundTrip(const std::string &directory, std::ostream &log)
+	{
+		const std::vector<Message> messages(MakeMessages(4));
+		{
+			MessageSpool spool(directory, 64 * 1024 * 1024, 10, log);
+			if (!Test::Check(spool.Open(), "Round trip:  spool opened"))
+				return;
+
+			for (const auto& m : messages)
+				spool.Append(m.recipients, m.payload);
+			Test::Check(spool.Commit(), "Round trip:  committed");
+
+			MessageSpool::Entry entry;
+			std::vector<MessageSpool::EntryID> ids;
+			unsigned int i;
+			for (i = 0; i < messages.size(); ++i)
+			{
+				if (!Test::Check(spool.Next(entry, 1000) && Matches(entry, messages[i]), "Round trip:  message " + std::to_string(i + 1) + " read back"))
+					return;
+				ids.push_back(entry.id);
+			}
+
+			// Deliver the first, release the second and leave the others handed out
+			spool.MarkDelivered(ids[0]);
+			spool.Release(ids[1]);
+			Test::Check(spool.Next(entry, 1000) && entry.id == ids[1] && Matches(entry, messages[1]),
+				"Round trip:  released message handed out again");
+			Test::Check(!spool.Next(entry, 50), "Round trip:  nothing else to hand out");
+			Test::Check(spool.GetUndeliveredCount() == 3, "Round trip:  three undelivered");
+		}
+
+		// Undelivered messages (whether handed out or not) are recovered
+		{
+			MessageSpool spool(directory, 64 * 1024 * 1024, 10, log);
+			Test::Check(spool.Open(), "Round trip:  spool reopened");
+			Test::Check(spool.GetUndeliveredCount() == 3, "Round trip:  three undelivered after reopening");
+
+			const std::vector<MessageSpool::Entry> entries(ReadAll(spool));
+			Test::Check(entries.size() == 3 && Matches(entries[0], messages[1]) && Matches(entries[1], messages[2]) &&
+				Matches(entries[2], messages[3]), "Round trip:  undelivered messages recovered in order");
+			Test::Check(spool.GetUndeliveredCount() == 0, "Round trip:  all delivered");
+		}
+
+		// Segments with nothing left to deliver are removed
+		{
+			MessageSpool spool(directory, 64 * 1024 * 1024, 10, log);
+			Test::Check(spool.Open() && spool.GetUndeliveredCount() == 0, "Round trip:  nothing recovered once delivered");
+		}
+
+		Test::Check(GetOnlyFile(directory, ".log").empty(), "Round trip:  delivered segment removed");
+	}
+
+	// A crash partway through writing leaves an incomplete last record (with
+	// only the first keep bytes written) or one which does not match its CRC
+	// (damaged, with the length intact)
+	void CheckTornRecord(const std::string &directory, const std::string &name, const uintmax_t &keep, const bool &damage, std::ostream &log)
+	{
+		const std::vector<Message> messages(MakeMessages(3));
+		const std::vector<MessageSpool::EntryID> ids(Write(directory, messages, log));
+		if (!Test::Check(ids.size() == 3, name + "messages written"))
+			return;
+
+		const std::string logFileName(GetOnlyFile(directory, ".log"));
+		const uintmax_t lastOffset(ids.back() & 0xFFFFFFFF);
+		if (keep < std::filesystem::file_size(logFileName) - lastOffset)
+			std::filesystem::resize_file(logFileName, lastOffset + keep);
+
+		if (damage)
+		{
+			std::fstream file(logFileName, std::ios::in | std::ios::out | std::ios::binary);
+			file.seekp(-1, std::ios::end);
+			file.put('?');
+		}
+
+		std::ostringstream recoveryLog;
+		{
+			MessageSpool spool(directory, 64 * 1024 * 1024, 10, recoveryLog);
+			Test::Check(spool.Open(), name + "spool reopened");
+			Test::Check(spool.GetUndeliveredCount() == 2, name + "two records recovered");
+
+			const std::vector<MessageSpool::Entry> entries(ReadAll(spool));
+			Test::Check(entries.size() == 2 && Matches(entries[0], messages[0]) && Matches(entries[1], messages[1]),
+				name + "complete records read back");
+		}
+
+		Test::Check(recoveryLog.str().find("Removing incomplete records") != std::string::npos, name + "removal reported");
+		Test::Check(recoveryLog.str().find("corrupt") == std::string::npos, name + "not reported as corruption");
+		Test::Check(GetOnlyFile(directory, ".log").empty(), name + "segment removed once delivered");
+		log << recoveryLog.str();
+	}
+
+	// Delivered offsets are read back from the index, ignoring a partially
+	// written entry at its end
+	void CheckIndexReplay(const std::string &directory, std::ostream &log)
+	{
+		const std::vector<Message> messages(MakeMessages(5));
+		{
+			MessageSpool spool(directory, 64 * 1024 * 1024, 10, log);
+			if (!Test::Check(spool.Open(), "Index:  spool opened"))
+				return;
+
+			for (const auto& m : messages)
+				spool.Append(m.recipients, m.payload);
+			Test::Check(spool.Commit(), "Index:  committed");
+
+			MessageSpool::Entry entry;
+			unsigned int i;
+			for (i = 0; i < messages.size(); ++i)
+			{
+				if (!spool.Next(entry, 1000))
+					break;
+				if (i % 2 == 0)
+					spool.MarkDelivered(entry.id);
+			}
+		}
+
+		const std::string indexFileName(GetOnlyFile(directory, ".idx"));
+		if (!Test::Check(!indexFileName.empty() && std::filesystem::file_size(indexFileName) == 12, "Index:  three offsets written"))
+			return;
+
+		{
+			std::ofstream file(indexFileName, std::ios::app | std::ios::binary);
+			file.write("\x01\x02", 2);
+		}
+
+		{
+			MessageSpool spool(directory, 64 * 1024 * 1024, 10, log);
+			Test::Check(spool.Open(), "Index:  spool reopened");
+			Test::Check(std::filesystem::file_size(indexFileName) == 12, "Index:  partial entry removed");
+
+			const std::vector<MessageSpool::Entry> entries(ReadAll(spool));
+			Test::Check(entries.size() == 2 && Matches(entries[0], messages[1]) && Matches(entries[1], messages[3]),
+				"Index:  only undelivered messages recovered");
+		}
+
+		Test::Check(GetOnlyFile(directory, ".log").empty(), "Index:  segment removed once delivered");
+	}
+}
+
+int main()
+{
+	char directoryTemplate[] = "/tmp/messageSpoolTestXXXXXX";
+	const char *directory(mkdtemp(directoryTemplate));
+	if (!Test::Check(directory != nullptr, "Temporary directory created"))
+		return Test::Finish("messageSpoolTest");
+
+	std::ostringstream log;
+	const std::string root(directory);
+	CheckRoundTrip(root + "/roundTrip", log);
+	CheckTornRecord(root + "/truncatedHeader", "Truncated header:  ", 5, false, log);
+	CheckTornRecord(root + "/truncatedBody", "Truncated body:  ", 100, false, log);
+	CheckTornRecord(root + "/damaged", "Bad CRC:  ", UINTMAX_MAX, true, log);
+	CheckIndexReplay(root + "/index", log);
+
+	std::filesystem::remove_all(root);
+
+	if (Test::GetFailureCount() > 0)
+		std::cerr << "Log:\n" << log.str() << std::endl;
+
+	return Test::Finish("messageSpoolTest");
+}
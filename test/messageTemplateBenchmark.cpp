@@ -0,0 +1,142 @@
+// File:  messageTemplateBenchmark.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Times 100k per-recipient renders of a short template, compared with
+//        substituting the placeholders in a copy of the text for each
+//        recipient.
+
+// Local headers
+#include "messageTemplate.h"
+#include "messageBuilder.h"
+
+// Standard C++ headers
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include <string>
+#include <map>
+
+namespace
+{
+	const size_t renderCount(100000);
+
+	const std::string text("Dear {name},\n"
+		"\n"
+		"Your order {order} has shipped and should arrive by {date}.  You can\n"
+		"follow its progress at any time from the orders page of your account.\n"
+		"If anything about the order is not right, reply to this message and\n"
+		"quote the order number; we will sort it out as quickly as we can.\n"
+		"\n"
+		"Thank you for shopping with us, {name}.\n");
+
+	struct Recipient
+	{
+		std::string name;
+		std::string order;
+		std::string date;
+	};
+
+	// render returns the number of bytes produced
+	void Measure(const std::string &name, const std::function<size_t(const Recipient&)> &render,
+		const std::vector<Recipient> &recipients)
+	{
+		size_t bytes(0);
+		const auto start(std::chrono::steady_clock::now());
+		for (const auto& r : recipients)
+			bytes += render(r);
+		const double seconds(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+		std::cout << std::left << std::setw(32) << name << std::right << std::fixed
+			<< std::setw(10) << std::setprecision(1) << seconds * 1000.0
+			<< std::setw(12) << std::setprecision(0) << recipients.size() / seconds
+			<< std::setw(10) << bytes / recipients.size() << std::endl;
+	}
+
+	void Replace(std::string &s, const std::string &field, const std::string &value)
+	{
+		std::string::size_type position(0);
+		while ((position = s.find(field, position)) != std::string::npos)
+		{
+			s.replace(position, field.size(), value);
+			position += value.size();
+		}
+	}
+}
+
+int main()
+{
+	std::vector<Recipient> recipients(renderCount);
+	size_t i;
+	for (i = 0; i < recipients.size(); ++i)
+	{
+		recipients[i].name = "Recipient " + std::to_string(i);
+		recipients[i].order = "A" + std::to_string(1000000 + i);
+		recipients[i].date = "October " + std::to_string(i % 28 + 1);
+	}
+
+	const auto messageTemplate(std::make_shared<const MessageTemplate>(text));
+	std::vector<char> buffer(65536);
+
+	std::cout << renderCount << " renders of a " << text.size() << " byte template" << std::endl;
+	std::cout << std::left << std::setw(32) << "Method" << std::right << std::setw(10) << "ms"
+		<< std::setw(12) << "renders/s" << std::setw(10) << "bytes" << std::endl;
+
+	Measure("string replace per recipient", [&](const Recipient &r)
+	{
+		std::string s(text);
+		Replace(s, "{name}", r.name);
+		Replace(s, "{order}", r.order);
+		Replace(s, "{date}", r.date);
+		return s.size();
+	}, recipients);
+
+	auto read([&buffer](PayloadReader::Source &source)
+	{
+		size_t size(0), length;
+		while ((length = source.Read(buffer.data(), buffer.size())) > 0)
+			size += length;
+		return size;
+	});
+
+	Measure("Source, values from MakeValues", [&](const Recipient &r)
+	{
+		MessageTemplate::Source source(messageTemplate,
+			messageTemplate->MakeValues({ { "name", r.name }, { "order", r.order }, { "date", r.date } }));
+		return read(source);
+	}, recipients);
+
+	const size_t nameIndex(messageTemplate->GetFieldIndex("name"));
+	const size_t orderIndex(messageTemplate->GetFieldIndex("order"));
+	const size_t dateIndex(messageTemplate->GetFieldIndex("date"));
+	Measure("Source, values by field index", [&](const Recipient &r)
+	{
+		std::vector<std::string> values(messageTemplate->GetFieldNames().size());
+		values[nameIndex] = r.name;
+		values[orderIndex] = r.order;
+		values[dateIndex] = r.date;
+		MessageTemplate::Source source(messageTemplate, std::move(values));
+		return read(source);
+	}, recipients);
+
+	EmailSender::Message message;
+	message.subject = "Your order has shipped";
+	message.bodyTemplate = messageTemplate;
+	message.recipients.resize(1);
+	Measure("complete message (Build)", [&](const Recipient &r)
+	{
+		message.recipients.front().address = "recipient@example.com";
+		message.recipients.front().displayName = r.name;
+		message.templateValues = messageTemplate->MakeValues({ { "name", r.name }, { "order", r.order }, { "date", r.date } });
+
+		PayloadReader payload;
+		MessageBuilder::Build(message, "sender@example.com", payload);
+		size_t size(0), length;
+		while ((length = payload.Read(buffer.data(), buffer.size())) > 0)
+			size += length;
+		return size;
+	}, recipients);
+
+	return 0;
+}
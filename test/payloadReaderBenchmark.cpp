@@ -0,0 +1,165 @@
+// File:  payloadReaderBenchmark.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Counts cURL read callbacks per megabyte of payload, comparing the
+//        previous one-line-per-callback reader with PayloadReader.
+
+// Local headers
+#include "payloadReader.h"
+
+// Standard C++ headers
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdio>
+
+// Linux headers
+#include <unistd.h>
+
+namespace
+{
+	const size_t bodySize(1 << 20);
+	const size_t attachmentSize(8 << 20);
+	const unsigned int passes(10);
+
+	struct Result
+	{
+		size_t callbacks = 0;
+		size_t bytes = 0;
+		double seconds = 0.0;
+	};
+
+	// The reader this replaced:  the payload was split into lines and each
+	// callback copied one of them
+	struct LineReader
+	{
+		const std::vector<std::string> *lines;
+		size_t linesRead = 0;
+
+		static size_t Callback(char *buffer, size_t size, size_t nmemb, void *userp)
+		{
+			LineReader *reader(static_cast<LineReader*>(userp));
+			if (size * nmemb < 1 || reader->linesRead == reader->lines->size())
+				return 0;
+
+			const std::string &line((*reader->lines)[reader->linesRead++]);
+			memcpy(buffer, line.c_str(), line.size());
+			return line.size();
+		}
+	};
+
+	template<typename Setup>
+	Result Run(curl_read_callback callback, const size_t &bufferSize, Setup setup)
+	{
+		std::vector<char> buffer(bufferSize);
+		Result result;
+		unsigned int pass;
+		for (pass = 0; pass < passes; ++pass)
+		{
+			void *userp(setup());
+			const auto start(std::chrono::steady_clock::now());
+			size_t length;
+			while ((length = callback(buffer.data(), 1, buffer.size(), userp)) > 0)
+			{
+				++result.callbacks;
+				result.bytes += length;
+			}
+
+			result.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		return result;
+	}
+
+	void Print(const std::string &name, const Result &result)
+	{
+		const double megabytes(result.bytes / 1048576.0);
+		std::cout << std::left << std::setw(28) << name << std::right
+			<< std::setw(12) << std::fixed << std::setprecision(1) << result.callbacks / megabytes
+			<< std::setw(12) << std::setprecision(0) << megabytes / result.seconds << std::endl;
+	}
+}
+
+int main()
+{
+	char attachmentPath[] = "/tmp/payloadReaderBenchmarkXXXXXX";
+	const int fd(mkstemp(attachmentPath));
+	if (fd < 0)
+	{
+		std::cerr << "Failed to create temporary file" << std::endl;
+		return 1;
+	}
+	close(fd);
+
+	std::mt19937 generator(1);
+	{
+		std::ofstream file(attachmentPath, std::ios::binary);
+		std::vector<char> data(attachmentSize);
+		for (auto& c : data)
+			c = static_cast<char>(generator());
+		file.write(data.data(), data.size());
+	}
+
+	std::string header("To: <recipient@example.com>\r\nFrom: <sender@example.com>\r\n"
+		"Subject: Benchmark\r\nMIME-Version: 1.0\r\n\r\n");
+	std::string body;
+	while (body.size() < bodySize)
+	{
+		std::string line(70, ' ');
+		for (auto& c : line)
+			c = static_cast<char>('a' + generator() % 26);
+		body.append(line).append("\r\n");
+	}
+
+	// Encoded in advance so that both readers only copy
+	PayloadReader payload;
+	payload.Append(std::make_unique<PayloadReader::Base64FileSource>(attachmentPath));
+	const std::string attachment(payload.ReadAll());
+	std::remove(attachmentPath);
+
+	auto setupPayload([&]()
+	{
+		payload.Clear();
+		payload.AppendText(header);
+		payload.AppendText(body);
+		payload.AppendText(attachment);
+		return static_cast<void*>(&payload);
+	});
+
+	std::vector<std::string> lines;
+	{
+		const std::string text(header + body + attachment);
+		std::string::size_type start(0), end;
+		while ((end = text.find('\n', start)) != std::string::npos)
+		{
+			lines.push_back(text.substr(start, end - start + 1));
+			start = end + 1;
+		}
+	}
+
+	LineReader lineReader;
+	auto setupLines([&]()
+	{
+		lineReader.lines = &lines;
+		lineReader.linesRead = 0;
+		return static_cast<void*>(&lineReader);
+	});
+
+	std::cout << "Payload:  " << header.size() + body.size() << " bytes of text and a "
+		<< attachmentSize << " byte attachment (" << attachment.size() << " bytes encoded), "
+		<< passes << " passes" << std::endl;
+	std::cout << std::left << std::setw(28) << "Reader" << std::right
+		<< std::setw(12) << "calls/MB" << std::setw(12) << "MB/s" << std::endl;
+
+	// CURL_MAX_WRITE_SIZE is libcurl's smallest upload buffer; 64 kB is its default
+	Print("line per callback (before)", Run(&LineReader::Callback, CURL_MAX_WRITE_SIZE, setupLines));
+	Print("PayloadReader, 16 kB buffer", Run(&PayloadReader::CURLReadCallback, CURL_MAX_WRITE_SIZE, setupPayload));
+	Print("PayloadReader, 64 kB buffer", Run(&PayloadReader::CURLReadCallback, 65536, setupPayload));
+
+	return 0;
+}
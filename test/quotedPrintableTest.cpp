@@ -0,0 +1,137 @@
+// File:  quotedPrintableTest.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Checks that QuotedPrintable::Source streams the same text as
+//        QuotedPrintable::Encode(), and reports its size correctly whether
+//        it is asked before, during or after reading.  Also checks the
+//        size with canonical line endings, which must not read the input
+//        a second time.
+
+// Local headers
+#include "quotedPrintable.h"
+#include "testUtilities.h"
+
+// Standard C++ headers
+#include <random>
+#include <string>
+#include <memory>
+
+namespace
+{
+	// Lines of varying length (some longer than a chunk), with characters
+	// which must be encoded and trailing whitespace
+	std::string MakeText()
+	{
+		std::mt19937 generator(1);
+		std::string text;
+		while (text.size() < 100000)
+		{
+			const size_t length(generator() % 300);
+			size_t i;
+			for (i = 0; i < length; ++i)
+			{
+				const unsigned int r(generator() % 100);
+				text.push_back(r < 80 ? static_cast<char>('a' + r % 26) : r < 90 ? ' ' : r < 95 ? '=' : static_cast<char>(0xE9));
+			}
+
+			if (generator() % 10 == 0)
+				text.append(std::string(20000, 'x'));
+			text.append(generator() % 2 == 0 ? "\n" : " \r\n");
+		}
+		return text;
+	}
+
+	std::unique_ptr<QuotedPrintable::Source> MakeSource(const std::string &text)
+	{
+		return std::make_unique<QuotedPrintable::Source>(std::unique_ptr<PayloadReader::Source>(
+			new PayloadReader::TextSource(text)));
+	}
+
+	// Counts what is read from the text
+	class CountingSource : public PayloadReader::TextSource
+	{
+	public:
+		CountingSource(std::string text, size_t &bytesRead) : TextSource(std::move(text)), bytesRead(bytesRead) {}
+
+		size_t Read(char *buffer, const size_t &size) override
+		{
+			const size_t length(TextSource::Read(buffer, size));
+			bytesRead += length;
+			return length;
+		}
+
+	private:
+		size_t &bytesRead;
+	};
+
+	// Bare "\n" written as "\r\n", ending with a line break
+	size_t GetCanonicalSize(const std::string &text)
+	{
+		size_t size(text.size());
+		size_t i;
+		for (i = 0; i < text.size(); ++i)
+		{
+			if (text[i] == '\n' && (i == 0 || text[i - 1] != '\r'))
+				++size;
+		}
+
+		if (!text.empty() && text.back() != '\n')
+			size += 2;
+		return size;
+	}
+
+	std::string ReadAll(PayloadReader::Source &source, const size_t &bufferSize)
+	{
+		std::string out;
+		std::string buffer(bufferSize, '\0');
+		size_t length;
+		while ((length = source.Read(&buffer[0], buffer.size())) > 0)
+			out.append(buffer, 0, length);
+		return out;
+	}
+}
+
+int main()
+{
+	const std::string text(MakeText());
+	const std::string expected(QuotedPrintable::Encode(text));
+
+	{
+		std::unique_ptr<QuotedPrintable::Source> source(MakeSource(text));
+		Test::Check(source->GetSize() == expected.size(), "Size before reading");
+		Test::Check(ReadAll(*source, 1000) == expected, "Text after asking for the size");
+		Test::Check(source->Rewind() && ReadAll(*source, 65536) == expected, "Text after rewinding");
+		Test::Check(source->GetSize() == expected.size(), "Size after rewinding");
+	}
+
+	{
+		std::unique_ptr<QuotedPrintable::Source> source(MakeSource(text));
+		std::string buffer(5000, '\0');
+		std::string out(buffer, 0, source->Read(&buffer[0], buffer.size()));
+		Test::Check(source->GetSize() == expected.size(), "Size partway through reading");
+		out.append(ReadAll(*source, 777));
+		Test::Check(out == expected, "Text read around asking for the size");
+	}
+
+	{
+		std::unique_ptr<QuotedPrintable::Source> source(MakeSource(text));
+		Test::Check(ReadAll(*source, 4096) == expected, "Text without asking for the size");
+		Test::Check(source->GetSize() == expected.size(), "Size after reading");
+	}
+
+	{
+		size_t bytesRead(0);
+		PayloadReader payload;
+		payload.AppendText("Subject: Test\r\nContent-Transfer-Encoding: quoted-printable\n\r");
+		payload.Append(std::make_unique<QuotedPrintable::Source>(std::unique_ptr<PayloadReader::Source>(
+			new CountingSource(text, bytesRead))));
+
+		size_t size(0);
+		Test::Check(payload.GetCanonicalSize(size) && payload.Rewind(), "Canonical size found");
+		const std::string out(payload.ReadAll());
+		Test::Check(size == GetCanonicalSize(out), "Canonical size matches the text");
+		Test::Check(bytesRead == text.size(), "Input read once");
+	}
+
+	return Test::Finish("quotedPrintableTest");
+}
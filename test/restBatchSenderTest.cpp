@@ -0,0 +1,337 @@
+// File:  restBatchSenderTest.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Sends batches to a stub HTTP server which returns canned batch
+//        responses, and checks how the responses are matched to messages.
+
+// Local headers
+#include "restBatchSender.h"
+#include "rateLimiter.h"
+#include "oAuth2Interface.h"
+#include "testUtilities.h"
+
+// Standard C++ headers
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstring>
+
+// Linux headers
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace
+{
+	struct Part
+	{
+		std::string contentID;// Empty to leave out the Content-ID field
+		long status;
+		std::string extraHeaders;
+	};
+
+	// Answers each request on a new connection with the response returned by respond
+	class StubHTTPServer
+	{
+	public:
+		explicit StubHTTPServer(std::function<std::string(const std::string&)> respond) : respond(std::move(respond))
+		{
+			listener = socket(AF_INET, SOCK_STREAM, 0);
+			sockaddr_in address{};
+			address.sin_family = AF_INET;
+			address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			socklen_t length(sizeof(address));
+			if (bind(listener, reinterpret_cast<sockaddr*>(&address), length) != 0 ||
+				listen(listener, 4) != 0 ||
+				getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+				return;
+
+			port = ntohs(address.sin_port);
+			thread = std::thread(&StubHTTPServer::Run, this);
+		}
+
+		~StubHTTPServer()
+		{
+			shutdown(listener, SHUT_RDWR);
+			if (thread.joinable())
+				thread.join();
+			close(listener);
+		}
+
+		unsigned short GetPort() const { return port; }
+
+		// Bodies, in the order received
+		std::vector<std::string> GetRequests()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			return requests;
+		}
+
+	private:
+		const std::function<std::string(const std::string&)> respond;
+		std::mutex mutex;
+		std::vector<std::string> requests;
+		int listener;
+		unsigned short port = 0;
+		std::thread thread;
+
+		void Run()
+		{
+			int connection;
+			while ((connection = accept(listener, nullptr, nullptr)) >= 0)
+			{
+				std::string request;
+				if (ReadRequest(connection, request))
+				{
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						requests.push_back(request);
+					}
+					Send(connection, respond(request));
+				}
+				close(connection);
+			}
+		}
+
+		static bool ReadRequest(const int &connection, std::string &body)
+		{
+			std::string received;
+			std::string::size_type headerEnd;
+			char buffer[4096];
+			ssize_t length;
+			while ((headerEnd = received.find("\r\n\r\n")) == std::string::npos)
+			{
+				if ((length = recv(connection, buffer, sizeof(buffer), 0)) <= 0)
+					return false;
+				received.append(buffer, length);
+			}
+
+			const std::string header(received.substr(0, headerEnd));
+			const std::string::size_type lengthField(header.find("Content-Length: "));
+			if (lengthField == std::string::npos)
+				return false;
+			const size_t contentLength(std::stoul(header.substr(lengthField + 16)));
+
+			if (header.find("Expect: 100-continue") != std::string::npos)
+				Send(connection, "HTTP/1.1 100 Continue\r\n\r\n");
+
+			body = received.substr(headerEnd + 4);
+			while (body.size() < contentLength)
+			{
+				if ((length = recv(connection, buffer, sizeof(buffer), 0)) <= 0)
+					return false;
+				body.append(buffer, length);
+			}
+
+			return true;
+		}
+
+		static void Send(const int &connection, const std::string &data)
+		{
+			size_t sent(0);
+			ssize_t length;
+			while (sent < data.size() && (length = send(connection, data.data() + sent, data.size() - sent, MSG_NOSIGNAL)) > 0)
+				sent += length;
+		}
+	};
+
+	std::string MakeBatchResponse(const std::vector<Part> &parts)
+	{
+		const std::string boundary("batch_stub_boundary");
+		std::string body;
+		for (const auto& p : parts)
+		{
+			const std::string json(p.status < 300 ? "{\"id\":\"1\"}" : "{\"error\":{\"code\":" + std::to_string(p.status) + "}}");
+			body.append("--" + boundary + "\r\n");
+			body.append("Content-Type: application/http\r\n");
+			if (!p.contentID.empty())
+				body.append("Content-ID: " + p.contentID + "\r\n");
+			body.append("\r\n");
+			body.append("HTTP/1.1 " + std::to_string(p.status) + (p.status < 300 ? " OK" : " Error") + "\r\n");
+			body.append("Content-Type: application/json; charset=UTF-8\r\n");
+			body.append(p.extraHeaders);
+			body.append("\r\n");
+			body.append(json + "\r\n");
+		}
+		body.append("--" + boundary + "--\r\n");
+
+		return "HTTP/1.1 200 OK\r\n"
+			"Content-Type: multipart/mixed; boundary=" + boundary + "\r\n"
+			"Content-Length: " + std::to_string(body.size()) + "\r\n"
+			"Connection: close\r\n"
+			"\r\n" + body;
+	}
+
+	std::vector<std::string> GetRequestContentIDs(const std::string &request)
+	{
+		std::vector<std::string> ids;
+		std::string::size_type position(0);
+		while ((position = request.find("Content-ID: ", position)) != std::string::npos)
+		{
+			position += 12;
+			ids.push_back(request.substr(position, request.find("\r\n", position) - position));
+		}
+		return ids;
+	}
+
+	std::vector<EmailSender::Message> MakeMessages(const std::vector<size_t> &recipientCounts)
+	{
+		std::vector<EmailSender::Message> messages(recipientCounts.size());
+		size_t i, j;
+		for (i = 0; i < messages.size(); ++i)
+		{
+			messages[i].subject = "Message " + std::to_string(i + 1);
+			messages[i].message = "Body of message " + std::to_string(i + 1);
+			for (j = 0; j < recipientCounts[i]; ++j)
+				messages[i].recipients.push_back({ "r" + std::to_string(j) + "@example.com", "" });
+		}
+		return messages;
+	}
+
+	EmailSender::LoginInfo MakeLoginInfo()
+	{
+		EmailSender::LoginInfo loginInfo;
+		loginInfo.smtpUrl = "https://gmail.googleapis.com/gmail/v1/users/me/messages/send";
+		loginInfo.localEmail = "sender@example.com";
+		return loginInfo;
+	}
+
+	// Responses in a different order than the requests, matched by Content-ID
+	void CheckContentIDMapping(std::ostream &log)
+	{
+		StubHTTPServer server([](const std::string&)
+		{
+			return MakeBatchResponse({
+				{ "<response-item4>", 429, "Retry-After: 7\r\n" },
+				{ "<response-item2>", 400, "" },
+				{ "<response-item1>", 200, "" },
+				{ "<response-item3>", 200, "" } });
+		});
+
+		RateLimiter::Limits limits;
+		limits.throttleBackoffMs = 60000;
+		EmailSender::LoginInfo loginInfo(MakeLoginInfo());
+		loginInfo.rateLimiter = std::make_shared<RateLimiter>(limits);
+
+		RESTBatchSender sender(loginInfo, false, log);
+		sender.SetBatchURL("http://127.0.0.1:" + std::to_string(server.GetPort()) + "/batch/gmail/v1");
+		const std::vector<SendResult> results(sender.Send(MakeMessages({ 1, 1, 1, 1 })));
+		const std::vector<std::string> requests(server.GetRequests());
+
+		if (!Test::Check(requests.size() == 1 && results.size() == 4, "Mapping:  one batch request"))
+			return;
+
+		const std::vector<std::string> ids(GetRequestContentIDs(requests.front()));
+		Test::Check(ids == std::vector<std::string>({ "<item1>", "<item2>", "<item3>", "<item4>" }), "Mapping:  request Content-IDs");
+		Test::Check(requests.front().find("POST /gmail/v1/users/me/messages/send\r\n") != std::string::npos,
+			"Mapping:  request path is taken from smtpUrl");
+
+		Test::Check(results[0].success && results[0].responseCode == 200, "Mapping:  item 1 succeeded");
+		Test::Check(!results[1].success && results[1].responseCode == 400 && !results[1].IsTransient(), "Mapping:  item 2 rejected");
+		Test::Check(results[2].success && results[2].responseCode == 200, "Mapping:  item 3 succeeded");
+		Test::Check(!results[3].success && results[3].responseCode == 429 && results[3].IsTransient(), "Mapping:  item 4 throttled");
+		Test::Check(results[3].retryAfterMs == 7000, "Mapping:  item 4 Retry-After");
+
+		unsigned int waitMs;
+		Test::Check(!loginInfo.rateLimiter->TryAcquire(1, waitMs) && waitMs > 0, "Mapping:  429 reported to the rate limiter");
+	}
+
+	// Parts without Content-IDs are matched in order, skipping the deferred message
+	void CheckOrderMappingWithDeferred(std::ostream &log)
+	{
+		StubHTTPServer server([](const std::string &request)
+		{
+			std::vector<Part> parts;
+			const std::vector<long> statuses({ 200, 403, 404, 200 });
+			size_t i;
+			for (i = 0; i < GetRequestContentIDs(request).size() && i < statuses.size(); ++i)
+				parts.push_back({ "", statuses[i], "" });
+			return MakeBatchResponse(parts);
+		});
+
+		// The third message has too many recipients for the daily budget
+		RateLimiter::Limits limits;
+		limits.dailyRecipientLimit = 5;
+		limits.maxWaitMs = 0;
+		EmailSender::LoginInfo loginInfo(MakeLoginInfo());
+		loginInfo.rateLimiter = std::make_shared<RateLimiter>(limits);
+
+		RESTBatchSender sender(loginInfo, false, log);
+		sender.SetBatchURL("http://127.0.0.1:" + std::to_string(server.GetPort()) + "/batch/gmail/v1");
+		const std::vector<SendResult> results(sender.Send(MakeMessages({ 1, 1, 6, 1, 1 })));
+		const std::vector<std::string> requests(server.GetRequests());
+
+		if (!Test::Check(requests.size() == 1 && results.size() == 5, "Deferred:  one batch request"))
+			return;
+
+		const std::vector<std::string> ids(GetRequestContentIDs(requests.front()));
+		Test::Check(ids == std::vector<std::string>({ "<item1>", "<item2>", "<item4>", "<item5>" }),
+			"Deferred:  deferred message left out of the request");
+
+		Test::Check(results[0].success && results[0].responseCode == 200, "Deferred:  item 1 succeeded");
+		Test::Check(!results[1].success && results[1].responseCode == 403, "Deferred:  item 2 rejected");
+		Test::Check(results[2].deferred && !results[2].success && results[2].responseCode == 0, "Deferred:  item 3 deferred");
+		Test::Check(!results[3].success && results[3].responseCode == 404, "Deferred:  item 4 matched by order");
+		Test::Check(results[4].success && results[4].responseCode == 200, "Deferred:  item 5 matched by order");
+	}
+
+	// Items missing from the response are failures, and a failed batch fails every item
+	void CheckMissingAndFailedResponses(std::ostream &log)
+	{
+		{
+			StubHTTPServer server([](const std::string&)
+			{
+				return MakeBatchResponse({ { "<response-item2>", 200, "" } });
+			});
+
+			RESTBatchSender sender(MakeLoginInfo(), false, log);
+			sender.SetBatchURL("http://127.0.0.1:" + std::to_string(server.GetPort()) + "/batch/gmail/v1");
+			const std::vector<SendResult> results(sender.Send(MakeMessages({ 1, 1 })));
+			Test::Check(results.size() == 2 && !results[0].success && results[0].responseCode == 0 &&
+				results[1].success, "Missing:  unanswered item fails");
+		}
+
+		{
+			StubHTTPServer server([](const std::string&)
+			{
+				return std::string("HTTP/1.1 429 Too Many Requests\r\nRetry-After: 3\r\n"
+					"Content-Length: 0\r\nConnection: close\r\n\r\n");
+			});
+
+			RESTBatchSender sender(MakeLoginInfo(), false, log);
+			sender.SetBatchURL("http://127.0.0.1:" + std::to_string(server.GetPort()) + "/batch/gmail/v1");
+			const std::vector<SendResult> results(sender.Send(MakeMessages({ 1, 1 })));
+			Test::Check(results.size() == 2 && results[0].responseCode == 429 && results[1].responseCode == 429 &&
+				results[1].retryAfterMs == 3000 && results[1].IsTransient(), "Failed batch:  429 applies to every item");
+		}
+	}
+}
+
+int main()
+{
+	// The token endpoint refuses every request, so the batches are sent without an access token
+	StubHTTPServer tokenServer([](const std::string&)
+	{
+		return std::string("HTTP/1.1 401 Unauthorized\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+	});
+
+	std::ostringstream log;
+	OAuth2Interface::Get().SetLoggingTarget(log);
+	OAuth2Interface::Get().SetTokenURL("http://127.0.0.1:" + std::to_string(tokenServer.GetPort()) + "/token");
+	OAuth2Interface::Get().SetClientID("client");
+	OAuth2Interface::Get().SetClientSecret("secret");
+	OAuth2Interface::Get().SetRefreshToken("refresh");
+
+	CheckContentIDMapping(log);
+	CheckOrderMappingWithDeferred(log);
+	CheckMissingAndFailedResponses(log);
+
+	if (Test::GetFailureCount() > 0)
+		std::cerr << "Log:\n" << log.str() << std::endl;
+
+	return Test::Finish("restBatchSenderTest");
+}
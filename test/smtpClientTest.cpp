@@ -0,0 +1,381 @@
+// File:  smtpClientTest.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Sends messages with SMTPClient to a stub SMTP server, with and
+//        without PIPELINING and CHUNKING, and checks recipient and SIZE
+//        rejections, dropped connections, split recipient lists and
+//        STARTTLS.
+
+// Local headers
+#include "smtpClient.h"
+#include "stubSMTPServer.h"
+#include "testUtilities.h"
+
+// Standard C++ headers
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <cstdlib>
+
+namespace
+{
+	const std::string smallBody("Subject: Stub test\n\nFirst line\n.Leading period\nLast line without a newline");
+
+	// Several chunks' worth, with periods to stuff
+	std::string MakeLargeBody()
+	{
+		std::string body("Subject: Large stub test\n\n");
+		unsigned int i;
+		for (i = 0; i < 40; ++i)
+			body.append((i % 5 == 0 ? "." : "") + std::string(60, static_cast<char>('a' + i % 26)) + "\n");
+		return body;
+	}
+
+	// As the server should receive it
+	std::string Canonicalize(const std::string &body)
+	{
+		std::string canonical;
+		for (const auto& c : body)
+		{
+			if (c == '\n')
+				canonical.push_back('\r');
+			canonical.push_back(c);
+		}
+
+		if (canonical.empty() || canonical.back() != '\n')
+			canonical.append("\r\n");
+		return canonical;
+	}
+
+	EmailSender::LoginInfo MakeLoginInfo(const StubSMTPServer &server)
+	{
+		EmailSender::LoginInfo loginInfo;
+		loginInfo.smtpUrl = server.GetURL();
+		loginInfo.localEmail = "sender@example.com";
+		loginInfo.useSSL = false;
+		return loginInfo;
+	}
+
+	bool Send(SMTPClient &client, const std::vector<std::string> &addresses, const std::string &body)
+	{
+		std::vector<EmailSender::AddressInfo> recipients;
+		for (const auto& a : addresses)
+			recipients.push_back({ a, "" });
+
+		PayloadReader payload;
+		payload.AppendText(body);
+		return client.Send(recipients, payload);
+	}
+
+	size_t CountCommands(StubSMTPServer &server, const std::string &verb)
+	{
+		const std::vector<StubSMTPServer::Command> commands(server.GetCommands());
+		return std::count_if(commands.begin(), commands.end(), [&verb](const StubSMTPServer::Command &c)
+		{
+			return c.line.compare(0, verb.size(), verb) == 0;
+		});
+	}
+
+	void CheckTransfer(const bool &pipelining, const bool &chunking, std::ostream &log)
+	{
+		const std::string name(std::string(pipelining ? "PIPELINING" : "No PIPELINING")
+			+ (chunking ? ", CHUNKING:  " : ", no CHUNKING:  "));
+		StubSMTPServer::Options options;
+		options.pipelining = pipelining;
+		options.chunking = chunking;
+		options.maxSize = 1000000;
+		StubSMTPServer server(options);
+		const std::string largeBody(MakeLargeBody());
+
+		{
+			SMTPClient client(MakeLoginInfo(server), false, log);
+			client.SetTimeout(10);
+			client.SetChunkSize(256);
+			Test::Check(Send(client, { "a@example.com", "b@example.com" }, smallBody), name + "small message sent");
+			Test::Check(Send(client, { "a@example.com" }, largeBody), name + "large message sent");
+			Test::Check(client.GetExtensions().pipelining == pipelining && client.GetExtensions().chunking == chunking,
+				name + "extensions read from EHLO");
+		}
+
+		const std::vector<StubSMTPServer::Message> messages(server.GetMessages());
+		if (!Test::Check(messages.size() == 2, name + "two messages received"))
+			return;
+
+		Test::Check(messages[0].from == "sender@example.com" &&
+			messages[0].recipients == std::vector<std::string>({ "a@example.com", "b@example.com" }), name + "envelope");
+		Test::Check(messages[0].content == Canonicalize(smallBody), name + "small message content");
+		Test::Check(messages[1].content == Canonicalize(largeBody), name + "large message content");
+		Test::Check(messages[0].chunked == chunking && messages[1].chunked == chunking, name + "BDAT used only with CHUNKING");
+		// RFC 1870 counts CRLF line endings, but not periods doubled for DATA
+		Test::Check(messages[0].declaredSize == static_cast<long>(messages[0].content.size()) &&
+			messages[1].declaredSize == static_cast<long>(messages[1].content.size()), name + "declared SIZE matches the message");
+		if (!chunking)
+			Test::Check(messages[1].wireSize > messages[1].content.size(), name + "periods doubled for DATA");
+		Test::Check(server.GetConnectionCount() == 1, name + "connection reused");
+
+		if (pipelining)
+			Test::Check(server.GetMaxPipelinedCommands() >= 4, name + "envelope pipelined");
+		else
+			Test::Check(server.GetMaxPipelinedCommands() == 1, name + "no commands pipelined");
+
+		if (chunking)
+			Test::Check(CountCommands(server, "BDAT") > 2, name + "large body sent in several chunks");
+	}
+
+	void CheckRecipientRejects(std::ostream &log)
+	{
+		StubSMTPServer::Options options;
+		options.rejectedRecipients = { "bad@example.com", "worse@example.com" };
+		StubSMTPServer server(options);
+
+		{
+			SMTPClient client(MakeLoginInfo(server), false, log);
+			client.SetTimeout(10);
+			Test::Check(Send(client, { "a@example.com", "bad@example.com", "c@example.com" }, smallBody),
+				"Recipients:  message sent to the accepted recipients");
+
+			const std::vector<SMTPProtocol::RecipientResult> &results(client.GetRecipientResults());
+			Test::Check(results.size() == 3 && results[0].reply.code == 250 && results[1].reply.code == 550 &&
+				results[2].reply.code == 250 && results[1].address == "bad@example.com", "Recipients:  reply for each recipient");
+
+			Test::Check(!Send(client, { "bad@example.com", "worse@example.com" }, smallBody),
+				"Recipients:  message with no accepted recipients fails");
+			Test::Check(client.GetLastResult().responseCode == 550 && !client.GetLastResult().IsTransient(),
+				"Recipients:  permanent failure reported");
+
+			Test::Check(Send(client, { "d@example.com" }, smallBody), "Recipients:  session continues after a rejection");
+		}
+
+		const std::vector<StubSMTPServer::Message> messages(server.GetMessages());
+		Test::Check(messages.size() == 2 && messages[0].recipients == std::vector<std::string>({ "a@example.com", "c@example.com" }),
+			"Recipients:  only accepted recipients delivered");
+		Test::Check(server.GetConnectionCount() == 1, "Recipients:  connection reused");
+	}
+
+	void CheckSizeReject(std::ostream &log)
+	{
+		StubSMTPServer::Options options;
+		options.maxSize = 200;
+		StubSMTPServer server(options);
+
+		{
+			SMTPClient client(MakeLoginInfo(server), false, log);
+			client.SetTimeout(10);
+			Test::Check(!Send(client, { "a@example.com" }, MakeLargeBody()), "SIZE:  oversized message fails");
+			Test::Check(client.GetLastResult().curlCode == CURLE_FILESIZE_EXCEEDED &&
+				client.GetLastResult().responseCode == 552, "SIZE:  rejected with 552");
+			Test::Check(Send(client, { "a@example.com" }, smallBody), "SIZE:  smaller message sent");
+		}
+
+		Test::Check(CountCommands(server, "MAIL") == 1, "SIZE:  oversized message not offered to the server");
+		Test::Check(server.GetMessages().size() == 1, "SIZE:  one message received");
+	}
+
+	// Can be read once, but not rewound
+	class OneShotSource : public PayloadReader::Source
+	{
+	public:
+		explicit OneShotSource(std::string text) : text(std::move(text)) {}
+
+		size_t Read(char *buffer, const size_t &size) override
+		{
+			const size_t length(std::min(size, text.size() - position));
+			text.copy(buffer, length, position);
+			position += length;
+			return length;
+		}
+
+		bool Rewind() override { return position == 0; }
+		size_t GetSize() override { return text.size(); }
+
+	private:
+		const std::string text;
+		size_t position = 0;
+	};
+
+	void CheckRewindFailure(std::ostream &log)
+	{
+		StubSMTPServer::Options options;
+		options.maxSize = 1000000;
+		StubSMTPServer server(options);
+
+		{
+			SMTPClient client(MakeLoginInfo(server), false, log);
+			client.SetTimeout(10);
+			PayloadReader payload;
+			payload.Append(std::unique_ptr<PayloadReader::Source>(new OneShotSource(smallBody)));
+			Test::Check(!client.Send({ { "a@example.com", "" } }, payload) &&
+				client.GetLastResult().curlCode == CURLE_READ_ERROR, "Rewind:  fails when the payload can not be rewound");
+			Test::Check(Send(client, { "a@example.com" }, smallBody), "Rewind:  next message sent");
+		}
+
+		Test::Check(CountCommands(server, "MAIL") == 1 && server.GetMessages().size() == 1,
+			"Rewind:  unreadable message not offered to the server");
+	}
+
+	void CheckDroppedConnection(const StubSMTPServer::Drop &drop, std::ostream &log)
+	{
+		const std::string name(drop == StubSMTPServer::Drop::Close ? "Dropped:  " : "421:  ");
+		StubSMTPServer::Options options;
+		options.dropAfterMessages = 1;
+		options.drop = drop;
+		StubSMTPServer server(options);
+
+		{
+			SMTPClient client(MakeLoginInfo(server), false, log);
+			client.SetTimeout(10);
+			Test::Check(Send(client, { "a@example.com" }, smallBody), name + "first message sent");
+			Test::Check(Send(client, { "b@example.com" }, smallBody), name + "second message sent after reconnecting");
+			Test::Check(Send(client, { "c@example.com" }, smallBody), name + "third message sent after reconnecting");
+		}
+
+		const std::vector<StubSMTPServer::Message> messages(server.GetMessages());
+		Test::Check(messages.size() == 3 && messages[1].recipients.front() == "b@example.com" &&
+			messages[1].content == Canonicalize(smallBody), name + "each message received once");
+		Test::Check(server.GetConnectionCount() == 3, name + "new connection for each dropped one");
+	}
+
+	// Header field value from the received message
+	std::string GetField(const std::string &message, const std::string &name)
+	{
+		const std::string content("\r\n" + message);
+		const std::string::size_type start(content.find("\r\n" + name + ": "));
+		if (start == std::string::npos)
+			return std::string();
+
+		const std::string::size_type valueStart(start + name.size() + 4);
+		return content.substr(valueStart, content.find("\r\n", valueStart) - valueStart);
+	}
+
+	// Transactions carrying the same message to different recipients share
+	// its Date and Message-ID, but sending it again generates new ones
+	void CheckSplitRecipients(std::ostream &log)
+	{
+		StubSMTPServer server((StubSMTPServer::Options()));
+		const EmailSender::LoginInfo loginInfo(MakeLoginInfo(server));
+
+		EmailSender::Message message;
+		message.subject = "Split test";
+		message.message = "Body";
+		unsigned int i;
+		for (i = 0; i < 5; ++i)
+			message.recipients.push_back({ "r" + std::to_string(i + 1) + "@example.com", "" });
+
+		{
+			SMTPClient client(loginInfo, false, log);
+			client.SetTimeout(10);
+			EmailSender sender(message, loginInfo, false, log);
+			sender.SetMaxRecipientsPerTransaction(2);
+			Test::Check(sender.Send(client), "Split:  message sent");
+			Test::Check(sender.Send(client), "Split:  message sent again");
+		}
+
+		const std::vector<StubSMTPServer::Message> messages(server.GetMessages());
+		if (!Test::Check(messages.size() == 6, "Split:  three transactions for each send"))
+			return;
+
+		const std::string date(GetField(messages[0].content, "Date"));
+		const std::string messageID(GetField(messages[0].content, "Message-ID"));
+		Test::Check(!date.empty() && !messageID.empty(), "Split:  Date and Message-ID present");
+		Test::Check(std::all_of(messages.begin(), messages.begin() + 3, [&date, &messageID](const StubSMTPServer::Message &m)
+		{
+			return GetField(m.content, "Date") == date && GetField(m.content, "Message-ID") == messageID;
+		}), "Split:  same Date and Message-ID in every transaction");
+
+		const std::string secondID(GetField(messages[3].content, "Message-ID"));
+		Test::Check(secondID != messageID && std::all_of(messages.begin() + 3, messages.end(), [&secondID](const StubSMTPServer::Message &m)
+		{
+			return GetField(m.content, "Message-ID") == secondID;
+		}), "Split:  new Message-ID for the second send");
+	}
+
+	void CheckStartTLS(std::ostream &log)
+	{
+		char directoryTemplate[] = "/tmp/smtpClientTestXXXXXX";
+		const char *directory(mkdtemp(directoryTemplate));
+		if (!Test::Check(directory != nullptr, "STARTTLS:  temporary directory created"))
+			return;
+
+		{
+			StubSMTPServer::Options options;
+			options.startTLS = true;
+			StubSMTPServer server(options);
+			if (!Test::Check(server.SaveCertificate(directory), "STARTTLS:  certificate saved"))
+				return;
+
+			EmailSender::LoginInfo loginInfo(MakeLoginInfo(server));
+			loginInfo.useSSL = true;
+			loginInfo.password = "secret";
+			loginInfo.caCertificatePath = directory;
+
+			{
+				SMTPClient client(loginInfo, false, log);
+				client.SetTimeout(10);
+				Test::Check(Send(client, { "a@example.com" }, smallBody), "STARTTLS:  message sent");
+				Test::Check(!client.GetExtensions().startTLS && client.GetExtensions().pipelining,
+					"STARTTLS:  extensions read from the second EHLO");
+				Test::Check(Send(client, { "b@example.com" }, MakeLargeBody()), "STARTTLS:  second message sent");
+			}
+
+			const std::vector<StubSMTPServer::Command> commands(server.GetCommands());
+			const bool authInClear(std::any_of(commands.begin(), commands.end(), [](const StubSMTPServer::Command &c)
+			{
+				return c.line.compare(0, 4, "AUTH") == 0 && !c.tls;
+			}));
+
+			const std::vector<StubSMTPServer::Message> messages(server.GetMessages());
+			Test::Check(CountCommands(server, "STARTTLS") == 1 && CountCommands(server, "EHLO") == 2,
+				"STARTTLS:  EHLO, STARTTLS, EHLO");
+			Test::Check(CountCommands(server, "AUTH") == 1 && !authInClear, "STARTTLS:  authenticated after the upgrade");
+			Test::Check(messages.size() == 2 && messages[0].tls && messages[1].tls &&
+				messages[1].content == Canonicalize(MakeLargeBody()), "STARTTLS:  messages received over TLS");
+
+			// Without the stub's certificate, the server is not trusted
+			loginInfo.caCertificatePath.clear();
+			SMTPClient client(loginInfo, false, log);
+			client.SetTimeout(10);
+			Test::Check(!Send(client, { "a@example.com" }, smallBody) &&
+				client.GetLastResult().curlCode == CURLE_PEER_FAILED_VERIFICATION, "STARTTLS:  untrusted certificate rejected");
+			Test::Check(CountCommands(server, "AUTH") == 1, "STARTTLS:  no credentials sent to an untrusted server");
+		}
+
+		{
+			StubSMTPServer server((StubSMTPServer::Options()));
+			EmailSender::LoginInfo loginInfo(MakeLoginInfo(server));
+			loginInfo.useSSL = true;
+			loginInfo.password = "secret";
+
+			SMTPClient client(loginInfo, false, log);
+			client.SetTimeout(10);
+			Test::Check(!Send(client, { "a@example.com" }, smallBody) &&
+				client.GetLastResult().curlCode == CURLE_USE_SSL_FAILED, "STARTTLS:  required but not offered");
+			Test::Check(CountCommands(server, "AUTH") == 0, "STARTTLS:  no credentials sent without TLS");
+		}
+
+		std::filesystem::remove_all(directory);
+	}
+}
+
+int main()
+{
+	std::ostringstream log;
+
+	CheckTransfer(true, true, log);
+	CheckTransfer(true, false, log);
+	CheckTransfer(false, true, log);
+	CheckTransfer(false, false, log);
+	CheckRecipientRejects(log);
+	CheckSizeReject(log);
+	CheckRewindFailure(log);
+	CheckDroppedConnection(StubSMTPServer::Drop::Close, log);
+	CheckDroppedConnection(StubSMTPServer::Drop::Reply421, log);
+	CheckSplitRecipients(log);
+	CheckStartTLS(log);
+
+	if (Test::GetFailureCount() > 0)
+		std::cerr << "Log:\n" << log.str() << std::endl;
+
+	return Test::Finish("smtpClientTest");
+}
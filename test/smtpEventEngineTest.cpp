@@ -0,0 +1,279 @@
+// File:  smtpEventEngineTest.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Sends messages with SMTPEventEngine to a stub SMTP server which
+//        closes idle connections, and checks that a session held back by
+//        the rate limiter notices the server closing it.  Also checks
+//        several messages sent at once over pipelined sessions, that long
+//        recipient lists are split over several transactions, and that a
+//        message rejected before it is sent is not counted by the rate
+//        limiter.
+
+// Local headers
+#include "smtpEventEngine.h"
+#include "rateLimiter.h"
+#include "stubSMTPServer.h"
+#include "testUtilities.h"
+
+// Standard C++ headers
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <algorithm>
+
+namespace
+{
+	std::vector<StubSMTPServer::Command> GetCommands(StubSMTPServer &server, const std::string &verb)
+	{
+		std::vector<StubSMTPServer::Command> commands(server.GetCommands());
+		commands.erase(std::remove_if(commands.begin(), commands.end(), [&verb](const StubSMTPServer::Command &c)
+		{
+			return c.line.compare(0, verb.size(), verb) != 0;
+		}), commands.end());
+		return commands;
+	}
+
+	// The second message is held for about a second, and the server closes
+	// the connection (with 421) partway through
+	void CheckHeldSessionClosed(std::ostream &log)
+	{
+		StubSMTPServer::Options serverOptions;
+		serverOptions.idleTimeoutMs = 600;
+		StubSMTPServer server(serverOptions);
+
+		RateLimiter::Limits limits;
+		limits.messagesPerSecond = 1.0;
+		EmailSender::LoginInfo loginInfo;
+		loginInfo.smtpUrl = server.GetURL();
+		loginInfo.localEmail = "sender@example.com";
+		loginInfo.useSSL = false;
+		loginInfo.rateLimiter = std::make_shared<RateLimiter>(limits);
+
+		SMTPEventEngine::Options options;
+		options.loopCount = 1;
+		options.sessionsPerLoop = 1;
+		options.timeoutSeconds = 10;
+
+		std::mutex mutex;
+		std::vector<SendResult> results;
+		{
+			SMTPEventEngine engine(loginInfo, false, options, log);
+			unsigned int i;
+			for (i = 0; i < 2; ++i)
+			{
+				EmailSender::Message message;
+				message.subject = "Held session test " + std::to_string(i + 1);
+				message.message = "Body";
+				message.recipients.push_back({ "r" + std::to_string(i + 1) + "@example.com", "" });
+				engine.Add(std::make_unique<EmailSender>(message, loginInfo, false, log),
+					[&mutex, &results](const SendResult &result, const std::vector<SMTPProtocol::RecipientResult>&)
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					results.push_back(result);
+				});
+			}
+
+			engine.Wait();
+		}
+
+		// While held, nothing more is sent on the first connection; once the
+		// server closes it, the second message goes over a new one
+		const std::vector<StubSMTPServer::Command> mailCommands(GetCommands(server, "MAIL"));
+		const std::vector<StubSMTPServer::Command> allCommands(server.GetCommands());
+		Test::Check(results.size() == 2 && results[0].success && results[1].success, "Held:  both messages sent");
+		Test::Check(server.GetMessages().size() == 2 && mailCommands.size() == 2, "Held:  each message sent once");
+		Test::Check(server.GetConnectionCount() >= 2, "Held:  new connection after the server closed the held one");
+		Test::Check(mailCommands.size() == 2 && mailCommands[0].connection == 1 && mailCommands[1].connection > 1,
+			"Held:  second message waited for the rate limiter and was sent over a new connection");
+		Test::Check(allCommands.size() >= 4 && allCommands[3].line.compare(0, 5, "BDAT ") == 0 &&
+			std::none_of(allCommands.begin() + 4, allCommands.end(), [](const StubSMTPServer::Command &c)
+		{
+			return c.connection == 1;
+		}), "Held:  nothing sent on the held connection");
+		Test::Check(std::none_of(allCommands.begin(), allCommands.end(), [](const StubSMTPServer::Command &c)
+		{
+			return c.line == "NOOP" || c.line == "RSET";
+		}), "Held:  connections not polled while held");
+	}
+
+	// Messages added together are spread over several sessions, each of
+	// which pipelines its commands
+	void CheckConcurrentSessions(std::ostream &log)
+	{
+		StubSMTPServer::Options serverOptions;
+		serverOptions.chunking = false;
+		StubSMTPServer server(serverOptions);
+
+		EmailSender::LoginInfo loginInfo;
+		loginInfo.smtpUrl = server.GetURL();
+		loginInfo.localEmail = "sender@example.com";
+		loginInfo.useSSL = false;
+
+		SMTPEventEngine::Options options;
+		options.loopCount = 1;
+		options.sessionsPerLoop = 4;
+		options.timeoutSeconds = 10;
+
+		const unsigned int messageCount(12);
+		std::mutex mutex;
+		std::vector<SendResult> results;
+		{
+			SMTPEventEngine engine(loginInfo, false, options, log);
+			unsigned int i;
+			for (i = 0; i < messageCount; ++i)
+			{
+				EmailSender::Message message;
+				message.subject = "Concurrent test " + std::to_string(i + 1);
+				message.message = "Body " + std::to_string(i + 1);
+				message.recipients.push_back({ "r" + std::to_string(i + 1) + "@example.com", "" });
+				message.recipients.push_back({ "copy@example.com", "" });
+				engine.Add(std::make_unique<EmailSender>(message, loginInfo, false, log),
+					[&mutex, &results](const SendResult &result, const std::vector<SMTPProtocol::RecipientResult>&)
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					results.push_back(result);
+				});
+			}
+
+			engine.Wait();
+		}
+
+		std::set<std::string> subjects;
+		const std::vector<StubSMTPServer::Message> messages(server.GetMessages());
+		for (const auto& m : messages)
+		{
+			const std::string::size_type start(m.content.find("Subject: "));
+			if (start != std::string::npos)
+				subjects.insert(m.content.substr(start, m.content.find('\r', start) - start));
+		}
+
+		const std::vector<StubSMTPServer::Command> mailCommands(GetCommands(server, "MAIL"));
+		Test::Check(results.size() == messageCount && std::all_of(results.begin(), results.end(), [](const SendResult &r)
+		{
+			return r.success;
+		}), "Concurrent:  all messages sent");
+		Test::Check(messages.size() == messageCount && subjects.size() == messageCount &&
+			mailCommands.size() == messageCount, "Concurrent:  each message received once");
+		Test::Check(server.GetMaxOpenConnections() > 1 && server.GetConnectionCount() <= options.sessionsPerLoop,
+			"Concurrent:  several sessions open at once, up to the limit");
+		Test::Check(server.GetMaxPipelinedCommands() >= 4, "Concurrent:  envelope pipelined");
+		Test::Check(std::all_of(messages.begin(), messages.end(), [](const StubSMTPServer::Message &m)
+		{
+			return m.recipients.size() == 2;
+		}), "Concurrent:  every recipient accepted");
+	}
+
+	// A long recipient list is split over several transactions on the same
+	// connection, with the reply for each recipient reported
+	void CheckSplitRecipients(std::ostream &log)
+	{
+		StubSMTPServer::Options serverOptions;
+		serverOptions.rejectedRecipients = { "r3@example.com" };
+		StubSMTPServer server(serverOptions);
+
+		EmailSender::LoginInfo loginInfo;
+		loginInfo.smtpUrl = server.GetURL();
+		loginInfo.localEmail = "sender@example.com";
+		loginInfo.useSSL = false;
+
+		SMTPEventEngine::Options options;
+		options.loopCount = 1;
+		options.sessionsPerLoop = 1;
+		options.timeoutSeconds = 10;
+
+		SendResult result;
+		std::vector<SMTPProtocol::RecipientResult> recipientResults;
+		{
+			SMTPEventEngine engine(loginInfo, false, options, log);
+			EmailSender::Message message;
+			message.subject = "Split test";
+			message.message = "Body";
+			unsigned int i;
+			for (i = 0; i < 5; ++i)
+				message.recipients.push_back({ "r" + std::to_string(i + 1) + "@example.com", "" });
+
+			std::unique_ptr<EmailSender> sender(std::make_unique<EmailSender>(message, loginInfo, false, log));
+			sender->SetMaxRecipientsPerTransaction(2);
+			engine.Add(std::move(sender), [&result, &recipientResults](const SendResult &r,
+				const std::vector<SMTPProtocol::RecipientResult> &recipients)
+			{
+				result = r;
+				recipientResults = recipients;
+			});
+			engine.Wait();
+		}
+
+		const std::vector<StubSMTPServer::Message> messages(server.GetMessages());
+		Test::Check(result.success, "Split:  message sent");
+		Test::Check(messages.size() == 3 && messages[0].recipients.size() == 2 && messages[1].recipients.size() == 1 &&
+			messages[2].recipients.size() == 1, "Split:  three transactions of up to two recipients");
+		Test::Check(server.GetConnectionCount() == 1, "Split:  one connection");
+		Test::Check(recipientResults.size() == 5 && recipientResults[2].address == "r3@example.com" &&
+			recipientResults[2].reply.code == 550 && std::all_of(recipientResults.begin(), recipientResults.end(),
+			[](const SMTPProtocol::RecipientResult &r)
+		{
+			return r.address == "r3@example.com" || r.reply.code == 250;
+		}), "Split:  reply for each recipient");
+	}
+
+	// A message over the server's SIZE limit is rejected without being sent,
+	// so it must not use up the daily budget
+	void CheckRejectedMessageReleased(std::ostream &log)
+	{
+		StubSMTPServer::Options serverOptions;
+		serverOptions.maxSize = 1000;
+		StubSMTPServer server(serverOptions);
+
+		RateLimiter::Limits limits;
+		limits.dailyMessageLimit = 1;
+		limits.dailyRecipientLimit = 2;
+		EmailSender::LoginInfo loginInfo;
+		loginInfo.smtpUrl = server.GetURL();
+		loginInfo.localEmail = "sender@example.com";
+		loginInfo.useSSL = false;
+		loginInfo.rateLimiter = std::make_shared<RateLimiter>(limits);
+
+		SMTPEventEngine::Options options;
+		options.loopCount = 1;
+		options.sessionsPerLoop = 1;
+		options.timeoutSeconds = 10;
+
+		SendResult result;
+		{
+			SMTPEventEngine engine(loginInfo, false, options, log);
+			EmailSender::Message message;
+			message.subject = "Oversized test";
+			message.message = std::string(2000, 'x');
+			message.recipients.push_back({ "r1@example.com", "" });
+			message.recipients.push_back({ "r2@example.com", "" });
+			engine.Add(std::make_unique<EmailSender>(message, loginInfo, false, log),
+				[&result](const SendResult &r, const std::vector<SMTPProtocol::RecipientResult>&)
+			{
+				result = r;
+			});
+			engine.Wait();
+		}
+
+		unsigned int waitMs;
+		Test::Check(!result.success && result.curlCode == CURLE_FILESIZE_EXCEEDED, "Oversized:  message rejected");
+		Test::Check(server.GetMessages().empty(), "Oversized:  nothing received");
+		Test::Check(loginInfo.rateLimiter->TryAcquire(2, waitMs), "Oversized:  daily budget given back");
+	}
+}
+
+int main()
+{
+	std::ostringstream log;
+
+	CheckHeldSessionClosed(log);
+	CheckConcurrentSessions(log);
+	CheckSplitRecipients(log);
+	CheckRejectedMessageReleased(log);
+
+	if (Test::GetFailureCount() > 0)
+		std::cerr << "Log:\n" << log.str() << std::endl;
+
+	return Test::Finish("smtpEventEngineTest");
+}
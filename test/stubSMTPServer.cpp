@@ -0,0 +1,725 @@
+// File:  stubSMTPServer.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Minimal SMTP server for tests, with optional PIPELINING, CHUNKING,
+//        SIZE and STARTTLS.  Records what it receives.
+
+// Local headers
+#include "stubSMTPServer.h"
+
+// OpenSSL headers
+#include <openssl/evp.h>
+#include <openssl/ec.h>
+#include <openssl/x509v3.h>
+#include <openssl/pem.h>
+
+// Standard C++ headers
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
+// Linux headers
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace
+{
+	std::string ToUpper(std::string s)
+	{
+		std::transform(s.begin(), s.end(), s.begin(), [](const unsigned char &c)
+		{
+			return static_cast<char>(toupper(c));
+		});
+		return s;
+	}
+
+	// Text between the first '<' and the following '>'
+	std::string GetAddress(const std::string &line)
+	{
+		const std::string::size_type start(line.find('<'));
+		const std::string::size_type end(line.find('>', start));
+		if (start == std::string::npos || end == std::string::npos)
+			return std::string();
+		return line.substr(start + 1, end - start - 1);
+	}
+}
+
+struct StubSMTPServer::Connection
+{
+	enum class Mode
+	{
+		Command,
+		Data,
+		Chunk
+	};
+
+	Connection(const int &socket, const unsigned int &number) : socket(socket), number(number) {}
+	~Connection()
+	{
+		if (ssl)
+			SSL_free(ssl);
+	}
+
+	const int socket;
+	const unsigned int number;
+	SSL *ssl = nullptr;
+	std::string input;
+	std::string output;
+
+	Mode mode = Mode::Command;
+	size_t chunkRemaining = 0;
+	bool lastChunk = false;
+	bool startTLS = false;// Begin the handshake once the output is written
+	bool closing = false;
+
+	bool inTransaction = false;
+	Message message;
+	unsigned int messageCount = 0;
+
+	bool Read()
+	{
+		char buffer[16384];
+		const int length(ssl ? SSL_read(ssl, buffer, sizeof(buffer)) :
+			static_cast<int>(recv(socket, buffer, sizeof(buffer), 0)));
+		if (length <= 0)
+			return false;
+
+		input.append(buffer, length);
+		return true;
+	}
+
+	bool IsReadable(const int &timeoutMs) const
+	{
+		if (ssl && SSL_pending(ssl) > 0)
+			return true;
+
+		pollfd descriptor{};
+		descriptor.fd = socket;
+		descriptor.events = POLLIN;
+		return poll(&descriptor, 1, timeoutMs) > 0;
+	}
+
+	void Flush()
+	{
+		size_t sent(0);
+		while (sent < output.size())
+		{
+			const int length(ssl ? SSL_write(ssl, output.data() + sent, static_cast<int>(output.size() - sent)) :
+				static_cast<int>(send(socket, output.data() + sent, output.size() - sent, MSG_NOSIGNAL)));
+			if (length <= 0)
+				break;
+			sent += length;
+		}
+		output.clear();
+	}
+};
+
+//==========================================================================
+// Class:			StubSMTPServer
+// Function:		StubSMTPServer
+//
+// Description:		Constructor for StubSMTPServer class.  Starts listening.
+//
+// Input Arguments:
+//		options	= const Options&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+StubSMTPServer::StubSMTPServer(const Options &options) : options(options), connectionCount(0),
+	maxOpenConnections(0), maxPipelinedCommands(0)
+{
+	listener = socket(AF_INET, SOCK_STREAM, 0);
+	if (options.startTLS && !CreateCertificate())
+		return;
+
+	sockaddr_in address{};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t length(sizeof(address));
+	if (bind(listener, reinterpret_cast<sockaddr*>(&address), length) != 0 ||
+		listen(listener, 4) != 0 ||
+		getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+		return;
+
+	port = ntohs(address.sin_port);
+	thread = std::thread(&StubSMTPServer::Run, this);
+}
+
+//==========================================================================
+// Class:			StubSMTPServer
+// Function:		~StubSMTPServer
+//
+// Description:		Destructor for StubSMTPServer class.  Closes the open
+//					connections (if any) and stops listening.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+StubSMTPServer::~StubSMTPServer()
+{
+	shutdown(listener, SHUT_RDWR);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		for (const auto& socket : openConnections)
+			shutdown(socket, SHUT_RDWR);
+	}
+
+	if (thread.joinable())
+		thread.join();
+	close(listener);
+}
+
+//==========================================================================
+// Class:			StubSMTPServer
+// Function:		GetURL
+//
+// Description:		Returns the URL clients should use.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::string
+//
+//==========================================================================
+std::string StubSMTPServer::GetURL() const
+{
+	return "smtp://127.0.0.1:" + std::to_string(port);
+}
+
+//==========================================================================
+// Class:			StubSMTPServer
+// Function:		SaveCertificate
+//
+// Description:		Writes the server's certificate into the specified
+//					directory, named by its subject hash so OpenSSL (and
+//					CURLOPT_CAPATH) can find it.
+//
+// Input Arguments:
+//		directory	= const std::string&, must exist
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool StubSMTPServer::SaveCertificate(const std::string &directory) const
+{
+	if (!certificate)
+		return false;
+
+	char name[16];
+	snprintf(name, sizeof(name), "%08lx.0", X509_subject_name_hash(certificate.get()));
+	BIO *file(BIO_new_file((directory + "/" + name).c_str(), "w"));
+	if (!file)
+		return false;
+
+	const bool success(PEM_write_bio_X509(file, certificate.get()) == 1);
+	BIO_free(file);
+	return success;
+}
+
+//==========================================================================
+// Class:			StubSMTPServer
+// Function:		GetCommands
+//
+// Description:		Returns every command received so far, in order.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::vector<Command>
+//
+//==========================================================================
+std::vector<StubSMTPServer::Command> StubSMTPServer::GetCommands()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return commands;
+}
+
+//==========================================================================
+// Class:			StubSMTPServer
+// Function:		GetMessages
+//
+// Description:		Returns every message accepted so far, in order.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::vector<Message>
+//
+//==========================================================================
+std::vector<StubSMTPServer::Message> StubSMTPServer::GetMessages()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return messages;
+}
+
+//==========================================================================
+// Class:			StubSMTPServer
+// Function:		Run
+//
+// Description:		Accepts connections until the server is destroyed,
+//					starting a thread to serve each one.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void StubSMTPServer::Run()
+{
+	int socket;
+	while ((socket = accept(listener, nullptr, nullptr)) >= 0)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (stopping)
+			shutdown(socket, SHUT_RDWR);
+
+		openConnections.insert(socket);
+		if (openConnections.size() > maxOpenConnections)
+			maxOpenConnections = static_cast<unsigned int>(openConnections.size());
+		connectionThreads.emplace_back(&StubSMTPServer::ServeConnection, this, socket, ++connectionCount);
+	}
+
+	for (auto& t : connectionThreads)
+		t.join();
+}
+
+//==========================================================================
+// Class:			StubSMTPServer
+// Function:		ServeConnection
+//
+// Description:		Serves one connection, then closes it.
+//
+// Input Arguments:
+//		socket	= const int&
+//		number	= const unsigned int&, counting from one
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void StubSMTPServer::ServeConnection(const int &socket, const unsigned int &number)
+{
+	{
+		Connection connection(socket, number);
+		Serve(connection);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		openConnections.erase(socket);
+	}
+	close(socket);
+}
+
+//==========================================================================
+// Class:			StubSMTPServer
+// Function:		Serve
+//
+// Description:		Holds the conversation on one connection.  After each
+//					read, the server waits briefly for more data, so that
+//					pipelined commands are answered together.  If the client
+//					is idle for too long, the server closes the connection
+//					with 421, as a real server would.
+//
+// Input Arguments:
+//		connection	= Connection&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void StubSMTPServer::Serve(Connection &connection)
+{
+	connection.output = "220 stub.example.com ESMTP\r\n";
+	connection.Flush();
+
+	bool open(true);
+	while (open && !connection.closing)
+	{
+		if (options.idleTimeoutMs > 0 && !connection.IsReadable(static_cast<int>(options.idleTimeoutMs)))
+		{
+			connection.output = "421 4.4.2 stub.example.com Idle timeout, closing connection\r\n";
+			connection.Flush();
+			break;
+		}
+		else if (!connection.Read())
+			break;
+
+		while (open && connection.IsReadable(10))
+			open = connection.Read();
+
+		const unsigned int count(Process(connection));
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (count > maxPipelinedCommands)
+				maxPipelinedCommands = count;
+		}
+		connection.Flush();
+
+		if (connection.startTLS)
+		{
+			connection.startTLS = false;
+			connection.input.clear();
+			connection.ssl = SSL_new(tlsContext.get());
+			SSL_set_fd(connection.ssl, connection.socket);
+			if (SSL_accept(connection.ssl) != 1)
+				return;
+		}
+	}
+
+	// Let the client see the end of the stream before closing
+	if (connection.ssl)
+		SSL_shutdown(connection.ssl);
+	shutdown(connection.socket, SHUT_WR);
+	char buffer[4096];
+	while (connection.IsReadable(5000) && recv(connection.socket, buffer, sizeof(buffer), 0) > 0)
+	{
+	}
+}
+
+//==========================================================================
+// Class:			StubSMTPServer
+// Function:		Process
+//
+// Description:		Handles all complete commands (and message data) in the
+//					connection's input.
+//
+// Input Arguments:
+//		connection	= Connection&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		unsigned int, number of commands handled
+//
+//==========================================================================
+unsigned int StubSMTPServer::Process(Connection &connection)
+{
+	unsigned int count(0);
+	while (!connection.closing && !connection.startTLS)
+	{
+		if (connection.mode == Connection::Mode::Chunk)
+		{
+			const size_t length(std::min(connection.chunkRemaining, connection.input.size()));
+			if (length == 0)
+				break;
+
+			connection.message.content.append(connection.input, 0, length);
+			connection.message.wireSize += length;
+			connection.input.erase(0, length);
+			connection.chunkRemaining -= length;
+			if (connection.chunkRemaining == 0)
+				FinishChunk(connection);
+			continue;
+		}
+
+		const std::string::size_type end(connection.input.find("\r\n"));
+		if (end == std::string::npos)
+			break;
+
+		const std::string line(connection.input.substr(0, end));
+		connection.input.erase(0, end + 2);
+
+		if (connection.mode == Connection::Mode::Data)
+		{
+			if (line == ".")
+				FinishMessage(connection);
+			else
+			{
+				connection.message.wireSize += line.size() + 2;
+				connection.message.content.append(line, line.compare(0, 1, ".") == 0 ? 1 : 0, std::string::npos);
+				connection.message.content.append("\r\n");
+			}
+			continue;
+		}
+
+		++count;
+		HandleCommand(connection, line);
+	}
+
+	return count;
+}
+
+//==========================================================================
+// Class:			StubSMTPServer
+// Function:		HandleCommand
+//
+// Description:		Replies to one command.
+//
+// Input Arguments:
+//		connection	= Connection&
+//		line		= const std::string&, without the line terminator
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void StubSMTPServer::HandleCommand(Connection &connection, const std::string &line)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		commands.push_back({ line, connection.ssl != nullptr, connection.number });
+	}
+
+	if (options.dropAfterMessages > 0 && connection.messageCount >= options.dropAfterMessages)
+	{
+		if (options.drop == Drop::Reply421)
+			connection.output.append("421 4.4.2 stub.example.com Idle timeout, closing connection\r\n");
+		connection.closing = true;
+		return;
+	}
+
+	const std::string verb(ToUpper(line.substr(0, line.find(' '))));
+	if (verb == "EHLO")
+	{
+		connection.inTransaction = false;
+		connection.output.append("250-stub.example.com\r\n");
+		if (options.pipelining)
+			connection.output.append("250-PIPELINING\r\n");
+		if (options.chunking)
+			connection.output.append("250-CHUNKING\r\n");
+		if (options.maxSize > 0)
+			connection.output.append("250-SIZE " + std::to_string(options.maxSize) + "\r\n");
+		if (options.startTLS && !connection.ssl)
+			connection.output.append("250-STARTTLS\r\n");
+		connection.output.append("250 AUTH PLAIN\r\n");
+	}
+	else if (verb == "HELO")
+		connection.output.append("250 stub.example.com\r\n");
+	else if (verb == "STARTTLS" && options.startTLS && !connection.ssl)
+	{
+		connection.output.append("220 2.0.0 Ready to start TLS\r\n");
+		connection.startTLS = true;
+	}
+	else if (verb == "AUTH")
+		connection.output.append("235 2.7.0 Authentication successful\r\n");
+	else if (verb == "MAIL")
+	{
+		const std::string::size_type sizeParameter(ToUpper(line).find(" SIZE="));
+		const long declaredSize(sizeParameter == std::string::npos ? -1 : atol(line.c_str() + sizeParameter + 6));
+		if (options.maxSize > 0 && declaredSize > static_cast<long>(options.maxSize))
+			connection.output.append("552 5.3.4 Message size exceeds fixed limit\r\n");
+		else
+		{
+			connection.inTransaction = true;
+			connection.message = Message();
+			connection.message.from = GetAddress(line);
+			connection.message.declaredSize = declaredSize;
+			connection.output.append("250 2.1.0 Ok\r\n");
+		}
+	}
+	else if (verb == "RCPT")
+	{
+		const std::string address(GetAddress(line));
+		if (!connection.inTransaction)
+			connection.output.append("503 5.5.1 Error: need MAIL command\r\n");
+		else if (options.rejectedRecipients.find(address) != options.rejectedRecipients.end())
+			connection.output.append("550 5.1.1 <" + address + ">: Recipient address rejected\r\n");
+		else
+		{
+			connection.message.recipients.push_back(address);
+			connection.output.append("250 2.1.5 Ok\r\n");
+		}
+	}
+	else if (verb == "DATA")
+	{
+		if (!connection.inTransaction || connection.message.recipients.empty())
+			connection.output.append("554 5.5.1 Error: no valid recipients\r\n");
+		else
+		{
+			connection.mode = Connection::Mode::Data;
+			connection.output.append("354 End data with <CR><LF>.<CR><LF>\r\n");
+		}
+	}
+	else if (verb == "BDAT")
+	{
+		connection.mode = Connection::Mode::Chunk;
+		connection.chunkRemaining = static_cast<size_t>(atol(line.c_str() + 5));
+		connection.lastChunk = ToUpper(line).find(" LAST") != std::string::npos;
+		connection.message.chunked = true;
+		if (connection.chunkRemaining == 0)
+			FinishChunk(connection);
+	}
+	else if (verb == "RSET")
+	{
+		connection.inTransaction = false;
+		connection.output.append("250 2.0.0 Ok\r\n");
+	}
+	else if (verb == "NOOP")
+		connection.output.append("250 2.0.0 Ok\r\n");
+	else if (verb == "QUIT")
+	{
+		connection.output.append("221 2.0.0 Bye\r\n");
+		connection.closing = true;
+	}
+	else
+		connection.output.append("502 5.5.2 Error: command not recognized\r\n");
+}
+
+//==========================================================================
+// Class:			StubSMTPServer
+// Function:		FinishChunk
+//
+// Description:		Replies to a BDAT chunk once all of its data has been
+//					received.
+//
+// Input Arguments:
+//		connection	= Connection&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void StubSMTPServer::FinishChunk(Connection &connection)
+{
+	connection.mode = Connection::Mode::Command;
+	if (connection.lastChunk)
+		FinishMessage(connection);
+	else if (!connection.inTransaction || connection.message.recipients.empty())
+		connection.output.append("554 5.5.1 Error: no valid recipients\r\n");
+	else
+		connection.output.append("250 2.0.0 " + std::to_string(connection.message.wireSize) + " octets received\r\n");
+}
+
+//==========================================================================
+// Class:			StubSMTPServer
+// Function:		FinishMessage
+//
+// Description:		Accepts the current message (if it has any recipients)
+//					and ends the transaction.
+//
+// Input Arguments:
+//		connection	= Connection&
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+void StubSMTPServer::FinishMessage(Connection &connection)
+{
+	connection.mode = Connection::Mode::Command;
+	if (!connection.inTransaction || connection.message.recipients.empty())
+		connection.output.append("554 5.5.1 Error: no valid recipients\r\n");
+	else
+	{
+		connection.message.tls = connection.ssl != nullptr;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			messages.push_back(connection.message);
+		}
+
+		++connection.messageCount;
+		connection.output.append("250 2.0.0 Ok: queued\r\n");
+	}
+
+	connection.inTransaction = false;
+	connection.message = Message();
+}
+
+//==========================================================================
+// Class:			StubSMTPServer
+// Function:		CreateCertificate
+//
+// Description:		Creates a key and a self-signed certificate for
+//					127.0.0.1, and the TLS context which uses them.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		bool, true for success, false otherwise
+//
+//==========================================================================
+bool StubSMTPServer::CreateCertificate()
+{
+	std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> keyContext(
+		EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr), EVP_PKEY_CTX_free);
+	EVP_PKEY *rawKey(nullptr);
+	if (!keyContext || EVP_PKEY_keygen_init(keyContext.get()) != 1 ||
+		EVP_PKEY_CTX_set_ec_paramgen_curve_nid(keyContext.get(), NID_X9_62_prime256v1) != 1 ||
+		EVP_PKEY_keygen(keyContext.get(), &rawKey) != 1)
+		return false;
+	std::shared_ptr<EVP_PKEY> key(rawKey, EVP_PKEY_free);
+
+	certificate.reset(X509_new(), X509_free);
+	X509_set_version(certificate.get(), 2);
+	ASN1_INTEGER_set(X509_get_serialNumber(certificate.get()), 1);
+	X509_gmtime_adj(X509_getm_notBefore(certificate.get()), -3600);
+	X509_gmtime_adj(X509_getm_notAfter(certificate.get()), 24 * 3600);
+	X509_NAME *name(X509_get_subject_name(certificate.get()));
+	X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("127.0.0.1"), -1, -1, 0);
+	X509_set_issuer_name(certificate.get(), name);
+	X509_set_pubkey(certificate.get(), key.get());
+
+	X509V3_CTX extensionContext;
+	X509V3_set_ctx(&extensionContext, certificate.get(), certificate.get(), nullptr, nullptr, 0);
+	X509_EXTENSION *extension(X509V3_EXT_nconf_nid(nullptr, &extensionContext, NID_subject_alt_name, "IP:127.0.0.1"));
+	if (!extension)
+		return false;
+	X509_add_ext(certificate.get(), extension, -1);
+	X509_EXTENSION_free(extension);
+
+	if (X509_sign(certificate.get(), key.get(), EVP_sha256()) == 0)
+		return false;
+
+	tlsContext.reset(SSL_CTX_new(TLS_server_method()), SSL_CTX_free);
+	return tlsContext && SSL_CTX_use_certificate(tlsContext.get(), certificate.get()) == 1 &&
+		SSL_CTX_use_PrivateKey(tlsContext.get(), key.get()) == 1;
+}
@@ -0,0 +1,119 @@
+// File:  stubSMTPServer.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Minimal SMTP server for tests, with optional PIPELINING, CHUNKING,
+//        SIZE and STARTTLS.  Records what it receives.
+
+#ifndef STUB_SMTP_SERVER_H_
+#define STUB_SMTP_SERVER_H_
+
+// OpenSSL headers
+#include <openssl/ssl.h>
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+// Listens on 127.0.0.1 (on a port chosen by the system) and serves each
+// connection on its own thread.  Any AUTH PLAIN is accepted.  Replies are held for
+// a moment after each read, so commands which the client pipelines are
+// handled (and counted) together.
+class StubSMTPServer
+{
+public:
+	enum class Drop
+	{
+		None,
+		Close,// Close the connection without a word
+		Reply421// Send 421 and close the connection
+	};
+
+	struct Options
+	{
+		bool pipelining = true;
+		bool chunking = true;
+		bool startTLS = false;// Offer STARTTLS (with a self-signed certificate for 127.0.0.1)
+		size_t maxSize = 0;// Zero to leave out SIZE
+		std::set<std::string> rejectedRecipients;// Refused with 550
+		unsigned int dropAfterMessages = 0;// Drop each connection after this many messages (zero for never)
+		Drop drop = Drop::Close;
+		unsigned int idleTimeoutMs = 0;// Send 421 and close after this long without a command (zero for never)
+	};
+
+	struct Command
+	{
+		std::string line;// Without the line terminator
+		bool tls;
+		unsigned int connection;// Counting from one, in the order accepted
+	};
+
+	struct Message
+	{
+		std::string from;
+		std::vector<std::string> recipients;// Accepted recipients
+		long declaredSize = -1;// From MAIL FROM's SIZE parameter; -1 if not declared
+		size_t wireSize = 0;// Bytes of message data as sent (with stuffed dots, without the terminating ".")
+		std::string content;// Message data after removing stuffed dots
+		bool chunked = false;
+		bool tls = false;
+	};
+
+	explicit StubSMTPServer(const Options &options);
+	~StubSMTPServer();
+
+	StubSMTPServer(const StubSMTPServer&) = delete;
+	StubSMTPServer& operator=(const StubSMTPServer&) = delete;
+
+	unsigned short GetPort() const { return port; }
+	std::string GetURL() const;
+
+	// Saves the server's certificate as a CURLOPT_CAPATH style directory
+	bool SaveCertificate(const std::string &directory) const;
+
+	std::vector<Command> GetCommands();
+	std::vector<Message> GetMessages();
+	unsigned int GetConnectionCount() const { return connectionCount; }
+	unsigned int GetMaxOpenConnections() const { return maxOpenConnections; }
+
+	// Largest number of commands received before the server replied (one
+	// if the client never pipelined)
+	unsigned int GetMaxPipelinedCommands() const { return maxPipelinedCommands; }
+
+private:
+	struct Connection;
+
+	const Options options;
+	std::shared_ptr<SSL_CTX> tlsContext;
+	std::shared_ptr<X509> certificate;
+
+	int listener;
+	unsigned short port = 0;
+	std::thread thread;
+	std::vector<std::thread> connectionThreads;
+
+	std::mutex mutex;
+	bool stopping = false;
+	std::set<int> openConnections;
+	std::vector<Command> commands;
+	std::vector<Message> messages;
+	std::atomic<unsigned int> connectionCount;
+	std::atomic<unsigned int> maxOpenConnections;
+	std::atomic<unsigned int> maxPipelinedCommands;
+
+	void Run();
+	void ServeConnection(const int &socket, const unsigned int &number);
+	void Serve(Connection &connection);
+	unsigned int Process(Connection &connection);
+	void HandleCommand(Connection &connection, const std::string &line);
+	void FinishChunk(Connection &connection);
+	void FinishMessage(Connection &connection);
+
+	bool CreateCertificate();
+};
+
+#endif// STUB_SMTP_SERVER_H_
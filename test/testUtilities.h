@@ -0,0 +1,46 @@
+// File:  testUtilities.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Failure counting shared by the test programs.
+
+#ifndef TEST_UTILITIES_H_
+#define TEST_UTILITIES_H_
+
+// Standard C++ headers
+#include <iostream>
+#include <string>
+
+namespace Test
+{
+	inline unsigned int& GetFailureCount()
+	{
+		static unsigned int failureCount(0);
+		return failureCount;
+	}
+
+	inline bool Check(const bool &condition, const std::string &description)
+	{
+		if (!condition)
+		{
+			++GetFailureCount();
+			std::cerr << "FAILED:  " << description << std::endl;
+		}
+
+		return condition;
+	}
+
+	// Returns the program's exit code
+	inline int Finish(const std::string &name)
+	{
+		if (GetFailureCount() == 0)
+		{
+			std::cout << name << ":  all checks passed" << std::endl;
+			return 0;
+		}
+
+		std::cout << name << ":  " << GetFailureCount() << " check(s) failed" << std::endl;
+		return 1;
+	}
+}
+
+#endif// TEST_UTILITIES_H_
@@ -0,0 +1,397 @@
+// File:  tlsConnection.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Client-side TLS over a connection opened by libcurl, for upgrading
+//        plain connections with STARTTLS.
+
+// Local headers
+#include "tlsConnection.h"
+
+// OpenSSL headers
+#include <openssl/err.h>
+#include <openssl/x509v3.h>
+
+// Standard C++ headers
+#include <algorithm>
+#include <climits>
+
+//==========================================================================
+// Class:			TLSConnection
+// Function:		CreateContext (static)
+//
+// Description:		Creates the settings shared by connections to a server.
+//
+// Input Arguments:
+//		caCertificatePath	= const std::string&, directory of additional
+//							  trusted certificates (may be empty)
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		std::shared_ptr<SSL_CTX>, empty on failure
+//
+//==========================================================================
+std::shared_ptr<SSL_CTX> TLSConnection::CreateContext(const std::string &caCertificatePath)
+{
+	std::shared_ptr<SSL_CTX> context(SSL_CTX_new(TLS_client_method()), SSL_CTX_free);
+	if (!context)
+		return context;
+
+	SSL_CTX_set_min_proto_version(context.get(), TLS1_2_VERSION);
+	SSL_CTX_set_verify(context.get(), SSL_VERIFY_PEER, nullptr);
+	SSL_CTX_set_default_verify_paths(context.get());
+	if (!caCertificatePath.empty())
+		SSL_CTX_load_verify_locations(context.get(), nullptr, caCertificatePath.c_str());
+
+	// Output stays in the caller's buffer (which may move or grow) until it
+	// has been written
+	SSL_CTX_set_mode(context.get(), SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+#ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+	// Many servers close the connection after QUIT without a close_notify
+	SSL_CTX_set_options(context.get(), SSL_OP_IGNORE_UNEXPECTED_EOF);
+#endif
+
+	return context;
+}
+
+//==========================================================================
+// Class:			TLSConnection
+// Function:		TLSConnection
+//
+// Description:		Constructor for TLSConnection class.  The handshake
+//					starts with the first call to Handshake().
+//
+// Input Arguments:
+//		context		= const std::shared_ptr<SSL_CTX>&
+//		curl		= CURL*, connected CONNECT_ONLY handle
+//		hostName	= const std::string&, name (or address) expected in the
+//					  server's certificate
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+TLSConnection::TLSConnection(const std::shared_ptr<SSL_CTX> &context, CURL *curl,
+	const std::string &hostName) : context(context)
+{
+	if (!context)
+		return;
+
+	BIO *bio(BIO_new(GetBIOMethod()));
+	ssl = SSL_new(context.get());
+	if (!bio || !ssl)
+	{
+		BIO_free(bio);
+		SSL_free(ssl);
+		ssl = nullptr;
+		return;
+	}
+
+	BIO_set_data(bio, curl);
+	BIO_set_init(bio, 1);
+	SSL_set_bio(ssl, bio, bio);
+
+	// Server Name Indication is only sent for names, not addresses
+	if (!X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(ssl), hostName.c_str()))
+	{
+		SSL_set_tlsext_host_name(ssl, hostName.c_str());
+		SSL_set1_host(ssl, hostName.c_str());
+	}
+
+	SSL_set_connect_state(ssl);
+}
+
+//==========================================================================
+// Class:			TLSConnection
+// Function:		~TLSConnection
+//
+// Description:		Destructor for TLSConnection class.  Tells the server the
+//					session is ending (without waiting for its reply).  The
+//					connection itself belongs to the CURL handle.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		None
+//
+//==========================================================================
+TLSConnection::~TLSConnection()
+{
+	if (!ssl)
+		return;
+
+	if (!failed && SSL_is_init_finished(ssl))
+	{
+		SSL_shutdown(ssl);
+		ERR_clear_error();
+	}
+
+	SSL_free(ssl);
+}
+
+//==========================================================================
+// Class:			TLSConnection
+// Function:		Handshake
+//
+// Description:		Continues the TLS handshake.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		CURLcode, CURLE_OK once the connection is established
+//
+//==========================================================================
+CURLcode TLSConnection::Handshake()
+{
+	if (!ssl)
+		return CURLE_SSL_CONNECT_ERROR;
+
+	ERR_clear_error();
+	const int result(SSL_connect(ssl));
+	if (result == 1)
+		return CURLE_OK;
+
+	const CURLcode error(CheckError(result, CURLE_SSL_CONNECT_ERROR));
+	if (error == CURLE_SSL_CONNECT_ERROR && SSL_get_verify_result(ssl) != X509_V_OK)
+		return CURLE_PEER_FAILED_VERIFICATION;
+	return error;
+}
+
+//==========================================================================
+// Class:			TLSConnection
+// Function:		Send
+//
+// Description:		Writes as much of the data as the connection will accept.
+//
+// Input Arguments:
+//		data	= const char*
+//		size	= const size_t&
+//
+// Output Arguments:
+//		sent	= size_t&
+//
+// Return Value:
+//		CURLcode
+//
+//==========================================================================
+CURLcode TLSConnection::Send(const char *data, const size_t &size, size_t &sent)
+{
+	sent = 0;
+	ERR_clear_error();
+	const int result(SSL_write(ssl, data, static_cast<int>(std::min<size_t>(size, INT_MAX))));
+	if (result > 0)
+	{
+		sent = static_cast<size_t>(result);
+		return CURLE_OK;
+	}
+
+	return CheckError(result, CURLE_SEND_ERROR);
+}
+
+//==========================================================================
+// Class:			TLSConnection
+// Function:		Receive
+//
+// Description:		Reads whatever data is available.
+//
+// Input Arguments:
+//		size		= const size_t&, size of the buffer
+//
+// Output Arguments:
+//		buffer		= char*
+//		received	= size_t&, zero if the server closed the connection
+//
+// Return Value:
+//		CURLcode
+//
+//==========================================================================
+CURLcode TLSConnection::Receive(char *buffer, const size_t &size, size_t &received)
+{
+	received = 0;
+	ERR_clear_error();
+	const int result(SSL_read(ssl, buffer, static_cast<int>(std::min<size_t>(size, INT_MAX))));
+	if (result > 0)
+	{
+		received = static_cast<size_t>(result);
+		return CURLE_OK;
+	}
+
+	// Closed by the server, with or without a close_notify
+	const int error(SSL_get_error(ssl, result));
+	if (error == SSL_ERROR_ZERO_RETURN || (error == SSL_ERROR_SYSCALL && ERR_peek_error() == 0))
+	{
+		wantWrite = false;
+		return CURLE_OK;
+	}
+
+	return CheckError(result, CURLE_RECV_ERROR);
+}
+
+//==========================================================================
+// Class:			TLSConnection
+// Function:		CheckError
+//
+// Description:		Interprets the result of an unsuccessful OpenSSL call.
+//
+// Input Arguments:
+//		result	= const int&, value returned by OpenSSL
+//		failure	= const CURLcode&, error to report if the operation can not
+//				  be retried
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		CURLcode, CURLE_AGAIN if the operation should be retried
+//
+//==========================================================================
+CURLcode TLSConnection::CheckError(const int &result, const CURLcode &failure)
+{
+	wantWrite = false;
+	switch (SSL_get_error(ssl, result))
+	{
+	case SSL_ERROR_WANT_WRITE:
+		wantWrite = true;
+		return CURLE_AGAIN;
+
+	case SSL_ERROR_WANT_READ:
+		return CURLE_AGAIN;
+
+	default:
+		failed = true;
+		ERR_clear_error();
+		return failure;
+	}
+}
+
+//==========================================================================
+// Class:			TLSConnection
+// Function:		GetBIOMethod (static)
+//
+// Description:		Returns the BIO type which moves OpenSSL's data through
+//					libcurl.
+//
+// Input Arguments:
+//		None
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		BIO_METHOD*
+//
+//==========================================================================
+BIO_METHOD* TLSConnection::GetBIOMethod()
+{
+	static BIO_METHOD *method([]()
+	{
+		BIO_METHOD *m(BIO_meth_new(BIO_get_new_index() | BIO_TYPE_SOURCE_SINK, "curl connection"));
+		if (m)
+		{
+			BIO_meth_set_write(m, WriteCallback);
+			BIO_meth_set_read(m, ReadCallback);
+			BIO_meth_set_ctrl(m, ControlCallback);
+		}
+		return m;
+	}());
+
+	return method;
+}
+
+//==========================================================================
+// Class:			TLSConnection
+// Function:		WriteCallback (static)
+//
+// Description:		Writes encrypted data to the connection.
+//
+// Input Arguments:
+//		bio		= BIO*
+//		data	= const char*
+//		size	= int
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		int, number of bytes written, or -1 on failure
+//
+//==========================================================================
+int TLSConnection::WriteCallback(BIO *bio, const char *data, int size)
+{
+	BIO_clear_retry_flags(bio);
+	size_t sent(0);
+	const CURLcode result(curl_easy_send(static_cast<CURL*>(BIO_get_data(bio)), data, static_cast<size_t>(size), &sent));
+	if (result == CURLE_OK)
+		return static_cast<int>(sent);
+	else if (result == CURLE_AGAIN)
+		BIO_set_retry_write(bio);
+	return -1;
+}
+
+//==========================================================================
+// Class:			TLSConnection
+// Function:		ReadCallback (static)
+//
+// Description:		Reads encrypted data from the connection.
+//
+// Input Arguments:
+//		bio		= BIO*
+//		size	= int
+//
+// Output Arguments:
+//		data	= char*
+//
+// Return Value:
+//		int, number of bytes read, zero at the end of the stream, or -1 on
+//		failure
+//
+//==========================================================================
+int TLSConnection::ReadCallback(BIO *bio, char *data, int size)
+{
+	BIO_clear_retry_flags(bio);
+	size_t received(0);
+	const CURLcode result(curl_easy_recv(static_cast<CURL*>(BIO_get_data(bio)), data, static_cast<size_t>(size), &received));
+	if (result == CURLE_OK)
+		return static_cast<int>(received);
+	else if (result == CURLE_AGAIN)
+		BIO_set_retry_read(bio);
+	return -1;
+}
+
+//==========================================================================
+// Class:			TLSConnection
+// Function:		ControlCallback (static)
+//
+// Description:		Handles OpenSSL's requests to the BIO.  Only flushing is
+//					supported (and there is nothing to flush).
+//
+// Input Arguments:
+//		bio		= BIO* (unused)
+//		command	= int
+//		number	= long (unused)
+//		pointer	= void* (unused)
+//
+// Output Arguments:
+//		None
+//
+// Return Value:
+//		long
+//
+//==========================================================================
+long TLSConnection::ControlCallback(BIO* /*bio*/, int command, long /*number*/, void* /*pointer*/)
+{
+	return command == BIO_CTRL_FLUSH ? 1 : 0;
+}
@@ -0,0 +1,64 @@
+// File:  tlsConnection.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Client-side TLS over a connection opened by libcurl, for upgrading
+//        plain connections with STARTTLS.
+
+#ifndef TLS_CONNECTION_H_
+#define TLS_CONNECTION_H_
+
+// cURL headers
+#include <curl/curl.h>
+
+// OpenSSL headers
+#include <openssl/ssl.h>
+
+// Standard C++ headers
+#include <string>
+#include <memory>
+
+// libcurl only performs the TLS handshake when a connection is opened, so
+// once the server has agreed to STARTTLS this class takes over:  OpenSSL
+// reads and writes the encrypted data through curl_easy_recv() and
+// curl_easy_send() on the (non-blocking) CONNECT_ONLY handle.  The server's
+// certificate is verified against the system's trusted certificates (plus
+// those in caCertificatePath, as with CURLOPT_CAPATH) and its name is
+// checked against the host name.
+//
+// Every operation returns immediately.  CURLE_AGAIN means the operation
+// must be repeated once the socket is readable (or writable, if
+// WantsWrite() returns true).  Receive() succeeds with nothing received
+// once the server has closed the connection, like curl_easy_recv().
+class TLSConnection
+{
+public:
+	// One context may be shared by any number of connections (and threads)
+	static std::shared_ptr<SSL_CTX> CreateContext(const std::string &caCertificatePath);
+
+	TLSConnection(const std::shared_ptr<SSL_CTX> &context, CURL *curl, const std::string &hostName);
+	~TLSConnection();
+
+	TLSConnection(const TLSConnection&) = delete;
+	TLSConnection& operator=(const TLSConnection&) = delete;
+
+	CURLcode Handshake();
+	CURLcode Send(const char *data, const size_t &size, size_t &sent);
+	CURLcode Receive(char *buffer, const size_t &size, size_t &received);
+
+	bool WantsWrite() const { return wantWrite; }
+
+private:
+	const std::shared_ptr<SSL_CTX> context;
+	SSL *ssl = nullptr;
+	bool wantWrite = false;
+	bool failed = false;
+
+	CURLcode CheckError(const int &result, const CURLcode &failure);
+
+	static BIO_METHOD* GetBIOMethod();
+	static int WriteCallback(BIO *bio, const char *data, int size);
+	static int ReadCallback(BIO *bio, char *data, int size);
+	static long ControlCallback(BIO *bio, int command, long number, void *pointer);
+};
+
+#endif// TLS_CONNECTION_H_